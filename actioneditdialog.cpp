@@ -1,11 +1,28 @@
 #include "actioneditdialog.h"
+#include "keysimulator.h"
 #include <QMessageBox>
+#include <QHeaderView>
 #include <QKeyEvent>
 #include <QApplication>
 #include <QFormLayout>
 
 ActionEditDialog::ActionEditDialog(const KeyAction &action, QWidget *parent)
-    : QDialog(parent), m_action(action), m_capturingKey(false) {
+    : ActionEditDialog(action, ActionList(), -1, parent) {
+}
+
+ActionEditDialog::ActionEditDialog(const KeyAction &action, const ActionList &siblings, int index,
+                                   QWidget *parent)
+    : QDialog(parent), m_action(action), m_capturingKey(false),
+      m_rateEstimator(KeySimulator::TickInterval), m_actionIndex(index),
+      m_rateLabel(nullptr), m_siblingRatesTable(nullptr) {
+    // A new action is estimated as if it were appended to the profile
+    ActionList actions = siblings;
+    if (m_actionIndex < 0 || m_actionIndex >= actions.size()) {
+        m_actionIndex = actions.size();
+        actions.append(action);
+    }
+    m_rateEstimator.setActions(actions);
+
     setupUI();
     
     // Set current values
@@ -17,6 +34,7 @@ ActionEditDialog::ActionEditDialog(const KeyAction &action, QWidget *parent)
     m_minIntervalSpinBox->setValue(m_action.minInterval);
     m_maxIntervalSpinBox->setValue(m_action.maxInterval);
     updateKeyDisplay();
+    updateRateEstimate();
     
     setWindowTitle("Edit Action");
     setModal(true);
@@ -96,6 +114,8 @@ void ActionEditDialog::setupUI() {
 
     mainLayout->addWidget(smartGroup);
     
+    setupRateGroup(mainLayout);
+    
     // Buttons
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     m_okButton = new QPushButton("OK");
@@ -112,10 +132,80 @@ void ActionEditDialog::setupUI() {
             this, &ActionEditDialog::onTypeChanged);
     connect(m_keyButton, &QPushButton::clicked, this, &ActionEditDialog::onKeyButtonClicked);
     connect(m_weightSlider, &QSlider::valueChanged, this, &ActionEditDialog::onWeightChanged);
+    connect(m_minIntervalSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ActionEditDialog::updateRateEstimate);
+    connect(m_enabledCheckBox, &QCheckBox::toggled, this, &ActionEditDialog::updateRateEstimate);
     connect(m_okButton, &QPushButton::clicked, this, &ActionEditDialog::accept);
     connect(m_cancelButton, &QPushButton::clicked, this, &ActionEditDialog::reject);
 }
 
+void ActionEditDialog::setupRateGroup(QVBoxLayout *mainLayout) {
+    QGroupBox *rateGroup = new QGroupBox("Estimated Rate");
+    QVBoxLayout *rateLayout = new QVBoxLayout(rateGroup);
+
+    m_rateLabel = new QLabel();
+    rateLayout->addWidget(m_rateLabel);
+
+    // One row per action of the profile, this action in bold
+    const ActionList &actions = m_rateEstimator.actions();
+    m_siblingRatesTable = new QTableWidget(actions.size(), 3);
+    m_siblingRatesTable->setHorizontalHeaderLabels({"Key", "Weight", "Presses/min"});
+    m_siblingRatesTable->horizontalHeader()->setStretchLastSection(true);
+    m_siblingRatesTable->verticalHeader()->setVisible(false);
+    m_siblingRatesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_siblingRatesTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_siblingRatesTable->setMaximumHeight(160);
+    for (int row = 0; row < actions.size(); ++row) {
+        for (int column = 0; column < 3; ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            if (row == m_actionIndex) {
+                QFont font = item->font();
+                font.setBold(true);
+                item->setFont(font);
+            }
+            m_siblingRatesTable->setItem(row, column, item);
+        }
+    }
+    rateLayout->addWidget(m_siblingRatesTable);
+
+    mainLayout->addWidget(rateGroup);
+}
+
+KeyAction ActionEditDialog::editedAction() const {
+    KeyAction action = m_action;
+    action.type = static_cast<InputType>(m_typeComboBox->itemData(m_typeComboBox->currentIndex()).toInt());
+    action.enabled = m_enabledCheckBox->isChecked();
+    action.weight = m_weightSlider->value();
+    action.minInterval = m_minIntervalSpinBox->value();
+    action.maxInterval = m_maxIntervalSpinBox->value();
+    return action;
+}
+
+void ActionEditDialog::updateRateEstimate() {
+    if (!m_siblingRatesTable) {
+        return;
+    }
+
+    m_rateEstimator.updateAction(m_actionIndex, editedAction());
+
+    const ActionList &actions = m_rateEstimator.actions();
+    for (int row = 0; row < actions.size(); ++row) {
+        const KeyAction &action = actions[row];
+        const bool pressed = action.enabled && action.type == InputType::Keyboard && action.key > 0;
+        m_siblingRatesTable->item(row, 0)->setText(action.type == InputType::Keyboard
+            ? keyDisplayName(action.key) : QString("Mouse"));
+        m_siblingRatesTable->item(row, 1)->setText(QString::number(action.weight));
+        m_siblingRatesTable->item(row, 2)->setText(pressed
+            ? QString::number(m_rateEstimator.ratePerMinute(row), 'f', 1) : QString("-"));
+    }
+
+    m_rateLabel->setText(QString("This action: about %1 presses per minute")
+        .arg(m_rateEstimator.ratePerMinute(m_actionIndex), 0, 'f', 1));
+    m_rateLabel->setToolTip(QString("Estimated analytically in %1 iterations (%2 us)")
+        .arg(m_rateEstimator.iterations())
+        .arg(m_rateEstimator.solveTimeNs() / 1000));
+}
+
 void ActionEditDialog::onTypeChanged(int index) {
     InputType type = static_cast<InputType>(m_typeComboBox->itemData(index).toInt());
     m_action.type = type;
@@ -133,6 +223,7 @@ void ActionEditDialog::onTypeChanged(int index) {
             m_keyDisplay->setText("Right Mouse Button");
         }
     }
+    updateRateEstimate();
 }
 
 void ActionEditDialog::onKeyButtonClicked() {
@@ -149,40 +240,43 @@ void ActionEditDialog::onKeyButtonClicked() {
     setFocus();
 }
 
+QString ActionEditDialog::keyDisplayName(int virtualKey) {
+    // Convert Windows virtual key code to string representation
+    if (virtualKey >= 0x30 && virtualKey <= 0x39) { // VK_0 to VK_9
+        return QString::number(virtualKey - 0x30);
+    }
+    if (virtualKey >= 0x41 && virtualKey <= 0x5A) { // VK_A to VK_Z
+        return QChar('A' + (virtualKey - 0x41));
+    }
+
+    // Handle special keys
+    switch (virtualKey) {
+    case 0x20: return "Space";
+    case 0x0D: return "Enter";
+    case 0x09: return "Tab";
+    case 0x10: return "Shift";
+    case 0x11: return "Ctrl";
+    case 0x12: return "Alt";
+    case 0x70: return "F1";
+    case 0x71: return "F2";
+    case 0x72: return "F3";
+    case 0x73: return "F4";
+    case 0x74: return "F5";
+    case 0x75: return "F6";
+    case 0x76: return "F7";
+    case 0x77: return "F8";
+    case 0x78: return "F9";
+    case 0x79: return "F10";
+    case 0x7A: return "F11";
+    case 0x7B: return "F12";
+    default: return QString("VK_%1").arg(virtualKey, 2, 16, QChar('0')).toUpper();
+    }
+}
+
 void ActionEditDialog::updateKeyDisplay() {
     if (m_action.type == InputType::Keyboard) {
         if (m_action.key != 0) {
-            // Convert Windows virtual key code to string representation
-            QString keyStr;
-            if (m_action.key >= 0x30 && m_action.key <= 0x39) { // VK_0 to VK_9
-                keyStr = QString::number(m_action.key - 0x30);
-            } else if (m_action.key >= 0x41 && m_action.key <= 0x5A) { // VK_A to VK_Z
-                keyStr = QChar('A' + (m_action.key - 0x41));
-            } else {
-                // Handle special keys
-                switch (m_action.key) {
-                case 0x20: keyStr = "Space"; break;
-                case 0x0D: keyStr = "Enter"; break;
-                case 0x09: keyStr = "Tab"; break;
-                case 0x10: keyStr = "Shift"; break;
-                case 0x11: keyStr = "Ctrl"; break;
-                case 0x12: keyStr = "Alt"; break;
-                case 0x70: keyStr = "F1"; break;
-                case 0x71: keyStr = "F2"; break;
-                case 0x72: keyStr = "F3"; break;
-                case 0x73: keyStr = "F4"; break;
-                case 0x74: keyStr = "F5"; break;
-                case 0x75: keyStr = "F6"; break;
-                case 0x76: keyStr = "F7"; break;
-                case 0x77: keyStr = "F8"; break;
-                case 0x78: keyStr = "F9"; break;
-                case 0x79: keyStr = "F10"; break;
-                case 0x7A: keyStr = "F11"; break;
-                case 0x7B: keyStr = "F12"; break;
-                default: keyStr = QString("VK_%1").arg(m_action.key, 2, 16, QChar('0')).toUpper();
-                }
-            }
-            m_keyDisplay->setText(keyStr);
+            m_keyDisplay->setText(keyDisplayName(m_action.key));
         } else {
             m_keyDisplay->setText("");
         }
@@ -214,6 +308,7 @@ void ActionEditDialog::keyPressEvent(QKeyEvent *event) {
             m_keyButton->setText("Set Key");
             m_keyButton->setEnabled(true);
             updateKeyDisplay();
+            updateRateEstimate();
         }
 
         event->accept();
@@ -260,6 +355,7 @@ int ActionEditDialog::qtKeyToVirtualKey(int qtKey) {
 void ActionEditDialog::onWeightChanged(int value) {
     m_weightLabel->setText(QString::number(value));
     m_action.weight = value;
+    updateRateEstimate();
 }
 
 void ActionEditDialog::accept() {
@@ -13,15 +13,23 @@
 #include <QGroupBox>
 #include <QLabel>
 #include <QSlider>
+#include <QTableWidget>
 #include "classprofile.h"
+#include "rateestimator.h"
 
 class ActionEditDialog : public QDialog {
     Q_OBJECT
 
 public:
     explicit ActionEditDialog(const KeyAction &action, QWidget *parent = nullptr);
+    // Also shows the estimated press rates of the action and its siblings
+    // while it is edited; index is the action's position in siblings
+    ActionEditDialog(const KeyAction &action, const ActionList &siblings, int index,
+                     QWidget *parent = nullptr);
     
     KeyAction getAction() const;
+    
+    static QString keyDisplayName(int virtualKey);
 
 public slots:
     void accept() override;
@@ -33,10 +41,13 @@ private slots:
     void onTypeChanged(int index);
     void onKeyButtonClicked();
     void onWeightChanged(int value);
+    void updateRateEstimate();
 
 private:
     void setupUI();
     void updateKeyDisplay();
+    void setupRateGroup(QVBoxLayout *mainLayout);
+    KeyAction editedAction() const;
     int qtKeyToVirtualKey(int qtKey);
 
     KeyAction m_action;
@@ -54,6 +65,12 @@ private:
     QSpinBox *m_minIntervalSpinBox;
     QSpinBox *m_maxIntervalSpinBox;
 
+    // What-if rate estimate
+    RateEstimator m_rateEstimator;
+    int m_actionIndex;
+    QLabel *m_rateLabel;
+    QTableWidget *m_siblingRatesTable;
+
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
 };
@@ -0,0 +1,85 @@
+#include "actionlistpool.h"
+#include "classprofile.h"
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QMutexLocker>
+
+ActionListPool::ActionListPool()
+    : m_empty(new ActionList())
+    , m_internsSincePurge(0) {
+}
+
+ActionListPool &ActionListPool::instance() {
+    static ActionListPool pool;
+    return pool;
+}
+
+SharedActionList ActionListPool::empty() {
+    return m_empty;
+}
+
+QByteArray ActionListPool::contentHash(const ActionList &actions) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto &action : actions) {
+        const qint32 fields[] = {
+            static_cast<qint32>(action.type), action.key, action.interval,
+            action.enabled ? 1 : 0, action.weight, action.minInterval, action.maxInterval
+        };
+        hash.addData(reinterpret_cast<const char *>(fields), sizeof(fields));
+    }
+    return hash.result();
+}
+
+SharedActionList ActionListPool::intern(const ActionList &actions) {
+    if (actions.isEmpty()) {
+        return m_empty;
+    }
+
+    const QByteArray key = contentHash(actions);
+
+    QMutexLocker locker(&m_mutex);
+    SharedActionList existing = m_lists.value(key).toStrongRef();
+    if (existing && *existing == actions) {
+        return existing;
+    }
+
+    SharedActionList list(new ActionList(actions));
+    m_lists.insert(key, list.toWeakRef());
+
+    // Drop entries of lists that are no longer used by any profile
+    if (++m_internsSincePurge > m_lists.size()) {
+        purgeExpired();
+    }
+    return list;
+}
+
+QHash<QString, SharedActionList> ActionListPool::decodeTable(const QJsonObject &table) {
+    QHash<QString, SharedActionList> lists;
+    lists.reserve(table.size());
+    for (auto it = table.begin(); it != table.end(); ++it) {
+        lists.insert(it.key(), intern(ClassProfile::actionsFromJson(it.value().toArray())));
+    }
+    return lists;
+}
+
+int ActionListPool::uniqueCount() const {
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (const auto &list : m_lists) {
+        if (!list.isNull()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void ActionListPool::purgeExpired() {
+    for (auto it = m_lists.begin(); it != m_lists.end();) {
+        if (it.value().isNull()) {
+            it = m_lists.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_internsSincePurge = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef ACTIONLISTPOOL_H
+#define ACTIONLISTPOOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+struct KeyAction;
+
+using ActionList = QList<KeyAction>;
+using SharedActionList = QSharedPointer<const ActionList>;
+
+// Process-wide interning table for action lists, keyed by a hash of their
+// content. Profiles with identical actions share one immutable list, so a
+// duplicated profile costs little more than its name. Lists are never
+// modified in place: editing a profile builds a new list and interns it.
+class ActionListPool {
+public:
+    static ActionListPool &instance();
+
+    SharedActionList intern(const ActionList &actions);
+    SharedActionList empty();
+
+    // SHA-1 of the action fields, stable across runs
+    static QByteArray contentHash(const ActionList &actions);
+
+    // Decodes the "actionLists" table of a configuration file
+    QHash<QString, SharedActionList> decodeTable(const QJsonObject &table);
+
+    // Number of distinct lists currently alive
+    int uniqueCount() const;
+
+private:
+    ActionListPool();
+    void purgeExpired();
+
+    mutable QMutex m_mutex;
+    QHash<QByteArray, QWeakPointer<const ActionList>> m_lists;
+    SharedActionList m_empty;
+    int m_internsSincePurge;
+};
+
+#endif // ACTIONLISTPOOL_H
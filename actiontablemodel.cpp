@@ -0,0 +1,206 @@
+#include "actiontablemodel.h"
+
+ActionTableModel::ActionTableModel(ConfigManager *configManager, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_configManager(configManager)
+    , m_profileIndex(-1) {
+}
+
+bool ActionTableModel::hasProfile() const {
+    return m_profileIndex >= 0 && m_profileIndex < m_configManager->profileCount();
+}
+
+const ActionList &ActionTableModel::actions() const {
+    return m_configManager->profileAt(m_profileIndex).actions();
+}
+
+void ActionTableModel::setProfileIndex(int index) {
+    beginResetModel();
+    m_profileIndex = index;
+    endResetModel();
+}
+
+void ActionTableModel::appendAction(const KeyAction &action) {
+    if (!hasProfile()) {
+        return;
+    }
+
+    const int row = actions().size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_configManager->addAction(m_profileIndex, action);
+    endInsertRows();
+    emit actionsEdited();
+}
+
+void ActionTableModel::removeAction(int row) {
+    if (!hasProfile() || row < 0 || row >= actions().size()) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_configManager->removeAction(m_profileIndex, row);
+    endRemoveRows();
+    emit actionsEdited();
+}
+
+void ActionTableModel::replaceAction(int row, const KeyAction &action) {
+    if (!hasProfile() || row < 0 || row >= actions().size()) {
+        return;
+    }
+
+    m_configManager->updateAction(m_profileIndex, row, action);
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    emit actionsEdited();
+}
+
+KeyAction ActionTableModel::actionAt(int row) const {
+    if (!hasProfile() || row < 0 || row >= actions().size()) {
+        return KeyAction();
+    }
+    return actions().at(row);
+}
+
+int ActionTableModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || !hasProfile()) {
+        return 0;
+    }
+    return actions().size();
+}
+
+int ActionTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ActionTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || !hasProfile() || index.row() >= actions().size()) {
+        return QVariant();
+    }
+
+    const KeyAction &action = actions().at(index.row());
+
+    if (role == Qt::CheckStateRole && index.column() == EnabledColumn) {
+        return static_cast<int>(action.enabled ? Qt::Checked : Qt::Unchecked);
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == RangeColumn) {
+        return "Edit in action dialog for detailed settings";
+    }
+
+    if (role != Qt::DisplayRole && role != Qt::EditRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case TypeColumn:
+        switch (action.type) {
+        case InputType::Keyboard:
+            return "Keyboard";
+        case InputType::MouseLeft:
+            return "Mouse Left";
+        case InputType::MouseRight:
+            return "Mouse Right";
+        }
+        break;
+    case KeyColumn:
+        if (action.type == InputType::Keyboard) {
+            return QString("Key %1").arg(QChar(action.key));
+        }
+        return "Click";
+    case IntervalColumn:
+        return action.interval;
+    case WeightColumn:
+        return action.weight;
+    case RangeColumn:
+        return QString("%1-%2ms").arg(action.minInterval).arg(action.maxInterval);
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+bool ActionTableModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || !hasProfile() || index.row() >= actions().size()) {
+        return false;
+    }
+
+    KeyAction action = actions().at(index.row());
+
+    if (index.column() == EnabledColumn && role == Qt::CheckStateRole) {
+        action.enabled = (value.toInt() == Qt::Checked);
+    } else if (index.column() == IntervalColumn && role == Qt::EditRole) {
+        bool ok;
+        int newInterval = value.toInt(&ok);
+        if (!ok || newInterval < 100 || newInterval > 60000) {
+            emit editRejected("Invalid Interval",
+                "Interval must be between 100 and 60000 milliseconds.");
+            return false;
+        }
+        action.interval = newInterval;
+    } else if (index.column() == WeightColumn && role == Qt::EditRole) {
+        bool ok;
+        int newWeight = value.toInt(&ok);
+        if (!ok || newWeight < 1 || newWeight > 100) {
+            emit editRejected("Invalid Weight", "Weight must be between 1 and 100.");
+            return false;
+        }
+        action.weight = newWeight;
+    } else {
+        return false;
+    }
+
+    if (action == actions().at(index.row())) {
+        return true;
+    }
+
+    m_configManager->updateAction(m_profileIndex, index.row(), action);
+    emit dataChanged(index, index);
+    emit actionsEdited();
+    return true;
+}
+
+Qt::ItemFlags ActionTableModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+
+    Qt::ItemFlags itemFlags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    switch (index.column()) {
+    case IntervalColumn:
+    case WeightColumn:
+        itemFlags |= Qt::ItemIsEditable;
+        break;
+    case EnabledColumn:
+        itemFlags |= Qt::ItemIsUserCheckable;
+        break;
+    default:
+        break;
+    }
+    return itemFlags;
+}
+
+QVariant ActionTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    switch (section) {
+    case TypeColumn:
+        return "Type";
+    case KeyColumn:
+        return "Key/Button";
+    case IntervalColumn:
+        return "Interval (ms)";
+    case WeightColumn:
+        return "Weight";
+    case RangeColumn:
+        return "Min/Max Interval";
+    case EnabledColumn:
+        return "Enabled";
+    default:
+        return QVariant();
+    }
+}
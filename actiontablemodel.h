@@ -0,0 +1,57 @@
+#ifndef ACTIONTABLEMODEL_H
+#define ACTIONTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include "configmanager.h"
+
+// Table model over the actions of one profile in ConfigManager.
+// Edits go straight to the profile and only the affected cells are
+// reported as changed, so large profiles never rebuild the whole view.
+class ActionTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        TypeColumn,
+        KeyColumn,
+        IntervalColumn,
+        WeightColumn,
+        RangeColumn,
+        EnabledColumn,
+        ColumnCount
+    };
+
+    explicit ActionTableModel(ConfigManager *configManager, QObject *parent = nullptr);
+
+    // Shows another profile, or re-reads the current one after it was
+    // replaced outside the model. Resetting only invalidates visible rows.
+    void setProfileIndex(int index);
+    int profileIndex() const { return m_profileIndex; }
+
+    // Row operations, applied to ConfigManager
+    void appendAction(const KeyAction &action);
+    void removeAction(int row);
+    void replaceAction(int row, const KeyAction &action);
+    KeyAction actionAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+signals:
+    // Emitted once per accepted edit, including row insertions and removals
+    void actionsEdited();
+    void editRejected(const QString &title, const QString &message);
+
+private:
+    bool hasProfile() const;
+    const ActionList &actions() const;
+
+    ConfigManager *m_configManager;
+    int m_profileIndex;
+};
+
+#endif // ACTIONTABLEMODEL_H
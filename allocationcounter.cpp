@@ -0,0 +1,79 @@
+#include "allocationcounter.h"
+
+#if defined(AUTOKEY_COUNT_ALLOCATIONS) && defined(_MSC_VER) && defined(_DEBUG)
+#define AUTOKEY_ALLOCATION_HOOK_CRT
+#include <crtdbg.h>
+#elif defined(AUTOKEY_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+#define AUTOKEY_ALLOCATION_HOOK_GLIBC
+#include <cstddef>
+#endif
+
+namespace {
+
+// Plain integer so reading it from inside the allocator cannot allocate
+thread_local quint64 t_allocations = 0;
+
+} // namespace
+
+#ifdef AUTOKEY_ALLOCATION_HOOK_CRT
+
+namespace {
+
+// Qt links the same debug CRT, so this also sees allocations made inside Qt
+int __cdecl countAllocation(int allocType, void *, size_t, int, long, const unsigned char *, int) {
+    if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) {
+        ++t_allocations;
+    }
+    return TRUE;
+}
+
+const bool s_hookInstalled = (_CrtSetAllocHook(countAllocation), true);
+
+} // namespace
+
+bool AllocationCounter::isEnabled() {
+    return s_hookInstalled;
+}
+
+#elif defined(AUTOKEY_ALLOCATION_HOOK_GLIBC)
+
+// Definitions in the executable take precedence over libc's for every
+// library, Qt and libstdc++'s operator new included
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) {
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    ++t_allocations;
+    return __libc_realloc(pointer, size);
+}
+
+} // extern "C"
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+#endif
+
+quint64 AllocationCounter::count() {
+    return t_allocations;
+}
@@ -0,0 +1,17 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Counts the heap allocations made by the calling thread, so hot paths such
+// as the engine tick can assert that they allocate nothing. Compiled in when
+// AUTOKEY_COUNT_ALLOCATIONS is defined (Debug builds); it hooks the debug CRT
+// heap on MSVC and interposes malloc on glibc. Otherwise count() stays 0.
+class AllocationCounter {
+public:
+    static bool isEnabled();
+    // Allocations and reallocations by this thread since it started
+    static quint64 count();
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,189 @@
+// autokeyctl: command line client of AutoKey's local control channel, for
+// scripts, stream decks and other tools that drive a running instance.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include "controlclient.h"
+
+namespace {
+
+int usage() {
+    QTextStream(stderr)
+        << "Usage: autokeyctl <command> [arguments]\n"
+           "  start [profile]                   Start, optionally with another profile\n"
+           "  stop                              Stop the simulation\n"
+           "  switch <profile>                  Select a profile; a running simulation follows\n"
+           "  weight <profile> <action> <1-100> Set the weight of an action\n"
+           "  stats                             Show the engine state and counters\n"
+           "  profiles                          List the profiles\n"
+           "  ping [count]                      Measure the round-trip latency\n"
+           "Profiles are given by name or number, actions by number; both count from 1.\n";
+    return 2;
+}
+
+bool call(ControlClient &client, const ControlProtocol::Request &request,
+          ControlProtocol::Response *response = nullptr) {
+    QTextStream err(stderr);
+    ControlProtocol::Response result;
+    QString error;
+    if (!client.call(request, &result, &error)) {
+        err << "autokeyctl: " << error << Qt::endl;
+        return false;
+    }
+    if (result.status != ControlProtocol::Ok) {
+        err << "autokeyctl: " << result.message << Qt::endl;
+        return false;
+    }
+    if (response) {
+        *response = result;
+    }
+    return true;
+}
+
+// Index of a profile given by number or name, -1 if there is none
+// Profile index for a name or a number counted from 1. Returns 0, or the
+// exit code: 1 if it cannot be resolved, 2 for a number out of range.
+int resolveProfile(ControlClient &client, const QString &argument, int *profile) {
+    ControlProtocol::Request request;
+    request.command = ControlProtocol::ListProfiles;
+    ControlProtocol::Response response;
+    if (!call(client, request, &response)) {
+        return 1;
+    }
+
+    bool isNumber = false;
+    const int number = argument.toInt(&isNumber);
+    if (isNumber) {
+        if (number < 1 || number > response.profiles.size()) {
+            QTextStream(stderr) << "autokeyctl: profile number " << number << " out of range (1-"
+                                << response.profiles.size() << ")" << Qt::endl;
+            return usage();
+        }
+        *profile = number - 1;
+        return 0;
+    }
+
+    *profile = response.profiles.indexOf(argument);
+    if (*profile < 0) {
+        QTextStream(stderr) << "autokeyctl: no profile named \"" << argument << "\"" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int ping(ControlClient &client, int count) {
+    ControlProtocol::Request request;
+    request.command = ControlProtocol::Ping;
+
+    QVector<qint64> samples;
+    samples.reserve(count);
+    QElapsedTimer timer;
+    for (int i = 0; i < count; ++i) {
+        timer.start();
+        if (!call(client, request)) {
+            return 1;
+        }
+        samples.append(timer.nsecsElapsed());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    qint64 total = 0;
+    for (qint64 sample : samples) {
+        total += sample;
+    }
+    QTextStream(stdout) << QString("%1 round trips: mean %2 us, p99 %3 us, max %4 us")
+                               .arg(count)
+                               .arg(total / 1000.0 / count, 0, 'f', 1)
+                               .arg(samples[qMin(count - 1, count * 99 / 100)] / 1000.0, 0, 'f', 1)
+                               .arg(samples.last() / 1000.0, 0, 'f', 1) << Qt::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    if (args.isEmpty()) {
+        return usage();
+    }
+
+    ControlClient client;
+    QString error;
+    if (!client.connectToServer(1000, &error)) {
+        QTextStream(stderr) << "autokeyctl: " << error << Qt::endl;
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    const QString command = args[0];
+    ControlProtocol::Request request;
+
+    if (command == "start" && args.size() <= 2) {
+        request.command = ControlProtocol::Start;
+        if (args.size() == 2) {
+            if (const int result = resolveProfile(client, args[1], &request.profile)) {
+                return result;
+            }
+        }
+        return call(client, request) ? 0 : 1;
+    }
+    if (command == "stop" && args.size() == 1) {
+        request.command = ControlProtocol::Stop;
+        return call(client, request) ? 0 : 1;
+    }
+    if (command == "switch" && args.size() == 2) {
+        request.command = ControlProtocol::SwitchProfile;
+        if (const int result = resolveProfile(client, args[1], &request.profile)) {
+            return result;
+        }
+        return call(client, request) ? 0 : 1;
+    }
+    if (command == "weight" && args.size() == 4) {
+        request.command = ControlProtocol::SetWeight;
+        if (const int result = resolveProfile(client, args[1], &request.profile)) {
+            return result;
+        }
+        request.action = args[2].toInt() - 1;
+        request.value = args[3].toInt();
+        return call(client, request) ? 0 : 1;
+    }
+    if (command == "stats" && args.size() == 1) {
+        request.command = ControlProtocol::QueryStats;
+        ControlProtocol::Response response;
+        if (!call(client, request, &response)) {
+            return 1;
+        }
+        const ControlProtocol::Stats &stats = response.stats;
+        out << "State: " << (!stats.running ? "stopped"
+                             : stats.paused ? "paused"
+                             : !stats.targetActive ? "waiting for the target window" : "running") << Qt::endl;
+        if (stats.running) {
+            out << "Profile: " << stats.profile + 1 << " " << stats.profileName << Qt::endl;
+        }
+        out << "Presses: " << stats.presses << Qt::endl
+            << "Throttled waits: " << stats.throttled << Qt::endl
+            << "Urgent picks: " << stats.urgentPicks << Qt::endl
+            << "Planned ahead: " << stats.plannedAhead << Qt::endl;
+        return 0;
+    }
+    if (command == "profiles" && args.size() == 1) {
+        request.command = ControlProtocol::ListProfiles;
+        ControlProtocol::Response response;
+        if (!call(client, request, &response)) {
+            return 1;
+        }
+        for (int i = 0; i < response.profiles.size(); ++i) {
+            out << i + 1 << " " << response.profiles[i] << Qt::endl;
+        }
+        return 0;
+    }
+    if (command == "ping" && args.size() <= 2) {
+        return ping(client, qMax(1, args.value(1, "1000").toInt()));
+    }
+
+    return usage();
+}
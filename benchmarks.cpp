@@ -0,0 +1,556 @@
+#include "benchmarks.h"
+#include "allocationcounter.h"
+#include "configmanager.h"
+#include "eligibility.h"
+#include "executionplan.h"
+#include "focusgate.h"
+#include "keysimulator.h"
+#include "plancache.h"
+#include "sessionlog.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+QByteArray makeSyntheticConfig(int profileCount) {
+    QJsonArray profiles;
+    for (int i = 0; i < profileCount; ++i) {
+        ClassProfile profile(QString("Synthetic %1").arg(i));
+        for (int a = 0; a < 8; ++a) {
+            profile.addAction(KeyAction(InputType::Keyboard, 0x31 + a, 200 + 50 * a, true,
+                                        10 + (i + a * 13) % 90, 50 * (a + 1), 1000 + 250 * a));
+        }
+        profiles.append(profile.toJson());
+    }
+
+    QJsonObject root;
+    root["version"] = "1.0.0";
+    root["profiles"] = profiles;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+// Load time of a synthetic config decoded serially, then with 1..N decoder
+// threads in the global pool. blockingMapped() also decodes on the calling
+// thread, so each pool row uses one thread more than the pool has. Speedups
+// are relative to the serial row.
+int benchmarkLoad(const QStringList &args) {
+    QTextStream out(stdout);
+    const int profileCount = args.value(0, "10000").toInt();
+    const int repetitions = 5;
+
+    const QByteArray data = makeSyntheticConfig(profileCount);
+    out << "Synthetic config: " << profileCount << " profiles, "
+        << data.size() / 1024 << " KiB" << Qt::endl;
+
+    // 0 stands for the serial row
+    QList<int> threadCounts{0};
+    for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2) {
+        threadCounts.append(threads);
+    }
+    threadCounts.append(QThread::idealThreadCount());
+
+    double serialMs = 0;
+    for (int threads : threadCounts) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, threads));
+
+        ConfigManager manager;
+        manager.setParallelDecode(threads > 0);
+        qint64 bestNs = std::numeric_limits<qint64>::max();
+        for (int i = 0; i < repetitions; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+            manager.loadFromData(data);
+            bestNs = qMin(bestNs, timer.nsecsElapsed());
+        }
+
+        const double ms = bestNs / 1e6;
+        if (threads == 0) {
+            serialMs = ms;
+        }
+        const QString label = threads > 0
+            ? QString("%1 pool thread(s) + caller").arg(threads, 3)
+            : QString("serial");
+        out << QString("%1: %2 ms  (speedup %3x)")
+                   .arg(label, 26)
+                   .arg(ms, 9, 'f', 2)
+                   .arg(serialMs / ms, 0, 'f', 2) << Qt::endl;
+    }
+
+    return 0;
+}
+
+// Cost of a focus change, from the watcher's notification until the engine
+// timer has been stopped or re-armed. A fake watcher alternates the focus
+// between the target and another window.
+int benchmarkFocus(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int changes = qMax(2, args.value(0, "100000").toInt());
+
+    KeySimulator simulator;
+    simulator.startSimulation(ClassProfile::createDefaultProfile1());
+
+    FocusGate gate;
+    FakeForegroundWatcher *watcher = new FakeForegroundWatcher();
+    gate.setWatcher(watcher);
+    QObject::connect(&gate, &FocusGate::targetActiveChanged,
+                     &simulator, &KeySimulator::setTargetActive);
+    QString error;
+    gate.setTarget("Diablo III", &error);
+
+    const ForegroundWindow game{1, "Diablo III", "Diablo III64.exe"};
+    const ForegroundWindow other{2, "Build guide - Browser", "browser.exe"};
+
+    qint64 totalNs = 0;
+    qint64 worstNs = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < changes; ++i) {
+        const bool focused = i % 2 == 1;
+        timer.start();
+        watcher->activate(focused ? game : other);
+        const qint64 ns = timer.nsecsElapsed();
+
+        totalNs += ns;
+        worstNs = qMax(worstNs, ns);
+        if (simulator.isTargetActive() != focused) {
+            err << "The engine did not follow focus change " << i << Qt::endl;
+            return 1;
+        }
+    }
+    simulator.stopSimulation();
+
+    out << QString("%1 focus changes: mean %2 us, max %3 us per change")
+               .arg(changes)
+               .arg(totalNs / 1000.0 / changes, 0, 'f', 3)
+               .arg(worstNs / 1000.0, 0, 'f', 3) << Qt::endl;
+    return 0;
+}
+
+// Cost of an engine tick on a virtual clock, without sending input, and
+// the heap allocations it makes, with presses decided inline and by the
+// look-ahead planner. Fails if a steady-state tick allocates.
+int benchmarkTick(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int ticks = qMax(1, args.value(0, "1000000").toInt());
+
+    if (!AllocationCounter::isEnabled()) {
+        err << "Allocation counter not compiled in; use a Debug build (or "
+               "-DAUTOKEY_ALLOCATION_COUNTER=ON with glibc) to check allocations" << Qt::endl;
+    }
+
+    ClassProfile unlimited = ClassProfile::createDefaultProfile1();
+    ClassProfile limited = unlimited;
+    limited.setName(unlimited.getName() + " (rate limited)");
+    limited.setRateLimit(5.0);
+
+    QVector<qint64> samples(ticks);
+    int result = 0;
+    for (bool lookAhead : {false, true}) {
+        for (const ClassProfile &profile : {unlimited, limited}) {
+            KeySimulator simulator;
+            simulator.setDryRun(true);
+            simulator.setLookAhead(lookAhead);
+            simulator.startSimulation(profile);
+
+            // The planner keeps up with a real engine easily; here ticks
+            // follow each other without sleeping, so give it time to refill
+            auto waitForPlanner = [&]() {
+                for (int spin = 0; lookAhead && simulator.plannedAhead() == 0 && spin < 100000; ++spin) {
+                    QThread::yieldCurrentThread();
+                }
+            };
+
+            // Warm up until the event rings are full and only drop
+            qint64 now = QDateTime::currentMSecsSinceEpoch();
+            for (int i = 0; i < 10000; ++i) {
+                waitForPlanner();
+                now = simulator.tick(now);
+            }
+
+            QElapsedTimer timer;
+            const quint64 allocationsBefore = AllocationCounter::count();
+            for (int i = 0; i < ticks; ++i) {
+                waitForPlanner();
+                timer.start();
+                now = simulator.tick(now);
+                samples[i] = timer.nsecsElapsed();
+            }
+            const quint64 allocations = AllocationCounter::count() - allocationsBefore;
+            simulator.stopSimulation();
+
+            const double meanNs = std::accumulate(samples.cbegin(), samples.cend(), 0.0) / ticks;
+            auto p99 = samples.begin() + qMin(ticks - 1, ticks * 99 / 100);
+            std::nth_element(samples.begin(), p99, samples.end());
+
+            out << QString("%1, %2: %3 ticks, mean %4 ns, p99 %5 ns, %6 allocations")
+                       .arg(profile.getName(), lookAhead ? "look-ahead" : "inline")
+                       .arg(ticks)
+                       .arg(meanNs, 0, 'f', 1)
+                       .arg(*p99)
+                       .arg(AllocationCounter::isEnabled() ? QString::number(allocations) : "n/a")
+                << Qt::endl;
+            if (allocations > 0) {
+                err << profile.getName() << ": the engine tick allocated memory" << Qt::endl;
+                result = 1;
+            }
+        }
+    }
+    return result;
+}
+
+// Cooldown eligibility of 16 to 4096 actions with every kernel the CPU
+// supports, and the weighted pick built on it. Fails if a kernel disagrees
+// with the scalar one.
+int benchmarkEligibility(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int repetitions = qMax(1, args.value(0, "20000").toInt());
+
+    QList<Eligibility::Kernel> kernels;
+    for (Eligibility::Kernel kernel : {Eligibility::Scalar, Eligibility::Sse2, Eligibility::Avx2}) {
+        if (Eligibility::isSupported(kernel)) {
+            kernels.append(kernel);
+        }
+    }
+    out << "Best kernel: " << Eligibility::kernelName(Eligibility::bestKernel()) << Qt::endl;
+
+    QRandomGenerator rng(1);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int actions = 16; actions <= 4096; actions *= 4) {
+        ClassProfile profile(QString("Synthetic %1").arg(actions));
+        QVector<qint64> lastPressed(actions);
+        QVector<qint64> minIntervals(actions);
+        for (int i = 0; i < actions; ++i) {
+            const int minInterval = 50 + rng.bounded(5000);
+            profile.addAction(KeyAction(InputType::Keyboard, 0x41 + i % 26, 1000, true,
+                                        1 + rng.bounded(100), minInterval, minInterval * 2));
+            // About half of the actions are ready
+            minIntervals[i] = minInterval;
+            lastPressed[i] = rng.bounded(4) == 0 ? ExecutionPlan::NeverPressed
+                                                 : now - rng.bounded(2 * minInterval);
+        }
+        const ExecutionPlanPtr plan = ExecutionPlan::compile(profile);
+
+        QVector<quint64> expected(Eligibility::wordCount(actions));
+        QVector<quint64> mask(Eligibility::wordCount(actions));
+        Eligibility::compute(Eligibility::Scalar, lastPressed.constData(), minIntervals.constData(),
+                             actions, now, expected.data());
+
+        QString line = QString("%1 actions:").arg(actions, 5);
+        double scalarNs = 0;
+        for (Eligibility::Kernel kernel : kernels) {
+            QElapsedTimer timer;
+            timer.start();
+            for (int r = 0; r < repetitions; ++r) {
+                Eligibility::compute(kernel, lastPressed.constData(), minIntervals.constData(),
+                                     actions, now, mask.data());
+            }
+            const double ns = double(timer.nsecsElapsed()) / repetitions;
+            if (mask != expected) {
+                err << Eligibility::kernelName(kernel) << " disagrees with the scalar kernel at "
+                    << actions << " actions" << Qt::endl;
+                return 1;
+            }
+            if (kernel == Eligibility::Scalar) {
+                scalarNs = ns;
+            }
+            line += QString("  %1 %2 ns (%3x)").arg(Eligibility::kernelName(kernel))
+                        .arg(ns, 0, 'f', 1).arg(scalarNs / ns, 0, 'f', 1);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        int picked = 0;
+        for (int r = 0; r < repetitions; ++r) {
+            picked += plan->pick(lastPressed.constData(), now, &rng) >= 0;
+        }
+        line += QString("  pick %1 ns").arg(double(timer.nsecsElapsed()) / repetitions, 0, 'f', 1);
+        out << line << Qt::endl;
+        if (picked != repetitions) {
+            err << "No action was eligible" << Qt::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Cost of switching a running engine between the default profiles, with
+// plans taken from a PlanCache and by compiling and restarting instead.
+// Log output is muted while measuring.
+int benchmarkSwitch(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int switches = qMax(1, args.value(0, "100000").toInt());
+
+    const PersistentVector<ClassProfile> profiles({
+        ClassProfile::createDefaultProfile1(), ClassProfile::createDefaultProfile2(),
+        ClassProfile::createDefaultProfile3(), ClassProfile::createDefaultProfile4(),
+        ClassProfile::createDefaultProfile5()});
+
+    QElapsedTimer timer;
+    timer.start();
+    PlanCache cache;
+    cache.refresh(profiles);
+    out << QString("Compiled %1 plans in %2 us")
+               .arg(cache.size()).arg(timer.nsecsElapsed() / 1000.0, 0, 'f', 1) << Qt::endl;
+
+    const QtMessageHandler previousHandler =
+        qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &) {});
+
+    KeySimulator simulator;
+    simulator.setDryRun(true);
+    simulator.startSimulation(cache.plan(0, profiles[0]));
+
+    qint64 cachedNs = 0;
+    qint64 worstNs = 0;
+    for (int i = 1; i <= switches; ++i) {
+        const int index = i % profiles.size();
+        timer.start();
+        simulator.startSimulation(cache.plan(index, profiles[index]));
+        const qint64 ns = timer.nsecsElapsed();
+        cachedNs += ns;
+        worstNs = qMax(worstNs, ns);
+        // Runs the queued re-arm of the engine timer
+        QCoreApplication::processEvents();
+    }
+
+    qint64 restartNs = 0;
+    for (int i = 1; i <= switches; ++i) {
+        const int index = i % profiles.size();
+        timer.start();
+        simulator.stopSimulation();
+        simulator.startSimulation(profiles[index]);
+        restartNs += timer.nsecsElapsed();
+    }
+    simulator.stopSimulation();
+    qInstallMessageHandler(previousHandler);
+
+    out << QString("%1 switches: cached plan mean %2 us, max %3 us; compile and restart mean %4 us")
+               .arg(switches)
+               .arg(cachedNs / 1000.0 / switches, 0, 'f', 3)
+               .arg(worstNs / 1000.0, 0, 'f', 3)
+               .arg(restartNs / 1000.0 / switches, 0, 'f', 3) << Qt::endl;
+    if (cache.compileCount() != profiles.size()) {
+        err << "Switching compiled " << cache.compileCount() - profiles.size() << " plans" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Undo history of profile edits on a synthetic config: time per edit, tree
+// nodes each step adds to the history, and undoing and redoing every edit.
+// Fails if undo does not restore the exact versions edited.
+int benchmarkUndo(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int profileCount = qMax(1, args.value(0, "10000").toInt());
+    const int edits = qMax(1, args.value(1, "10000").toInt());
+
+    ConfigManager manager;
+    manager.loadFromData(makeSyntheticConfig(profileCount));
+    const ProfileList original = manager.getProfiles();
+
+    QRandomGenerator rng(1);
+    QElapsedTimer timer;
+    qint64 editNs = 0;
+    qint64 nodes = 0;
+    for (int i = 0; i < edits; ++i) {
+        const int profile = rng.bounded(profileCount);
+        KeyAction action = manager.profileAt(profile).actions().first();
+        action.weight = 1 + rng.bounded(100);
+
+        const ProfileList before = manager.getProfiles();
+        timer.start();
+        manager.updateAction(profile, 0, action);
+        editNs += timer.nsecsElapsed();
+        nodes += manager.getProfiles().unsharedNodes(before);
+    }
+
+    timer.start();
+    while (manager.undo()) {
+    }
+    const qint64 undoNs = timer.nsecsElapsed();
+    const bool restored = manager.getProfiles().isSharedWith(original);
+    timer.start();
+    while (manager.redo()) {
+    }
+    const qint64 redoNs = timer.nsecsElapsed();
+
+    out << QString("%1 edits on %2 profiles: mean %3 us per edit, %4 new nodes per step; "
+                   "undo all %5 ms, redo all %6 ms")
+               .arg(edits).arg(profileCount)
+               .arg(editNs / 1000.0 / edits, 0, 'f', 3)
+               .arg(double(nodes) / edits, 0, 'f', 1)
+               .arg(undoNs / 1e6, 0, 'f', 2)
+               .arg(redoNs / 1e6, 0, 'f', 2) << Qt::endl;
+    if (!restored) {
+        err << "Undoing every edit did not restore the loaded profiles" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// A session at the engine's top rate on a virtual clock, recorded into a
+// SessionLog: packed size against the raw events, the session file, and the
+// per-key queries against a scan of unpacked timestamps. Fails if a query,
+// or the log read back from its file, disagrees with the keys sent.
+int benchmarkSession(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const double hours = qMax(0.01, args.value(0, "8").toDouble());
+    const int rateBucketMs = 60000;
+    const int gapBucketMs = 50;
+    const int gapBuckets = 40;
+
+    // Always some key ready, so the engine presses on every tick
+    ClassProfile profile("Session benchmark");
+    for (int a = 0; a < 6; ++a) {
+        profile.addAction(KeyAction(InputType::Keyboard, 0x31 + a, 200, true,
+                                    10 + 15 * a, 100 + 50 * a, 2000));
+    }
+
+    const QtMessageHandler previousHandler =
+        qInstallMessageHandler([](QtMsgType, const QMessageLogContext &, const QString &) {});
+    KeySimulator simulator;
+    simulator.setDryRun(true);
+    simulator.startSimulation(profile);
+    SessionEventRing *events = simulator.sessionEvents();
+
+    SessionLog log;
+    QMap<int, QVector<qint64>> naive;
+    QElapsedTimer timer;
+    qint64 appendNs = 0;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 end = now + static_cast<qint64>(hours * 3600000);
+    while (now < end) {
+        now = simulator.tick(now);
+        while (const SessionEvent *event = events->front()) {
+            naive[event->key].append(event->timestamp);
+            timer.start();
+            log.append(*event);
+            appendNs += timer.nsecsElapsed();
+            events->pop();
+        }
+    }
+    simulator.stopSimulation();
+    qInstallMessageHandler(previousHandler);
+
+    const qint64 count = log.eventCount();
+    out << QString("%1 h: %2 presses of %3 keys; %4 KiB raw, %5 KiB packed; append mean %6 ns")
+               .arg(hours)
+               .arg(count)
+               .arg(log.keys().size())
+               .arg(count * qint64(sizeof(SessionEvent)) / 1024)
+               .arg(log.memoryBytes() / 1024)
+               .arg(double(appendNs) / qMax<qint64>(1, count), 0, 'f', 1) << Qt::endl;
+
+    // Per-key queries, and the same counts from the unpacked timestamps
+    const qint64 first = log.firstTimestamp();
+    const int rateBuckets = static_cast<int>((log.lastTimestamp() - first) / rateBucketMs + 1);
+    qint64 queryNs = 0;
+    qint64 naiveNs = 0;
+    int result = 0;
+    for (auto it = naive.constBegin(); it != naive.constEnd(); ++it) {
+        timer.start();
+        const QVector<int> rate = log.keyRate(it.key(), rateBucketMs);
+        const QVector<int> gaps = log.gapHistogram(it.key(), gapBucketMs, gapBuckets);
+        queryNs += timer.nsecsElapsed();
+
+        timer.start();
+        QVector<int> expectedRate(rateBuckets, 0);
+        QVector<int> expectedGaps(gapBuckets, 0);
+        for (int i = 0; i < it->size(); ++i) {
+            ++expectedRate[static_cast<int>((it->at(i) - first) / rateBucketMs)];
+            if (i > 0) {
+                ++expectedGaps[static_cast<int>(qMin<qint64>((it->at(i) - it->at(i - 1)) / gapBucketMs,
+                                                             gapBuckets - 1))];
+            }
+        }
+        naiveNs += timer.nsecsElapsed();
+
+        if (rate != expectedRate || gaps != expectedGaps || log.eventCount(it.key()) != it->size()) {
+            err << "Queries of key " << it.key() << " disagree with the presses sent" << Qt::endl;
+            result = 1;
+        }
+    }
+    out << QString("Rate and gap queries: %1 ms packed, %2 ms unpacked, for all keys")
+               .arg(queryNs / 1e6, 0, 'f', 2)
+               .arg(naiveNs / 1e6, 0, 'f', 2) << Qt::endl;
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("benchmark.aksession");
+    SessionLog loaded;
+    QString error;
+    timer.start();
+    if (!log.save(fileName, &error)) {
+        err << fileName << ": " << error << Qt::endl;
+        return 1;
+    }
+    const qint64 saveNs = timer.nsecsElapsed();
+    timer.start();
+    if (!loaded.load(fileName, &error)) {
+        err << fileName << ": " << error << Qt::endl;
+        return 1;
+    }
+    const qint64 loadNs = timer.nsecsElapsed();
+    out << QString("Session file: %1 KiB, written in %2 ms, read in %3 ms")
+               .arg(QFileInfo(fileName).size() / 1024)
+               .arg(saveNs / 1e6, 0, 'f', 2)
+               .arg(loadNs / 1e6, 0, 'f', 2) << Qt::endl;
+
+    for (int key : log.keys()) {
+        if (loaded.keyRate(key, rateBucketMs) != log.keyRate(key, rateBucketMs)
+            || loaded.gapHistogram(key, gapBucketMs, gapBuckets) != log.gapHistogram(key, gapBucketMs, gapBuckets)) {
+            err << "The session file does not reproduce key " << key << Qt::endl;
+            result = 1;
+        }
+    }
+    if (loaded.eventCount() != count) {
+        err << "The session file holds " << loaded.eventCount() << " of " << count << " presses" << Qt::endl;
+        result = 1;
+    }
+    return result;
+}
+
+} // namespace
+
+int runBenchmark(const QStringList &arguments) {
+    const QString name = arguments.value(1);
+    const QStringList args = arguments.mid(2);
+
+    if (name == "--bench-load") {
+        return benchmarkLoad(args);
+    }
+    if (name == "--bench-focus") {
+        return benchmarkFocus(args);
+    }
+    if (name == "--bench-tick") {
+        return benchmarkTick(args);
+    }
+    if (name == "--bench-eligibility") {
+        return benchmarkEligibility(args);
+    }
+    if (name == "--bench-switch") {
+        return benchmarkSwitch(args);
+    }
+    if (name == "--bench-undo") {
+        return benchmarkUndo(args);
+    }
+    if (name == "--bench-session") {
+        return benchmarkSession(args);
+    }
+
+    QTextStream(stderr) << "Unknown benchmark: " << name << Qt::endl;
+    return 1;
+}
@@ -0,0 +1,10 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <QStringList>
+
+// Headless performance benchmarks, run as "AutoKey --bench-<name> [args]".
+// Returns the process exit code.
+int runBenchmark(const QStringList &arguments);
+
+#endif // BENCHMARKS_H
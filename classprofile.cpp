@@ -24,58 +24,173 @@ void KeyAction::fromJson(const QJsonObject &json) {
     maxInterval = json["maxInterval"].toInt(1000);  // Default to 1000ms
 }
 
+bool KeyAction::validate(QStringList *problems) {
+    QStringList found;
+
+    // Key 0 means "not set yet" and is never pressed
+    if (type == InputType::Keyboard && (key < 0 || key > 0xFE)) {
+        found << QString("key code %1 out of range").arg(key);
+        enabled = false;
+    }
+    if (weight < 1 || weight > 100) {
+        found << QString("weight %1 out of range").arg(weight);
+        weight = qBound(1, weight, 100);
+    }
+    if (minInterval < 0) {
+        found << QString("negative minInterval %1").arg(minInterval);
+        minInterval = 0;
+    }
+    if (maxInterval < 0) {
+        found << QString("negative maxInterval %1").arg(maxInterval);
+        maxInterval = 0;
+    }
+    if (minInterval > maxInterval) {
+        found << QString("minInterval %1 exceeds maxInterval %2").arg(minInterval).arg(maxInterval);
+        qSwap(minInterval, maxInterval);
+    }
+
+    if (problems) {
+        problems->append(found);
+    }
+    return found.isEmpty();
+}
+
 // ClassProfile implementation
-ClassProfile::ClassProfile() : m_name("New Profile"), m_enabled(true) {
+ClassProfile::ClassProfile()
+    : m_name("New Profile"), m_actions(ActionListPool::instance().empty()), m_enabled(true)
+    , m_rateLimit(0.0), m_rateBurst(DefaultRateBurst) {
+}
+
+ClassProfile::ClassProfile(const QString &name)
+    : m_name(name), m_actions(ActionListPool::instance().empty()), m_enabled(true)
+    , m_rateLimit(0.0), m_rateBurst(DefaultRateBurst) {
 }
 
-ClassProfile::ClassProfile(const QString &name) : m_name(name), m_enabled(true) {
+// Edits copy the shared list, modify the copy and intern the result
+void ClassProfile::setActions(const QList<KeyAction> &actions) {
+    m_actions = ActionListPool::instance().intern(actions);
 }
 
 void ClassProfile::addAction(const KeyAction &action) {
-    m_actions.append(action);
+    ActionList actions = *m_actions;
+    actions.append(action);
+    setActions(actions);
 }
 
 void ClassProfile::removeAction(int index) {
-    if (index >= 0 && index < m_actions.size()) {
-        m_actions.removeAt(index);
+    if (index >= 0 && index < m_actions->size()) {
+        ActionList actions = *m_actions;
+        actions.removeAt(index);
+        setActions(actions);
     }
 }
 
 void ClassProfile::updateAction(int index, const KeyAction &action) {
-    if (index >= 0 && index < m_actions.size()) {
-        m_actions[index] = action;
+    if (index >= 0 && index < m_actions->size() && m_actions->at(index) != action) {
+        ActionList actions = *m_actions;
+        actions[index] = action;
+        setActions(actions);
     }
 }
 
 void ClassProfile::clearActions() {
-    m_actions.clear();
+    m_actions = ActionListPool::instance().empty();
 }
 
-QJsonObject ClassProfile::toJson() const {
+QJsonObject ClassProfile::toJson(const QString &actionsRef) const {
     QJsonObject obj;
     obj["name"] = m_name;
     obj["enabled"] = m_enabled;
+    // Only limited profiles carry the budget, keeping older files unchanged
+    if (m_rateLimit > 0.0) {
+        obj["rateLimit"] = m_rateLimit;
+        obj["rateBurst"] = m_rateBurst;
+    }
     
-    QJsonArray actionsArray;
-    for (const auto &action : m_actions) {
-        actionsArray.append(action.toJson());
+    if (actionsRef.isEmpty()) {
+        obj["actions"] = actionsToJson(*m_actions);
+    } else {
+        obj["actionsRef"] = actionsRef;
     }
-    obj["actions"] = actionsArray;
     
     return obj;
 }
 
-void ClassProfile::fromJson(const QJsonObject &json) {
+void ClassProfile::fromJson(const QJsonObject &json, const QHash<QString, SharedActionList> &actionLists) {
     m_name = json["name"].toString();
     m_enabled = json["enabled"].toBool();
+    setRateLimit(json["rateLimit"].toDouble(0.0));
+    setRateBurst(json["rateBurst"].toInt(DefaultRateBurst));
     
-    m_actions.clear();
-    QJsonArray actionsArray = json["actions"].toArray();
-    for (const auto &value : actionsArray) {
+    const QString actionsRef = json["actionsRef"].toString();
+    if (!actionsRef.isEmpty() && actionLists.contains(actionsRef)) {
+        m_actions = actionLists.value(actionsRef);
+    } else {
+        setActions(actionsFromJson(json["actions"].toArray()));
+    }
+}
+
+QJsonArray ClassProfile::actionsToJson(const ActionList &actions) {
+    QJsonArray actionsArray;
+    for (const auto &action : actions) {
+        actionsArray.append(action.toJson());
+    }
+    return actionsArray;
+}
+
+ActionList ClassProfile::actionsFromJson(const QJsonArray &array) {
+    ActionList actions;
+    actions.reserve(array.size());
+    for (const auto &value : array) {
         KeyAction action;
         action.fromJson(value.toObject());
-        m_actions.append(action);
+        actions.append(action);
+    }
+    return actions;
+}
+
+bool ClassProfile::validate(QStringList *problems) {
+    // Only copy the shared list if something actually needs fixing
+    ActionList fixed;
+    bool valid = true;
+    for (int i = 0; i < m_actions->size(); ++i) {
+        KeyAction action = m_actions->at(i);
+        QStringList actionProblems;
+        if (!action.validate(&actionProblems)) {
+            if (valid) {
+                fixed = *m_actions;
+                valid = false;
+            }
+            fixed[i] = action;
+            if (problems) {
+                for (const auto &problem : actionProblems) {
+                    problems->append(QString("%1, action %2: %3").arg(m_name).arg(i + 1).arg(problem));
+                }
+            }
+        }
+    }
+
+    if (!valid) {
+        setActions(fixed);
+    }
+    return valid;
+}
+
+QHash<const ActionList *, QString> ClassProfile::sharedActionRefs(const QList<ClassProfile> &profiles) {
+    QHash<const ActionList *, int> useCount;
+    for (const auto &profile : profiles) {
+        if (!profile.actions().isEmpty()) {
+            ++useCount[profile.m_actions.data()];
+        }
+    }
+
+    QHash<const ActionList *, QString> refs;
+    for (auto it = useCount.constBegin(); it != useCount.constEnd(); ++it) {
+        if (it.value() > 1) {
+            refs.insert(it.key(), QString::fromLatin1(ActionListPool::contentHash(*it.key()).toHex()));
+        }
     }
+    return refs;
 }
 
 // Default profiles
@@ -5,6 +5,10 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QList>
+#include <QStringList>
+#include <QMetaType>
+#include <QHash>
+#include "actionlistpool.h"
 
 enum class InputType {
     Keyboard,
@@ -26,8 +30,20 @@ struct KeyAction {
     KeyAction(InputType t, int k, int i, bool e = true, int w = 50, int minInt = 50, int maxInt = 1000)
         : type(t), key(k), interval(i), enabled(e), weight(w), minInterval(minInt), maxInterval(maxInt) {}
 
+    bool operator==(const KeyAction &other) const {
+        return type == other.type && key == other.key && interval == other.interval
+            && enabled == other.enabled && weight == other.weight
+            && minInterval == other.minInterval && maxInterval == other.maxInterval;
+    }
+    bool operator!=(const KeyAction &other) const { return !(*this == other); }
+
     QJsonObject toJson() const;
     void fromJson(const QJsonObject &json);
+
+    // Fixes out-of-range values: weight is clamped to 1-100, swapped min/max
+    // intervals are reordered and actions with an invalid key code are disabled.
+    // Returns false and describes the problems if anything had to be fixed.
+    bool validate(QStringList *problems = nullptr);
 };
 
 class ClassProfile {
@@ -37,13 +53,21 @@ public:
     
     // Getters
     QString getName() const { return m_name; }
-    QList<KeyAction> getActions() const { return m_actions; }
+    QList<KeyAction> getActions() const { return *m_actions; }
+    const ActionList &actions() const { return *m_actions; }
+    SharedActionList sharedActions() const { return m_actions; }
     bool isEnabled() const { return m_enabled; }
+    // Presses per second the engine may send for this profile, 0 for no
+    // limit, and how many presses may go out back to back within it
+    double getRateLimit() const { return m_rateLimit; }
+    int getRateBurst() const { return m_rateBurst; }
     
     // Setters
     void setName(const QString &name) { m_name = name; }
     void setEnabled(bool enabled) { m_enabled = enabled; }
-    void setActions(const QList<KeyAction> &actions) { m_actions = actions; }
+    void setRateLimit(double pressesPerSecond) { m_rateLimit = qMax(0.0, pressesPerSecond); }
+    void setRateBurst(int burst) { m_rateBurst = qMax(1, burst); }
+    void setActions(const QList<KeyAction> &actions);
     
     // Action management
     void addAction(const KeyAction &action);
@@ -51,9 +75,21 @@ public:
     void updateAction(int index, const KeyAction &action);
     void clearActions();
     
-    // JSON serialization
-    QJsonObject toJson() const;
-    void fromJson(const QJsonObject &json);
+    // JSON serialization. Profiles whose actions are stored in the shared
+    // "actionLists" table reference them through "actionsRef".
+    QJsonObject toJson(const QString &actionsRef = QString()) const;
+    void fromJson(const QJsonObject &json,
+                  const QHash<QString, SharedActionList> &actionLists = QHash<QString, SharedActionList>());
+    static QJsonArray actionsToJson(const ActionList &actions);
+    static ActionList actionsFromJson(const QJsonArray &array);
+    
+    // Content-hash references for action lists shared by several profiles
+    static QHash<const ActionList *, QString> sharedActionRefs(const QList<ClassProfile> &profiles);
+    
+    // Validates every action, see KeyAction::validate()
+    bool validate(QStringList *problems = nullptr);
+    
+    static const int DefaultRateBurst = 3;
     
     // Static methods for default profiles
     static ClassProfile createDefaultProfile1();
@@ -64,8 +100,12 @@ public:
     
 private:
     QString m_name;
-    QList<KeyAction> m_actions;
+    SharedActionList m_actions;   // Interned and immutable, see ActionListPool
     bool m_enabled;
+    double m_rateLimit;
+    int m_rateBurst;
 };
 
+Q_DECLARE_METATYPE(ClassProfile)
+
 #endif // CLASSPROFILE_H
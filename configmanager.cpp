@@ -4,13 +4,55 @@
 #include <QDebug>
 #include <QDir>
 #include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QVector>
+#include <QtConcurrent>
+#include <QSaveFile>
+#include "profilepack.h"
+
+namespace {
+
+// Profiles decoded per task: small enough to balance across cores,
+// large enough to amortize the thread pool overhead
+const int ProfilesPerChunk = 64;
+
+struct ProfileChunk {
+    QJsonArray source;
+    const QHash<QString, SharedActionList> *actionLists;
+    int begin;
+    int end;
+};
+
+struct DecodedChunk {
+    QList<ClassProfile> profiles;
+    QStringList problems;
+};
+
+DecodedChunk decodeChunk(const ProfileChunk &chunk) {
+    DecodedChunk result;
+    result.profiles.reserve(chunk.end - chunk.begin);
+    for (int i = chunk.begin; i < chunk.end; ++i) {
+        ClassProfile profile;
+        profile.fromJson(chunk.source.at(i).toObject(), *chunk.actionLists);
+        profile.validate(&result.problems);
+        result.profiles.append(profile);
+    }
+    return result;
+}
+
+} // namespace
 
 ConfigManager::ConfigManager()
     : m_startHotkey("F5")
     , m_stopHotkey("F6")
+    , m_pauseHotkey("F7")
     , m_currentProfileIndex(0)
     , m_minimizeToTray(true)
-    , m_startMinimized(false) {
+    , m_startMinimized(false)
+    , m_replaySpeed(1.0)
+    , m_replayLoop(false)
+    , m_lookAhead(true)
+    , m_parallelDecode(true) {
 }
 
 QString ConfigManager::getDefaultConfigPath() const {
@@ -29,43 +71,130 @@ bool ConfigManager::loadConfiguration(const QString &filePath) {
         return false;
     }
     
-    QByteArray data = file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    
-    if (doc.isNull() || !doc.isObject()) {
+    if (!loadFromData(file.readAll())) {
         qDebug() << "Invalid JSON in config file";
         createDefaultConfiguration();
         return false;
     }
     
-    fromJson(doc.object());
     qDebug() << "Configuration loaded successfully from:" << actualPath;
     return true;
 }
 
-bool ConfigManager::saveConfiguration(const QString &filePath) {
+bool ConfigManager::loadFromData(const QByteArray &data) {
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    fromJson(doc.object());
+    clearHistory();
+    m_syncedDigest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    return true;
+}
+
+bool ConfigManager::reloadConfiguration(const QString &filePath) {
     QString actualPath = filePath.isEmpty() ? getDefaultConfigPath() : filePath;
 
-    QJsonDocument doc(toJson());
+    QFile file(actualPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open config file for reloading:" << actualPath;
+        return false;
+    }
+
+    // Editors may trigger a change notification while the file is half written
+    const QByteArray data = file.readAll();
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull() || !doc.isObject()) {
+        qDebug() << "Ignoring invalid JSON while reloading:" << actualPath;
+        return false;
+    }
+
+    // An edit made outside the application can be undone like any other
+    recordEdit();
+    fromJson(doc.object());
+    m_syncedDigest = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    qDebug() << "Configuration reloaded from:" << actualPath;
+    return true;
+}
+
+bool ConfigManager::hasExternalChanges(const QString &filePath) const {
+    QString actualPath = filePath.isEmpty() ? getDefaultConfigPath() : filePath;
 
     QFile file(actualPath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Could not open config file for writing:" << actualPath;
+    if (!file.open(QIODevice::ReadOnly)) {
         return false;
     }
 
-    file.write(doc.toJson());
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1) != m_syncedDigest;
+}
+
+bool ConfigManager::saveConfiguration(const QString &filePath) {
+    QString actualPath = filePath.isEmpty() ? getDefaultConfigPath() : filePath;
+
+    const QByteArray digest = writeSnapshot(snapshot(), actualPath);
+    if (digest.isEmpty()) {
+        return false;
+    }
+    m_syncedDigest = digest;
     qDebug() << "Configuration saved successfully to:" << actualPath;
     return true;
 }
 
+QByteArray ConfigManager::writeSnapshot(const Snapshot &snapshot, const QString &filePath) {
+    QJsonDocument doc(toJson(snapshot));
+
+    // Written to a temporary file and renamed over the config, so a crash
+    // while writing cannot truncate it
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Could not open config file for writing:" << filePath;
+        return QByteArray();
+    }
+
+    QByteArray data = doc.toJson();
+    if (file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "Failed to write config file:" << filePath << file.errorString();
+        return QByteArray();
+    }
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+bool ConfigManager::exportPack(const QString &filePath) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Could not open profile pack for writing:" << filePath;
+        return false;
+    }
+
+    ProfilePackWriter writer(&file);
+    if (!writer.write(settingsToJson(), m_profiles.toList()) || !file.commit()) {
+        qDebug() << "Failed to write profile pack:" << writer.errorString();
+        return false;
+    }
+
+    qDebug() << "Exported" << m_profiles.size() << "profiles to:" << filePath;
+    return true;
+}
+
+void ConfigManager::setProfiles(const QList<ClassProfile> &profiles) {
+    recordEdit();
+    m_profiles = ProfileList(profiles);
+}
+
 void ConfigManager::addProfile(const ClassProfile &profile) {
+    recordEdit();
     m_profiles.append(profile);
 }
 
 void ConfigManager::removeProfile(int index) {
     if (index >= 0 && index < m_profiles.size()) {
+        recordEdit();
         m_profiles.removeAt(index);
+        if (index < m_profileHotkeys.size()) {
+            m_profileHotkeys.removeAt(index);
+        }
         
         // Adjust current profile index if necessary
         if (m_currentProfileIndex >= m_profiles.size()) {
@@ -76,10 +205,47 @@ void ConfigManager::removeProfile(int index) {
 
 void ConfigManager::updateProfile(int index, const ClassProfile &profile) {
     if (index >= 0 && index < m_profiles.size()) {
-        m_profiles[index] = profile;
+        recordEdit();
+        m_profiles.replace(index, profile);
     }
 }
 
+// Profiles are immutable inside the list; an action edit replaces the profile
+void ConfigManager::addAction(int profileIndex, const KeyAction &action) {
+    if (profileIndex >= 0 && profileIndex < m_profiles.size()) {
+        ClassProfile profile = m_profiles.at(profileIndex);
+        profile.addAction(action);
+        updateProfile(profileIndex, profile);
+    }
+}
+
+void ConfigManager::removeAction(int profileIndex, int actionIndex) {
+    if (profileIndex >= 0 && profileIndex < m_profiles.size()) {
+        ClassProfile profile = m_profiles.at(profileIndex);
+        profile.removeAction(actionIndex);
+        updateProfile(profileIndex, profile);
+    }
+}
+
+void ConfigManager::updateAction(int profileIndex, int actionIndex, const KeyAction &action) {
+    if (profileIndex >= 0 && profileIndex < m_profiles.size()) {
+        ClassProfile profile = m_profiles.at(profileIndex);
+        profile.updateAction(actionIndex, action);
+        updateProfile(profileIndex, profile);
+    }
+}
+
+void ConfigManager::setProfileHotkey(int index, const QString &hotkey) {
+    if (index < 0 || index >= m_profiles.size() || hotkey == m_profileHotkeys.value(index)) {
+        return;
+    }
+    recordEdit();
+    while (m_profileHotkeys.size() <= index) {
+        m_profileHotkeys.append(QString());
+    }
+    m_profileHotkeys[index] = hotkey;
+}
+
 void ConfigManager::createDefaultConfiguration() {
     m_profiles.clear();
     
@@ -92,31 +258,96 @@ void ConfigManager::createDefaultConfiguration() {
     
     m_startHotkey = "F5";
     m_stopHotkey = "F6";
+    m_pauseHotkey = "F7";
+    m_profileHotkeys.clear();
     m_currentProfileIndex = 0;
     m_minimizeToTray = true;
     m_startMinimized = false;
+    m_replaySpeed = 1.0;
+    m_replayLoop = false;
+    m_lookAhead = true;
+    m_targetWindow.clear();
     
     qDebug() << "Default configuration created";
 }
 
 void ConfigManager::resetToDefaults() {
+    recordEdit();
     createDefaultConfiguration();
 }
 
-QJsonObject ConfigManager::toJson() const {
+bool ConfigManager::undo() {
+    if (m_undoStack.isEmpty()) {
+        return false;
+    }
+    m_redoStack.append(profileState());
+    restoreProfileState(m_undoStack.takeLast());
+    return true;
+}
+
+bool ConfigManager::redo() {
+    if (m_redoStack.isEmpty()) {
+        return false;
+    }
+    m_undoStack.append(profileState());
+    restoreProfileState(m_redoStack.takeLast());
+    return true;
+}
+
+void ConfigManager::clearHistory() {
+    m_undoStack.clear();
+    m_redoStack.clear();
+}
+
+void ConfigManager::recordEdit() {
+    m_undoStack.append(profileState());
+    m_redoStack.clear();
+}
+
+void ConfigManager::restoreProfileState(const ProfileState &state) {
+    m_profiles = state.profiles;
+    m_profileHotkeys = state.profileHotkeys;
+    m_currentProfileIndex = qBound(0, state.currentProfileIndex, qMax(0, m_profiles.size() - 1));
+}
+
+QJsonObject ConfigManager::settingsToJson() const {
     QJsonObject obj;
-    
-    // Settings
     obj["startHotkey"] = m_startHotkey;
     obj["stopHotkey"] = m_stopHotkey;
+    obj["pauseHotkey"] = m_pauseHotkey;
+    if (!m_profileHotkeys.isEmpty()) {
+        obj["profileHotkeys"] = QJsonArray::fromStringList(m_profileHotkeys);
+    }
     obj["currentProfileIndex"] = m_currentProfileIndex;
     obj["minimizeToTray"] = m_minimizeToTray;
     obj["startMinimized"] = m_startMinimized;
+    obj["replaySpeed"] = m_replaySpeed;
+    obj["replayLoop"] = m_replayLoop;
+    obj["targetWindow"] = m_targetWindow;
+    obj["lookAhead"] = m_lookAhead;
+    return obj;
+}
+
+QJsonObject ConfigManager::toJson(const Snapshot &snapshot) {
+    // Settings
+    QJsonObject obj = snapshot.settings;
     
-    // Profiles
+    // Profiles. Interned action lists used by more than one profile are
+    // written once to "actionLists" and referenced by their content hash.
+    const QList<ClassProfile> profiles = snapshot.profiles.toList();
+    const QHash<const ActionList *, QString> refs = ClassProfile::sharedActionRefs(profiles);
+    QJsonObject actionLists;
     QJsonArray profilesArray;
-    for (const auto &profile : m_profiles) {
-        profilesArray.append(profile.toJson());
+    for (const auto &profile : profiles) {
+        const ActionList *actions = profile.sharedActions().data();
+        const QString ref = refs.value(actions);
+        if (!ref.isEmpty() && !actionLists.contains(ref)) {
+            actionLists[ref] = ClassProfile::actionsToJson(*actions);
+        }
+        profilesArray.append(profile.toJson(ref));
+    }
+    if (!actionLists.isEmpty()) {
+        obj["actionLists"] = actionLists;
     }
     obj["profiles"] = profilesArray;
     
@@ -128,22 +359,65 @@ QJsonObject ConfigManager::toJson() const {
 }
 
 void ConfigManager::fromJson(const QJsonObject &json) {
-    // Settings
+    settingsFromJson(json);
+    
+    // Shared action lists are decoded once, before the profiles referencing them
+    const QHash<QString, SharedActionList> actionLists =
+        ActionListPool::instance().decodeTable(json["actionLists"].toObject());
+
+    // Profiles are decoded and validated in parallel chunks, then merged in order
+    const QJsonArray profilesArray = json["profiles"].toArray();
+    QVector<ProfileChunk> chunks;
+    for (int begin = 0; begin < profilesArray.size(); begin += ProfilesPerChunk) {
+        chunks.append({profilesArray, &actionLists, begin,
+                       qMin(begin + ProfilesPerChunk, profilesArray.size())});
+    }
+
+    QVector<DecodedChunk> decoded;
+    if (chunks.size() <= 1 || !m_parallelDecode) {
+        for (const ProfileChunk &chunk : chunks) {
+            decoded.append(decodeChunk(chunk));
+        }
+    } else {
+        decoded = QtConcurrent::blockingMapped<QVector<DecodedChunk>>(chunks, decodeChunk);
+    }
+
+    QList<ClassProfile> profiles;
+    profiles.reserve(profilesArray.size());
+    int problemCount = 0;
+    for (const auto &chunk : decoded) {
+        profiles.append(chunk.profiles);
+        for (const auto &problem : chunk.problems) {
+            qDebug() << "Corrected invalid action in" << problem;
+        }
+        problemCount += chunk.problems.size();
+    }
+    if (problemCount > 0) {
+        qDebug() << problemCount << "invalid action settings corrected while loading";
+    }
+    m_profiles = ProfileList(profiles);
+    
+    validateProfiles();
+}
+
+void ConfigManager::settingsFromJson(const QJsonObject &json) {
     m_startHotkey = json["startHotkey"].toString("F5");
     m_stopHotkey = json["stopHotkey"].toString("F6");
+    m_pauseHotkey = json["pauseHotkey"].toString("F7");
+    m_profileHotkeys.clear();
+    for (const QJsonValue &hotkey : json["profileHotkeys"].toArray()) {
+        m_profileHotkeys.append(hotkey.toString());
+    }
     m_currentProfileIndex = json["currentProfileIndex"].toInt(0);
     m_minimizeToTray = json["minimizeToTray"].toBool(true);
     m_startMinimized = json["startMinimized"].toBool(false);
-    
-    // Profiles
-    m_profiles.clear();
-    QJsonArray profilesArray = json["profiles"].toArray();
-    for (const auto &value : profilesArray) {
-        ClassProfile profile;
-        profile.fromJson(value.toObject());
-        m_profiles.append(profile);
-    }
-    
+    m_replaySpeed = json["replaySpeed"].toDouble(1.0);
+    m_replayLoop = json["replayLoop"].toBool(false);
+    m_targetWindow = json["targetWindow"].toString();
+    m_lookAhead = json["lookAhead"].toBool(true);
+}
+
+void ConfigManager::validateProfiles() {
     // Ensure we have at least one profile
     if (m_profiles.isEmpty()) {
         createDefaultConfiguration();
@@ -154,3 +428,34 @@ void ConfigManager::fromJson(const QJsonObject &json) {
         m_currentProfileIndex = 0;
     }
 }
+
+void ConfigManager::beginImport() {
+    m_importedProfiles.clear();
+}
+
+void ConfigManager::appendImportedProfiles(const QList<ClassProfile> &profiles) {
+    m_importedProfiles.append(profiles);
+}
+
+void ConfigManager::commitImport(const QJsonObject &settings, bool replace) {
+    // Loading a configuration starts a new history, like loadFromData();
+    // importing profiles into this one can be undone
+    if (replace) {
+        clearHistory();
+        settingsFromJson(settings);
+        m_profiles = ProfileList(m_importedProfiles);
+    } else {
+        recordEdit();
+        for (const auto &profile : m_importedProfiles) {
+            m_profiles.append(profile);
+        }
+    }
+    m_importedProfiles.clear();
+
+    validateProfiles();
+    qDebug() << "Import committed," << m_profiles.size() << "profiles available";
+}
+
+void ConfigManager::abortImport() {
+    m_importedProfiles.clear();
+}
@@ -3,9 +3,15 @@
 
 #include <QString>
 #include <QList>
+#include <QStringList>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QVector>
 #include "classprofile.h"
+#include "persistentvector.h"
+
+// Profiles share structure between versions, see PersistentVector
+using ProfileList = PersistentVector<ClassProfile>;
 
 class ConfigManager {
 public:
@@ -14,44 +20,133 @@ public:
     // Configuration file management
     bool loadConfiguration(const QString &filePath = "");
     bool saveConfiguration(const QString &filePath = "");
+    // Parses a configuration document, leaving the current state untouched if it is invalid
+    bool loadFromData(const QByteArray &data);
+    // Profiles are decoded on the global thread pool; off decodes them on the
+    // calling thread only, e.g. as the serial baseline of --bench-load
+    void setParallelDecode(bool enabled) { m_parallelDecode = enabled; }
+    // Writes all profiles as a compressed, checksummed *.akpack file
+    bool exportPack(const QString &filePath);
+    // Re-reads the file as one undoable edit, leaving the current state
+    // untouched if it is invalid
+    bool reloadConfiguration(const QString &filePath = "");
+    // True if the file content differs from what was last loaded or saved
+    bool hasExternalChanges(const QString &filePath = "") const;
     QString getDefaultConfigPath() const;
     
-    // Profile management
-    QList<ClassProfile> getProfiles() const { return m_profiles; }
-    void setProfiles(const QList<ClassProfile> &profiles) { m_profiles = profiles; }
+    // Everything saveConfiguration() writes. Taking one is O(1): the profiles
+    // are a version shared with the live state, which later edits leave alone.
+    struct Snapshot {
+        QJsonObject settings;
+        ProfileList profiles;
+    };
+    Snapshot snapshot() const { return {settingsToJson(), m_profiles}; }
+    // Writes a snapshot as a configuration file; safe on any thread. Returns
+    // the digest to pass to markSynced(), empty on failure.
+    static QByteArray writeSnapshot(const Snapshot &snapshot, const QString &filePath);
+    // Records a snapshot written by writeSnapshot() as the file content
+    void markSynced(const QByteArray &digest) { m_syncedDigest = digest; }
+    
+    // Profile management. The returned version does not change with later edits.
+    ProfileList getProfiles() const { return m_profiles; }
+    void setProfiles(const QList<ClassProfile> &profiles);
     
     void addProfile(const ClassProfile &profile);
     void removeProfile(int index);
     void updateProfile(int index, const ClassProfile &profile);
     
+    // In-place access, without copying the profile list
+    int profileCount() const { return m_profiles.size(); }
+    const ClassProfile &profileAt(int index) const { return m_profiles.at(index); }
+    void addAction(int profileIndex, const KeyAction &action);
+    void removeAction(int profileIndex, int actionIndex);
+    void updateAction(int profileIndex, int actionIndex, const KeyAction &action);
+    
+    // Unlimited undo of the profile edits above, profile hotkeys and imports.
+    // Each step keeps the previous version of the profiles, which shares all
+    // but O(log n) nodes with the next. Loading a file starts a new history.
+    bool canUndo() const { return !m_undoStack.isEmpty(); }
+    bool canRedo() const { return !m_redoStack.isEmpty(); }
+    bool undo();
+    bool redo();
+    void clearHistory();
+    
+    // Streaming import: profiles are staged as they arrive and only replace
+    // or extend the live profiles once the whole file has been read
+    void beginImport();
+    void appendImportedProfiles(const QList<ClassProfile> &profiles);
+    void commitImport(const QJsonObject &settings, bool replace);
+    void abortImport();
+    
     // Settings management
     QString getStartHotkey() const { return m_startHotkey; }
     QString getStopHotkey() const { return m_stopHotkey; }
+    QString getPauseHotkey() const { return m_pauseHotkey; }
+    // Hotkey switching to the profile at the same index, empty for none
+    QString getProfileHotkey(int index) const { return m_profileHotkeys.value(index); }
     int getCurrentProfileIndex() const { return m_currentProfileIndex; }
     bool getMinimizeToTray() const { return m_minimizeToTray; }
     bool getStartMinimized() const { return m_startMinimized; }
+    double getReplaySpeed() const { return m_replaySpeed; }
+    // Keys are only sent while this window is focused, empty for any window
+    QString getTargetWindow() const { return m_targetWindow; }
+    bool getReplayLoop() const { return m_replayLoop; }
+    // Presses are decided ahead on a worker thread
+    bool getLookAhead() const { return m_lookAhead; }
     
     void setStartHotkey(const QString &hotkey) { m_startHotkey = hotkey; }
     void setStopHotkey(const QString &hotkey) { m_stopHotkey = hotkey; }
+    void setPauseHotkey(const QString &hotkey) { m_pauseHotkey = hotkey; }
+    void setProfileHotkey(int index, const QString &hotkey);
     void setCurrentProfileIndex(int index) { m_currentProfileIndex = index; }
     void setMinimizeToTray(bool minimize) { m_minimizeToTray = minimize; }
     void setStartMinimized(bool startMin) { m_startMinimized = startMin; }
+    void setReplaySpeed(double speed) { m_replaySpeed = speed; }
+    void setTargetWindow(const QString &target) { m_targetWindow = target; }
+    void setReplayLoop(bool loop) { m_replayLoop = loop; }
+    void setLookAhead(bool enabled) { m_lookAhead = enabled; }
+    
+    QJsonObject settingsToJson() const;
     
     // Utility methods
     void createDefaultConfiguration();
     void resetToDefaults();
     
 private:
-    QList<ClassProfile> m_profiles;
+    // The part of the configuration covered by undo
+    struct ProfileState {
+        ProfileList profiles;
+        QStringList profileHotkeys;
+        int currentProfileIndex;
+    };
+    ProfileState profileState() const { return {m_profiles, m_profileHotkeys, m_currentProfileIndex}; }
+    void restoreProfileState(const ProfileState &state);
+    // Called by every undoable edit before it changes anything
+    void recordEdit();
+
+    ProfileList m_profiles;
     QString m_startHotkey;
     QString m_stopHotkey;
+    QString m_pauseHotkey;
+    QStringList m_profileHotkeys;  // Indexed like m_profiles
     int m_currentProfileIndex;
     bool m_minimizeToTray;
     bool m_startMinimized;
+    double m_replaySpeed;
+    QString m_targetWindow;
+    bool m_replayLoop;
+    bool m_lookAhead;
+    QByteArray m_syncedDigest;
+    bool m_parallelDecode;
+    QList<ClassProfile> m_importedProfiles;
+    QVector<ProfileState> m_undoStack;
+    QVector<ProfileState> m_redoStack;
     
     // JSON conversion helpers
-    QJsonObject toJson() const;
+    static QJsonObject toJson(const Snapshot &snapshot);
     void fromJson(const QJsonObject &json);
+    void settingsFromJson(const QJsonObject &json);
+    void validateProfiles();
 };
 
 #endif // CONFIGMANAGER_H
@@ -0,0 +1,47 @@
+#include "controlclient.h"
+
+bool ControlClient::connectToServer(int timeoutMs, QString *errorString) {
+    m_socket.connectToServer(ControlProtocol::serverName());
+    if (!m_socket.waitForConnected(timeoutMs)) {
+        if (errorString) {
+            *errorString = QString("AutoKey is not running (%1)").arg(m_socket.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ControlClient::call(const ControlProtocol::Request &request, ControlProtocol::Response *response,
+                         QString *errorString, int timeoutMs) {
+    m_socket.write(ControlProtocol::frame(ControlProtocol::encodeRequest(request)));
+    if (!m_socket.waitForBytesWritten(timeoutMs)) {
+        if (errorString) {
+            *errorString = m_socket.errorString();
+        }
+        return false;
+    }
+
+    QByteArray body;
+    bool corrupt = false;
+    while (!ControlProtocol::takeFrame(&m_buffer, &body, &corrupt)) {
+        if (corrupt || !m_socket.waitForReadyRead(timeoutMs)) {
+            if (errorString) {
+                *errorString = corrupt ? QString("Malformed response") : m_socket.errorString();
+            }
+            return false;
+        }
+        m_buffer += m_socket.readAll();
+    }
+
+    ControlProtocol::Response decoded;
+    if (!ControlProtocol::decodeResponse(request.command, body, &decoded)) {
+        if (errorString) {
+            *errorString = "Malformed response";
+        }
+        return false;
+    }
+    if (response) {
+        *response = decoded;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <QLocalSocket>
+#include "controlprotocol.h"
+
+// Blocking client of the control channel, for autokeyctl and for a second
+// AutoKey instance handing over to the first
+class ControlClient {
+public:
+    bool connectToServer(int timeoutMs, QString *errorString);
+    // Sends a request and waits for its response. Returns false on a
+    // transport error; a refused command is reported in the response.
+    bool call(const ControlProtocol::Request &request, ControlProtocol::Response *response,
+              QString *errorString, int timeoutMs = 2000);
+
+private:
+    QLocalSocket m_socket;
+    QByteArray m_buffer;
+};
+
+#endif // CONTROLCLIENT_H
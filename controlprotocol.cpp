@@ -0,0 +1,89 @@
+#include "controlprotocol.h"
+#include <QDataStream>
+#include <QtEndian>
+
+QString ControlProtocol::serverName() {
+    QString user = qEnvironmentVariable("USERNAME");
+    if (user.isEmpty()) {
+        user = qEnvironmentVariable("USER");
+    }
+    return QString("AutoKeyControl-%1").arg(user);
+}
+
+QByteArray ControlProtocol::encodeRequest(const Request &request) {
+    QByteArray body;
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream << quint8(request.command) << request.profile << request.action << request.value;
+    return body;
+}
+
+bool ControlProtocol::decodeRequest(const QByteArray &body, Request *request) {
+    QDataStream stream(body);
+    quint8 command = 0;
+    stream >> command >> request->profile >> request->action >> request->value;
+    request->command = static_cast<Command>(command);
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+QByteArray ControlProtocol::encodeResponse(Command command, const Response &response) {
+    QByteArray body;
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream << quint8(response.status);
+    if (response.status != Ok) {
+        stream << response.message;
+        return body;
+    }
+
+    if (command == QueryStats) {
+        const Stats &stats = response.stats;
+        stream << stats.running << stats.paused << stats.targetActive << stats.profile
+               << stats.profileName << stats.presses << stats.throttled << stats.urgentPicks
+               << stats.plannedAhead;
+    } else if (command == ListProfiles) {
+        stream << response.profiles;
+    }
+    return body;
+}
+
+bool ControlProtocol::decodeResponse(Command command, const QByteArray &body, Response *response) {
+    QDataStream stream(body);
+    quint8 status = 0;
+    stream >> status;
+    response->status = static_cast<Status>(status);
+    if (response->status != Ok) {
+        stream >> response->message;
+    } else if (command == QueryStats) {
+        Stats &stats = response->stats;
+        stream >> stats.running >> stats.paused >> stats.targetActive >> stats.profile
+               >> stats.profileName >> stats.presses >> stats.throttled >> stats.urgentPicks
+               >> stats.plannedAhead;
+    } else if (command == ListProfiles) {
+        stream >> response->profiles;
+    }
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+QByteArray ControlProtocol::frame(const QByteArray &body) {
+    QByteArray result(sizeof(quint32), Qt::Uninitialized);
+    qToBigEndian<quint32>(static_cast<quint32>(body.size()), result.data());
+    result += body;
+    return result;
+}
+
+bool ControlProtocol::takeFrame(QByteArray *buffer, QByteArray *body, bool *corrupt) {
+    *corrupt = false;
+    if (buffer->size() < int(sizeof(quint32))) {
+        return false;
+    }
+    const quint32 size = qFromBigEndian<quint32>(buffer->constData());
+    if (size > quint32(MaxBodySize)) {
+        *corrupt = true;
+        return false;
+    }
+    if (buffer->size() < int(sizeof(quint32) + size)) {
+        return false;
+    }
+    *body = buffer->mid(sizeof(quint32), size);
+    buffer->remove(0, sizeof(quint32) + size);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef CONTROLPROTOCOL_H
+#define CONTROLPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// Binary protocol of the local control channel between a running AutoKey
+// and clients such as autokeyctl. Every message is a frame: a quint32 body
+// length followed by the body, big-endian as QDataStream writes it. A
+// request body is a command byte and three qint32 arguments; a response
+// body is a status byte followed by an error message or the command's
+// results.
+class ControlProtocol {
+public:
+    enum Command : quint8 {
+        Ping,
+        Activate,       // Brings the window to the front
+        Start,          // profile: index, -1 for the selected profile
+        Stop,
+        SwitchProfile,  // profile: index
+        SetWeight,      // profile, action: indices; value: weight 1-100
+        QueryStats,
+        ListProfiles,
+        CommandCount
+    };
+
+    enum Status : quint8 {
+        Ok,
+        UnknownCommand,
+        InvalidArgument,
+        Failed
+    };
+
+    struct Request {
+        Command command = Ping;
+        qint32 profile = -1;
+        qint32 action = -1;
+        qint32 value = 0;
+    };
+
+    struct Stats {
+        bool running = false;
+        bool paused = false;
+        bool targetActive = true;
+        qint32 profile = -1;  // Running profile, -1 if stopped
+        QString profileName;
+        quint64 presses = 0;
+        quint64 throttled = 0;
+        quint64 urgentPicks = 0;
+        qint32 plannedAhead = 0;
+    };
+
+    struct Response {
+        Status status = Ok;
+        QString message;         // Set unless status is Ok
+        Stats stats;             // QueryStats
+        QStringList profiles;    // ListProfiles
+    };
+
+    // Per user, so instances of different users do not see each other
+    static QString serverName();
+
+    static QByteArray encodeRequest(const Request &request);
+    static bool decodeRequest(const QByteArray &body, Request *request);
+    // Results are encoded according to the command they answer
+    static QByteArray encodeResponse(Command command, const Response &response);
+    static bool decodeResponse(Command command, const QByteArray &body, Response *response);
+
+    // Prefixes a body with its length, and takes the first complete frame
+    // off the front of a receive buffer. takeFrame() fails with 'corrupt'
+    // set for a length beyond MaxBodySize.
+    static QByteArray frame(const QByteArray &body);
+    static bool takeFrame(QByteArray *buffer, QByteArray *body, bool *corrupt);
+    static const int MaxBodySize = 16 * 1024 * 1024;
+};
+
+#endif // CONTROLPROTOCOL_H
@@ -0,0 +1,99 @@
+#include "controlserver.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLockFile>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDebug>
+
+ControlServer::ControlServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this)) {
+    // Other users on the machine must not drive this instance
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+}
+
+ControlServer::~ControlServer() {
+    m_server->close();
+}
+
+static QString instanceLockPath() {
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(configDir);
+    return configDir + "/autokey.lock";
+}
+
+bool ControlServer::claimInstance() {
+    // Windows lets several servers listen on one pipe name, so two launches
+    // at the same moment could both win the name. The lock file cannot be
+    // held twice.
+    static QLockFile lock(instanceLockPath());
+    return lock.isLocked() || lock.tryLock(0);
+}
+
+bool ControlServer::listen(QString *errorString) {
+    const QString name = ControlProtocol::serverName();
+    if (!claimInstance()) {
+        if (errorString) {
+            *errorString = "Another AutoKey instance is running";
+        }
+        return false;
+    }
+
+    if (!m_server->listen(name)) {
+        // A Unix socket file survives a crash and blocks the name
+        QLocalServer::removeServer(name);
+        if (!m_server->listen(name)) {
+            if (errorString) {
+                *errorString = m_server->errorString();
+            }
+            return false;
+        }
+    }
+
+    qDebug() << "Control channel listening on" << m_server->fullServerName();
+    return true;
+}
+
+bool ControlServer::isListening() const {
+    return m_server->isListening();
+}
+
+void ControlServer::onNewConnection() {
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_buffers.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::onReadyRead(QLocalSocket *socket) {
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    QByteArray body;
+    bool corrupt = false;
+    while (ControlProtocol::takeFrame(&buffer, &body, &corrupt)) {
+        ControlProtocol::Request request;
+        ControlProtocol::Response response;
+        if (!ControlProtocol::decodeRequest(body, &request)
+            || request.command >= ControlProtocol::CommandCount) {
+            response.status = ControlProtocol::UnknownCommand;
+            response.message = "Unknown or malformed command";
+        } else if (m_handler) {
+            response = m_handler(request);
+        }
+        socket->write(ControlProtocol::frame(ControlProtocol::encodeResponse(request.command, response)));
+    }
+    // Answer right away instead of on the next event loop pass
+    socket->flush();
+
+    if (corrupt) {
+        qWarning() << "Control client sent an oversized frame; disconnecting";
+        socket->disconnectFromServer();
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <functional>
+#include "controlprotocol.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// Accepts control connections on ControlProtocol::serverName() and answers
+// each request through a handler running in the GUI thread. A lock file next
+// to the configuration is what keeps AutoKey to a single instance; the
+// server name only follows it.
+class ControlServer : public QObject {
+    Q_OBJECT
+
+public:
+    using Handler = std::function<ControlProtocol::Response(const ControlProtocol::Request &)>;
+
+    explicit ControlServer(QObject *parent = nullptr);
+    ~ControlServer();
+
+    void setHandler(const Handler &handler) { m_handler = handler; }
+
+    // Fails if another instance holds the instance lock. A server name that
+    // is taken while this process holds the lock is left over from a crash
+    // and is reclaimed.
+    bool listen(QString *errorString);
+    bool isListening() const;
+
+    // Takes the instance lock for the life of the process. Returns false if
+    // another instance holds it; a lock left by a crashed process is stale
+    // and is taken over. Calling it again after it succeeded is harmless.
+    static bool claimInstance();
+
+private:
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, QByteArray> m_buffers;
+    Handler m_handler;
+};
+
+#endif // CONTROLSERVER_H
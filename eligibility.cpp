@@ -0,0 +1,159 @@
+#include "eligibility.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUTOKEY_ELIGIBILITY_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts intrinsics of any instruction set; GCC and Clang need them
+// enabled per function so the rest of the build keeps its target
+#if defined(__GNUC__) || defined(__clang__)
+#define AUTOKEY_TARGET(isa) __attribute__((target(isa)))
+#else
+#define AUTOKEY_TARGET(isa)
+#endif
+
+namespace {
+
+void clearMask(int count, quint64 *mask) {
+    for (int w = 0; w < Eligibility::wordCount(count); ++w) {
+        mask[w] = 0;
+    }
+}
+
+// Also finishes the slots left over by the vector kernels
+void computeScalar(const qint64 *lastPressed, const qint64 *minInterval, int from, int count,
+                   qint64 now, quint64 *mask) {
+    for (int i = from; i < count; ++i) {
+        if (now - lastPressed[i] >= minInterval[i]) {
+            mask[i / 64] |= quint64(1) << (i % 64);
+        }
+    }
+}
+
+#ifdef AUTOKEY_ELIGIBILITY_X86
+
+// Eight slots per iteration, so a group of bits never straddles two words
+AUTOKEY_TARGET("sse2")
+int computeSse2(const qint64 *lastPressed, const qint64 *minInterval, int count, qint64 now,
+                quint64 *mask) {
+    const __m128i nowVector = _mm_set1_epi64x(now);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int cooling = 0;
+        for (int lane = 0; lane < 8; lane += 2) {
+            const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lastPressed + i + lane));
+            const __m128i interval = _mm_loadu_si128(reinterpret_cast<const __m128i *>(minInterval + i + lane));
+            const __m128i left = _mm_sub_epi64(_mm_sub_epi64(nowVector, last), interval);
+            cooling |= _mm_movemask_pd(_mm_castsi128_pd(left)) << lane;
+        }
+        mask[i / 64] |= quint64(~cooling & 0xFF) << (i % 64);
+    }
+    return i;
+}
+
+AUTOKEY_TARGET("avx2")
+int computeAvx2(const qint64 *lastPressed, const qint64 *minInterval, int count, qint64 now,
+                quint64 *mask) {
+    const __m256i nowVector = _mm256_set1_epi64x(now);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i last0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lastPressed + i));
+        const __m256i last1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lastPressed + i + 4));
+        const __m256i interval0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(minInterval + i));
+        const __m256i interval1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(minInterval + i + 4));
+        const __m256i left0 = _mm256_sub_epi64(_mm256_sub_epi64(nowVector, last0), interval0);
+        const __m256i left1 = _mm256_sub_epi64(_mm256_sub_epi64(nowVector, last1), interval1);
+        const int cooling = _mm256_movemask_pd(_mm256_castsi256_pd(left0))
+                          | _mm256_movemask_pd(_mm256_castsi256_pd(left1)) << 4;
+        mask[i / 64] |= quint64(~cooling & 0xFF) << (i % 64);
+    }
+    return i;
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The OS must also save the AVX registers on context switches
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // AUTOKEY_ELIGIBILITY_X86
+
+} // namespace
+
+bool Eligibility::isSupported(Kernel kernel) {
+    switch (kernel) {
+    case Scalar:
+        return true;
+#ifdef AUTOKEY_ELIGIBILITY_X86
+    case Sse2:
+        return true;
+    case Avx2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+#else
+    case Sse2:
+    case Avx2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+Eligibility::Kernel Eligibility::bestKernel() {
+    static const Kernel best = isSupported(Avx2) ? Avx2 : isSupported(Sse2) ? Sse2 : Scalar;
+    return best;
+}
+
+QString Eligibility::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Scalar:
+        return "scalar";
+    case Sse2:
+        return "SSE2";
+    case Avx2:
+        return "AVX2";
+    }
+    return QString();
+}
+
+void Eligibility::compute(const qint64 *lastPressed, const qint64 *minInterval, int count,
+                          qint64 now, quint64 *mask) {
+    compute(bestKernel(), lastPressed, minInterval, count, now, mask);
+}
+
+void Eligibility::compute(Kernel kernel, const qint64 *lastPressed, const qint64 *minInterval,
+                          int count, qint64 now, quint64 *mask) {
+    clearMask(count, mask);
+
+    int done = 0;
+#ifdef AUTOKEY_ELIGIBILITY_X86
+    if (kernel == Avx2) {
+        done = computeAvx2(lastPressed, minInterval, count, now, mask);
+    } else if (kernel == Sse2) {
+        done = computeSse2(lastPressed, minInterval, count, now, mask);
+    }
+#else
+    Q_UNUSED(kernel)
+#endif
+    computeScalar(lastPressed, minInterval, done, count, now, mask);
+}
@@ -0,0 +1,35 @@
+#ifndef ELIGIBILITY_H
+#define ELIGIBILITY_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Cooldown test of many slots at once. For each slot the test is
+// now - lastPressed >= minInterval, done as one subtraction whose sign bit
+// says whether the slot is still cooling down; the sign bits of a vector of
+// slots become bits of an eligibility mask. The widest kernel the CPU
+// supports is picked at run time, with a scalar fallback for other CPUs.
+class Eligibility {
+public:
+    enum Kernel {
+        Scalar,
+        Sse2,  // 2 slots per instruction
+        Avx2   // 4 slots per instruction
+    };
+
+    static Kernel bestKernel();
+    static bool isSupported(Kernel kernel);
+    static QString kernelName(Kernel kernel);
+
+    // Sets bit i of mask (bit i % 64 of word i / 64) for every eligible slot
+    // among count, clearing the others; mask holds wordCount(count) words.
+    // Timestamps and intervals are separate arrays, indexed like the slots.
+    static void compute(const qint64 *lastPressed, const qint64 *minInterval, int count,
+                        qint64 now, quint64 *mask);
+    static void compute(Kernel kernel, const qint64 *lastPressed, const qint64 *minInterval,
+                        int count, qint64 now, quint64 *mask);
+
+    static int wordCount(int count) { return (count + 63) / 64; }
+};
+
+#endif // ELIGIBILITY_H
@@ -0,0 +1,39 @@
+#ifndef ENGINEEVENT_H
+#define ENGINEEVENT_H
+
+#include <QtGlobal>
+#include "spscring.h"
+
+// Compact record of something the simulation engine did, published from
+// executeAction() for the GUI to visualize
+struct EngineEvent {
+    enum Type : quint8 {
+        Press,          // A key was sent
+        Skip,           // The plan is empty; the engine waits for a new one
+        Cooldown,       // Every action is on cooldown; value holds the sleep in ms
+        DeadlineMiss,   // The tick ran late; value holds the lateness in ms
+        Throttled       // The rate budget delays the next press; value holds the delay in ms
+    };
+
+    qint64 timestamp;  // Milliseconds since epoch
+    qint32 key;        // Virtual key code, 0 if none
+    qint32 value;      // Type specific; for presses the rate budget left in percent, -1 if unlimited
+    qint16 slot;       // Slot index in the active ExecutionPlan, -1 if none
+    Type type;
+};
+
+// Sized for several seconds of backlog at engine rates
+using EngineEventRing = SpscRing<EngineEvent, 4096>;
+
+// A key the engine sent, as recorded by the SessionLog
+struct SessionEvent {
+    qint64 timestamp;    // Milliseconds since epoch
+    qint32 lateness;     // How late the tick that sent it ran, in ms
+    quint16 key;         // Virtual key code
+    qint16 slot;         // Slot index in the active ExecutionPlan
+    quint16 queueDepth;  // Presses the look-ahead planner had queued, 0 without
+};
+
+using SessionEventRing = SpscRing<SessionEvent, 4096>;
+
+#endif // ENGINEEVENT_H
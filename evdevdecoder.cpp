@@ -0,0 +1,66 @@
+#include "evdevdecoder.h"
+#include "evdevkeymap.h"
+#include <QtEndian>
+
+namespace {
+
+// From input-event-codes.h
+const int EvKey = 0x01;
+const int BtnLeft = 0x110;
+const int BtnRight = 0x111;
+
+} // namespace
+
+void EvdevDecoder::feed(const char *data, int size, QVector<InputTraceEvent> *events) {
+    int offset = 0;
+
+    // Complete a record left over from the previous call
+    if (!m_pending.isEmpty()) {
+        const int needed = qMin(RecordSize - m_pending.size(), size);
+        m_pending.append(data, needed);
+        offset = needed;
+        if (m_pending.size() < RecordSize) {
+            return;
+        }
+        decodeRecord(reinterpret_cast<const uchar *>(m_pending.constData()), events);
+        m_pending.clear();
+    }
+
+    for (; offset + RecordSize <= size; offset += RecordSize) {
+        decodeRecord(reinterpret_cast<const uchar *>(data + offset), events);
+    }
+    if (offset < size) {
+        m_pending.append(data + offset, size - offset);
+    }
+}
+
+void EvdevDecoder::decodeRecord(const uchar *record, QVector<InputTraceEvent> *events) {
+    ++m_recordCount;
+
+    const int type = qFromLittleEndian<quint16>(record + 16);
+    const int code = qFromLittleEndian<quint16>(record + 18);
+    const qint32 value = qFromLittleEndian<qint32>(record + 20);
+    if (type != EvKey || (value != 0 && value != 1)) {
+        return;  // Not a key, or auto-repeat
+    }
+
+    InputTraceEvent event;
+    event.timestampUs = qFromLittleEndian<qint64>(record) * 1000000
+                      + qFromLittleEndian<qint64>(record + 8);
+    event.down = value == 1;
+    if (code == BtnLeft) {
+        event.type = InputType::MouseLeft;
+        event.key = 0;
+    } else if (code == BtnRight) {
+        event.type = InputType::MouseRight;
+        event.key = 0;
+    } else {
+        const int virtualKey = EvdevKeyMap::toVirtualKey(code);
+        if (virtualKey == 0) {
+            return;
+        }
+        event.type = InputType::Keyboard;
+        event.key = static_cast<quint8>(virtualKey);
+    }
+    events->append(event);
+}
@@ -0,0 +1,33 @@
+#ifndef EVDEVDECODER_H
+#define EVDEVDECODER_H
+
+#include <QByteArray>
+#include <QVector>
+#include "inputtrace.h"
+
+// Decodes the byte stream of a Linux input device (struct input_event
+// records as read from /dev/input/event*) into trace events. It needs no
+// Linux headers, so a raw dump taken with "cat /dev/input/eventN > dump"
+// can be converted and checked on any machine, and the live evdev capture
+// goes through exactly the same code.
+class EvdevDecoder {
+public:
+    // struct input_event on 64-bit systems: timeval (2 x 8 bytes),
+    // u16 type, u16 code, s32 value, little endian
+    static const int RecordSize = 24;
+
+    // Appends the key and button transitions of all complete records in
+    // data; a trailing partial record is kept for the next call.
+    // Auto-repeat and keys without a virtual key are skipped.
+    void feed(const char *data, int size, QVector<InputTraceEvent> *events);
+
+    qint64 recordCount() const { return m_recordCount; }
+
+private:
+    void decodeRecord(const uchar *record, QVector<InputTraceEvent> *events);
+
+    QByteArray m_pending;
+    qint64 m_recordCount = 0;
+};
+
+#endif // EVDEVDECODER_H
@@ -0,0 +1,155 @@
+#include "evdevhotkeybackend.h"
+
+#ifdef Q_OS_LINUX
+
+#include "evdevkeymap.h"
+#include <QDir>
+#include <QSocketNotifier>
+#include <QDebug>
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+namespace {
+
+bool hasBit(const unsigned long *bits, int bit) {
+    const int width = sizeof(unsigned long) * 8;
+    return (bits[bit / width] >> (bit % width)) & 1;
+}
+
+bool isKeyboard(int fd) {
+    unsigned long keys[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) {
+        return false;
+    }
+    return hasBit(keys, KEY_A) && hasBit(keys, KEY_SPACE) && hasBit(keys, KEY_F1);
+}
+
+qint64 monotonicUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<qint64>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+} // namespace
+
+EvdevHotkeyBackend::EvdevHotkeyBackend(HotkeyRegistry *registry)
+    : m_registry(registry)
+    , m_modifiers(0) {
+}
+
+EvdevHotkeyBackend::~EvdevHotkeyBackend() {
+    closeDevices();
+}
+
+bool EvdevHotkeyBackend::grab(const HotkeyChord &chord) {
+    Q_UNUSED(chord);  // The registry's table filters unbound chords
+    if (m_devices.isEmpty()) {
+        openDevices();
+    }
+    return !m_devices.isEmpty();
+}
+
+void EvdevHotkeyBackend::releaseAll() {
+    closeDevices();
+}
+
+void EvdevHotkeyBackend::openDevices() {
+    const QDir inputDir("/dev/input");
+    const QStringList names = inputDir.entryList({"event*"}, QDir::System);
+    for (const QString &name : names) {
+        const QByteArray path = inputDir.filePath(name).toLocal8Bit();
+        const int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        if (!isKeyboard(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        // Event timestamps on the same clock as monotonicUs()
+        int clock = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clock);
+
+        QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this, fd]() { readEvents(fd); });
+        m_devices.append({fd, notifier});
+    }
+
+    if (m_devices.isEmpty()) {
+        qDebug() << "No readable keyboard under /dev/input; hotkeys need access to the input devices";
+    }
+}
+
+void EvdevHotkeyBackend::closeDevices() {
+    // Notifiers are deleted later: this may run from a hotkey handler
+    // called by one of them
+    for (const Device &device : m_devices) {
+        device.notifier->deleteLater();
+        ::close(device.fd);
+    }
+    m_devices.clear();
+    m_modifiers = 0;
+}
+
+bool EvdevHotkeyBackend::isOpen(int fd) const {
+    for (const Device &device : m_devices) {
+        if (device.fd == fd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EvdevHotkeyBackend::readEvents(int fd) {
+    input_event events[64];
+    const ssize_t bytes = ::read(fd, events, sizeof(events));
+    if (bytes < 0) {
+        if (errno == ENODEV) {
+            // Unplugged
+            for (int i = 0; i < m_devices.size(); ++i) {
+                if (m_devices[i].fd == fd) {
+                    m_devices[i].notifier->deleteLater();
+                    ::close(fd);
+                    m_devices.remove(i);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    const int count = static_cast<int>(bytes / sizeof(input_event));
+    for (int i = 0; i < count; ++i) {
+        const input_event &event = events[i];
+        if (event.type != EV_KEY) {
+            continue;
+        }
+
+        const int modifier = EvdevKeyMap::modifierBit(event.code);
+        if (modifier != 0) {
+            // Value 2 is auto-repeat and leaves the state alone
+            if (event.value == 1) {
+                m_modifiers |= modifier;
+            } else if (event.value == 0) {
+                m_modifiers &= ~modifier;
+            }
+            continue;
+        }
+
+        const int virtualKey = event.value == 1 ? EvdevKeyMap::toVirtualKey(event.code) : 0;
+        if (virtualKey != 0) {
+            const qint64 eventUs = static_cast<qint64>(event.input_event_sec) * 1000000
+                                 + event.input_event_usec;
+            m_registry->dispatch(m_modifiers, virtualKey, monotonicUs() - eventUs);
+            if (!isOpen(fd)) {
+                return;  // The handler re-registered the hotkeys
+            }
+        }
+    }
+}
+
+#endif // Q_OS_LINUX
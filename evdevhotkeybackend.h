@@ -0,0 +1,45 @@
+#ifndef EVDEVHOTKEYBACKEND_H
+#define EVDEVHOTKEYBACKEND_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <QObject>
+#include <QVector>
+#include "hotkeyregistry.h"
+
+class QSocketNotifier;
+
+// Reads key events of every keyboard under /dev/input and reports grabbed
+// chords to the registry. The devices are only listened to, not grabbed
+// exclusively, so other applications still see the keys. Needs read access
+// to the event devices (usually membership of the "input" group).
+class EvdevHotkeyBackend : public QObject, public HotkeyBackend {
+public:
+    explicit EvdevHotkeyBackend(HotkeyRegistry *registry);
+    ~EvdevHotkeyBackend();
+
+    QString name() const override { return "evdev"; }
+    bool grab(const HotkeyChord &chord) override;
+    void releaseAll() override;
+
+private:
+    void readEvents(int fd);
+    void openDevices();
+    void closeDevices();
+    bool isOpen(int fd) const;
+
+    struct Device {
+        int fd;
+        QSocketNotifier *notifier;
+    };
+
+    HotkeyRegistry *m_registry;
+    QVector<Device> m_devices;
+    int m_modifiers;  // HotkeyModifier bits currently held, over all devices
+};
+
+#endif // Q_OS_LINUX
+
+#endif // EVDEVHOTKEYBACKEND_H
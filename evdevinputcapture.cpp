@@ -0,0 +1,105 @@
+#include "evdevinputcapture.h"
+
+#ifdef Q_OS_LINUX
+
+#include "tracerecorder.h"
+#include <QDir>
+#include <QSocketNotifier>
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+namespace {
+
+bool hasBit(const unsigned long *bits, int bit) {
+    const int width = sizeof(unsigned long) * 8;
+    return (bits[bit / width] >> (bit % width)) & 1;
+}
+
+bool isKeyboardOrMouse(int fd) {
+    unsigned long keys[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) {
+        return false;
+    }
+    return (hasBit(keys, KEY_A) && hasBit(keys, KEY_SPACE)) || hasBit(keys, BTN_LEFT);
+}
+
+} // namespace
+
+EvdevInputCapture::EvdevInputCapture()
+    : m_recorder(nullptr) {
+}
+
+EvdevInputCapture::~EvdevInputCapture() {
+    stop();
+}
+
+bool EvdevInputCapture::start(TraceRecorder *recorder, QString *errorString) {
+    stop();
+    m_recorder = recorder;
+
+    const QDir inputDir("/dev/input");
+    const QStringList names = inputDir.entryList({"event*"}, QDir::System);
+    for (const QString &name : names) {
+        const QByteArray path = inputDir.filePath(name).toLocal8Bit();
+        const int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        if (!isKeyboardOrMouse(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        // Timestamps on TraceRecorder::clockUs()
+        int clock = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clock);
+
+        Device device;
+        device.fd = fd;
+        device.notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        const int index = m_devices.size();
+        connect(device.notifier, &QSocketNotifier::activated, this, [this, index]() { readEvents(index); });
+        m_devices.append(device);
+    }
+
+    if (m_devices.isEmpty()) {
+        if (errorString) {
+            *errorString = "No readable keyboard or mouse under /dev/input";
+        }
+        m_recorder = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void EvdevInputCapture::stop() {
+    for (const Device &device : m_devices) {
+        delete device.notifier;
+        ::close(device.fd);
+    }
+    m_devices.clear();
+    m_recorder = nullptr;
+}
+
+void EvdevInputCapture::readEvents(int index) {
+    Device &device = m_devices[index];
+    char buffer[64 * EvdevDecoder::RecordSize];
+    const ssize_t bytes = ::read(device.fd, buffer, sizeof(buffer));
+    if (bytes <= 0) {
+        if (bytes < 0 && errno == ENODEV) {
+            device.notifier->setEnabled(false);  // Unplugged
+        }
+        return;
+    }
+
+    m_events.clear();
+    device.decoder.feed(buffer, static_cast<int>(bytes), &m_events);
+    for (const InputTraceEvent &event : m_events) {
+        m_recorder->record(event);
+    }
+}
+
+#endif // Q_OS_LINUX
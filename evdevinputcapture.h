@@ -0,0 +1,43 @@
+#ifndef EVDEVINPUTCAPTURE_H
+#define EVDEVINPUTCAPTURE_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <QObject>
+#include <QVector>
+#include "inputcapture.h"
+#include "evdevdecoder.h"
+
+class QSocketNotifier;
+
+// Captures keyboards and mice under /dev/input. The raw records go through
+// EvdevDecoder, the same decoder used to convert offline dumps. Needs read
+// access to the event devices.
+class EvdevInputCapture : public QObject, public InputCaptureSource {
+public:
+    EvdevInputCapture();
+    ~EvdevInputCapture();
+
+    QString name() const override { return "evdev"; }
+    bool start(TraceRecorder *recorder, QString *errorString) override;
+    void stop() override;
+
+private:
+    struct Device {
+        int fd;
+        QSocketNotifier *notifier;
+        EvdevDecoder decoder;  // Per device: records must not interleave
+    };
+
+    void readEvents(int index);
+
+    TraceRecorder *m_recorder;
+    QVector<Device> m_devices;
+    QVector<InputTraceEvent> m_events;
+};
+
+#endif // Q_OS_LINUX
+
+#endif // EVDEVINPUTCAPTURE_H
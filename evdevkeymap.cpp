@@ -0,0 +1,101 @@
+#include "evdevkeymap.h"
+#include "hotkeyregistry.h"
+#include <array>
+
+namespace {
+
+struct KeyPair {
+    int code;
+    int virtualKey;
+};
+
+const KeyPair KeyPairs[] = {
+    {1, 0x1B},                                    // KEY_ESC
+    {2, 0x31}, {3, 0x32}, {4, 0x33}, {5, 0x34},   // KEY_1 - KEY_4
+    {6, 0x35}, {7, 0x36}, {8, 0x37}, {9, 0x38},   // KEY_5 - KEY_8
+    {10, 0x39}, {11, 0x30},                       // KEY_9, KEY_0
+    {12, 0xBD}, {13, 0xBB},                       // KEY_MINUS, KEY_EQUAL
+    {14, 0x08}, {15, 0x09},                       // KEY_BACKSPACE, KEY_TAB
+    {16, 'Q'}, {17, 'W'}, {18, 'E'}, {19, 'R'}, {20, 'T'},
+    {21, 'Y'}, {22, 'U'}, {23, 'I'}, {24, 'O'}, {25, 'P'},
+    {26, 0xDB}, {27, 0xDD},                       // KEY_LEFTBRACE, KEY_RIGHTBRACE
+    {28, 0x0D},                                   // KEY_ENTER
+    {29, 0xA2},                                   // KEY_LEFTCTRL
+    {30, 'A'}, {31, 'S'}, {32, 'D'}, {33, 'F'}, {34, 'G'},
+    {35, 'H'}, {36, 'J'}, {37, 'K'}, {38, 'L'},
+    {39, 0xBA}, {40, 0xDE}, {41, 0xC0},           // KEY_SEMICOLON, KEY_APOSTROPHE, KEY_GRAVE
+    {42, 0xA0},                                   // KEY_LEFTSHIFT
+    {43, 0xDC},                                   // KEY_BACKSLASH
+    {44, 'Z'}, {45, 'X'}, {46, 'C'}, {47, 'V'}, {48, 'B'},
+    {49, 'N'}, {50, 'M'},
+    {51, 0xBC}, {52, 0xBE}, {53, 0xBF},           // KEY_COMMA, KEY_DOT, KEY_SLASH
+    {54, 0xA1},                                   // KEY_RIGHTSHIFT
+    {55, 0x6A},                                   // KEY_KPASTERISK
+    {56, 0xA4},                                   // KEY_LEFTALT
+    {57, 0x20},                                   // KEY_SPACE
+    {58, 0x14},                                   // KEY_CAPSLOCK
+    {59, 0x70}, {60, 0x71}, {61, 0x72}, {62, 0x73}, {63, 0x74},  // KEY_F1 - KEY_F5
+    {64, 0x75}, {65, 0x76}, {66, 0x77}, {67, 0x78}, {68, 0x79},  // KEY_F6 - KEY_F10
+    {69, 0x90}, {70, 0x91},                       // KEY_NUMLOCK, KEY_SCROLLLOCK
+    {71, 0x67}, {72, 0x68}, {73, 0x69},           // KEY_KP7 - KEY_KP9
+    {74, 0x6D},                                   // KEY_KPMINUS
+    {75, 0x64}, {76, 0x65}, {77, 0x66},           // KEY_KP4 - KEY_KP6
+    {78, 0x6B},                                   // KEY_KPPLUS
+    {79, 0x61}, {80, 0x62}, {81, 0x63},           // KEY_KP1 - KEY_KP3
+    {82, 0x60}, {83, 0x6E},                       // KEY_KP0, KEY_KPDOT
+    {87, 0x7A}, {88, 0x7B},                       // KEY_F11, KEY_F12
+    {97, 0xA3},                                   // KEY_RIGHTCTRL
+    {98, 0x6F},                                   // KEY_KPSLASH
+    {99, 0x2C},                                   // KEY_SYSRQ
+    {100, 0xA5},                                  // KEY_RIGHTALT
+    {102, 0x24}, {103, 0x26}, {104, 0x21},        // KEY_HOME, KEY_UP, KEY_PAGEUP
+    {105, 0x25}, {106, 0x27},                     // KEY_LEFT, KEY_RIGHT
+    {107, 0x23}, {108, 0x28}, {109, 0x22},        // KEY_END, KEY_DOWN, KEY_PAGEDOWN
+    {110, 0x2D}, {111, 0x2E},                     // KEY_INSERT, KEY_DELETE
+    {119, 0x13},                                  // KEY_PAUSE
+    {125, 0x5B}, {126, 0x5C},                     // KEY_LEFTMETA, KEY_RIGHTMETA
+    {183, 0x7C}, {184, 0x7D}, {185, 0x7E}, {186, 0x7F},  // KEY_F13 - KEY_F16
+    {187, 0x80}, {188, 0x81}, {189, 0x82}, {190, 0x83},  // KEY_F17 - KEY_F20
+    {191, 0x84}, {192, 0x85}, {193, 0x86}, {194, 0x87},  // KEY_F21 - KEY_F24
+};
+
+struct Tables {
+    std::array<quint8, EvdevKeyMap::MaxCode + 1> toVirtual;
+    std::array<quint8, 256> fromVirtual;
+
+    Tables() {
+        toVirtual.fill(0);
+        fromVirtual.fill(0);
+        for (const KeyPair &pair : KeyPairs) {
+            toVirtual[pair.code] = static_cast<quint8>(pair.virtualKey);
+            if (fromVirtual[pair.virtualKey] == 0) {
+                fromVirtual[pair.virtualKey] = static_cast<quint8>(pair.code);
+            }
+        }
+    }
+};
+
+const Tables &tables() {
+    static const Tables instance;
+    return instance;
+}
+
+} // namespace
+
+int EvdevKeyMap::toVirtualKey(int code) {
+    return code > 0 && code <= MaxCode ? tables().toVirtual[code] : 0;
+}
+
+int EvdevKeyMap::fromVirtualKey(int virtualKey) {
+    return virtualKey > 0 && virtualKey <= 0xFF ? tables().fromVirtual[virtualKey] : 0;
+}
+
+int EvdevKeyMap::modifierBit(int code) {
+    switch (code) {
+    case 29: case 97: return HotkeyCtrl;    // KEY_LEFTCTRL, KEY_RIGHTCTRL
+    case 42: case 54: return HotkeyShift;   // KEY_LEFTSHIFT, KEY_RIGHTSHIFT
+    case 56: case 100: return HotkeyAlt;    // KEY_LEFTALT, KEY_RIGHTALT
+    case 125: case 126: return HotkeyWin;   // KEY_LEFTMETA, KEY_RIGHTMETA
+    default: return 0;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef EVDEVKEYMAP_H
+#define EVDEVKEYMAP_H
+
+// Translation between Linux evdev key codes (KEY_* in input-event-codes.h)
+// and the Windows virtual key codes used throughout AutoKey. Plain tables
+// without Linux headers, so recorded evdev data can be read on any platform.
+class EvdevKeyMap {
+public:
+    // Virtual key of an evdev code, 0 if it has none
+    static int toVirtualKey(int code);
+    // Evdev code of a virtual key, 0 if it has none
+    static int fromVirtualKey(int virtualKey);
+    // HotkeyModifier bit of a modifier key, 0 for other keys
+    static int modifierBit(int code);
+
+    // Highest evdev code in the table
+    static const int MaxCode = 0xFF;
+};
+
+#endif // EVDEVKEYMAP_H
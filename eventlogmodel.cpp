@@ -0,0 +1,147 @@
+#include "eventlogmodel.h"
+#include <QDateTime>
+#include <QColor>
+
+EventLogModel::EventLogModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_source(nullptr)
+    , m_view(nullptr)
+    , m_frameTimer(new QTimer(this))
+    , m_events(Capacity)
+    , m_first(0)
+    , m_count(0) {
+    m_pending.reserve(EngineEventRing::capacity());
+
+    m_frameTimer->setInterval(HiddenDrainInterval);
+    connect(m_frameTimer, &QTimer::timeout, this, &EventLogModel::flush);
+}
+
+void EventLogModel::setSource(EngineEventRing *ring) {
+    m_source = ring;
+}
+
+void EventLogModel::setView(QWidget *view) {
+    m_view = view;
+    m_view->installEventFilter(this);
+}
+
+bool EventLogModel::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == m_view && (event->type() == QEvent::Show || event->type() == QEvent::Hide)) {
+        m_frameTimer->setInterval(m_view->isVisible() ? FrameInterval : HiddenDrainInterval);
+        if (m_view->isVisible()) {
+            flush();
+        }
+    }
+    return QAbstractListModel::eventFilter(watched, event);
+}
+
+void EventLogModel::setActive(bool active) {
+    if (active) {
+        m_frameTimer->start();
+    } else {
+        // Pick up the events of the last tick, then stop scheduling frames
+        flush();
+        m_frameTimer->stop();
+    }
+}
+
+void EventLogModel::clear() {
+    beginResetModel();
+    m_first = 0;
+    m_count = 0;
+    endResetModel();
+}
+
+quint64 EventLogModel::droppedEvents() const {
+    return m_source ? m_source->dropped() : 0;
+}
+
+void EventLogModel::flush() {
+    if (!m_source) {
+        return;
+    }
+
+    m_pending.clear();
+    m_source->drain([this](const EngineEvent &event) {
+        m_pending.push_back(event);
+    });
+
+    int incoming = static_cast<int>(m_pending.size());
+    if (incoming == 0) {
+        return;
+    }
+
+    int skipped = 0;
+    if (incoming > Capacity) {
+        skipped = incoming - Capacity;
+        incoming = Capacity;
+    }
+
+    // Make room by dropping the oldest rows in one go
+    const int overflow = m_count + incoming - Capacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_first = (m_first + overflow) % Capacity;
+        m_count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+    for (int i = 0; i < incoming; ++i) {
+        m_events[(m_first + m_count + i) % Capacity] = m_pending[skipped + i];
+    }
+    m_count += incoming;
+    endInsertRows();
+}
+
+const EngineEvent &EventLogModel::eventAt(int row) const {
+    return m_events[(m_first + row) % Capacity];
+}
+
+int EventLogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant EventLogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+
+    const EngineEvent &event = eventAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString("%1  %2")
+            .arg(QDateTime::fromMSecsSinceEpoch(event.timestamp).toString("HH:mm:ss.zzz"))
+            .arg(describe(event));
+    case Qt::ForegroundRole:
+        if (event.type == EngineEvent::DeadlineMiss) {
+            return QColor(Qt::red);
+        }
+        if (event.type != EngineEvent::Press) {
+            return QColor(Qt::darkGray);
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QString EventLogModel::describe(const EngineEvent &event) {
+    const QString key = QString("Key %1").arg(QChar(event.key));
+    switch (event.type) {
+    case EngineEvent::Press:
+        if (event.value >= 0) {
+            return QString("Press     %1  (budget %2%)").arg(key).arg(event.value);
+        }
+        return QString("Press     %1").arg(key);
+    case EngineEvent::Skip:
+        return "Skip      no action to press";
+    case EngineEvent::Cooldown:
+        return QString("Cooldown  all actions cooling down, sleeping %1 ms").arg(event.value);
+    case EngineEvent::DeadlineMiss:
+        return QString("Late      tick ran %1 ms behind schedule").arg(event.value);
+    case EngineEvent::Throttled:
+        return QString("Throttle  rate budget delays the next press by %1 ms").arg(event.value);
+    }
+    return QString();
+}
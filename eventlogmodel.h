@@ -0,0 +1,63 @@
+#ifndef EVENTLOGMODEL_H
+#define EVENTLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QWidget>
+#include <vector>
+#include "engineevent.h"
+
+// Bounded log of engine events for a list view. Events are drained from the
+// engine's ring buffer on a frame timer and applied as one insert (and, once
+// the log is full, one remove) per frame. Rows are formatted on demand, so
+// only the rows a view actually shows cost any text.
+class EventLogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit EventLogModel(QObject *parent = nullptr);
+
+    void setSource(EngineEventRing *ring);
+    // Batches are applied per frame while the view is visible and only
+    // occasionally while it is hidden
+    void setView(QWidget *view);
+
+    // Frames are only scheduled while the engine is running
+    void setActive(bool active);
+    void clear();
+
+    // Events lost because the log fell behind the engine
+    quint64 droppedEvents() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    static QString describe(const EngineEvent &event);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void flush();
+
+private:
+    const EngineEvent &eventAt(int row) const;
+
+    static const int Capacity = 10000;
+    static const int FrameInterval = 100;
+    static const int HiddenDrainInterval = 10000;
+
+    EngineEventRing *m_source;
+    QWidget *m_view;
+    QTimer *m_frameTimer;
+
+    // Circular storage; row 0 is the oldest event at m_first
+    std::vector<EngineEvent> m_events;
+    int m_first;
+    int m_count;
+
+    // Events drained in the current frame
+    std::vector<EngineEvent> m_pending;
+};
+
+#endif // EVENTLOGMODEL_H
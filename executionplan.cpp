@@ -0,0 +1,187 @@
+#include "executionplan.h"
+#include "eligibility.h"
+#include <QHash>
+#include <QtAlgorithms>
+#include <array>
+
+std::shared_ptr<const ExecutionPlan> ExecutionPlan::compile(const ClassProfile &profile) {
+    auto plan = std::make_shared<ExecutionPlan>();
+    plan->m_profileName = profile.getName();
+    plan->m_rateLimit = profile.getRateLimit();
+    plan->m_rateBurst = profile.getRateBurst();
+
+    const ActionList &actions = profile.actions();
+    plan->m_slots.reserve(actions.size());
+
+    for (const auto &action : actions) {
+        if (!action.enabled || action.type != InputType::Keyboard || action.key <= 0) {
+            continue;
+        }
+
+        Slot slot;
+        slot.key = action.key;
+        slot.weight = action.weight;
+        // Use squared weight to make differences more dramatic
+        // Weight 95 -> 90 entries, weight 40 -> 16, weight 20 -> 4
+        slot.entries = qMax(1, action.weight * action.weight / 100);
+        slot.minInterval = action.minInterval;
+        slot.maxInterval = action.maxInterval;
+        slot.nextSameKey = plan->m_slots.size();
+        plan->m_slots.append(slot);
+        plan->m_minIntervals.append(slot.minInterval);
+    }
+
+    // Link slots that share a key so they also share a cooldown
+    QHash<int, int> lastSlotForKey;
+    for (int i = 0; i < plan->m_slots.size(); ++i) {
+        auto it = lastSlotForKey.find(plan->m_slots[i].key);
+        if (it != lastSlotForKey.end()) {
+            Slot &previous = plan->m_slots[it.value()];
+            plan->m_slots[i].nextSameKey = previous.nextSameKey;
+            previous.nextSameKey = i;
+        }
+        lastSlotForKey[plan->m_slots[i].key] = i;
+    }
+
+    return plan;
+}
+
+int ExecutionPlan::indexOfKey(int key) const {
+    for (int i = 0; i < m_slots.size(); ++i) {
+        if (m_slots[i].key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ExecutionPlan::pick(const qint64 *lastPressed, qint64 now, QRandomGenerator *rng) const {
+    // Equivalent to drawing from a pool with 'entries' copies of each
+    // available key, without materializing the pool. Availability comes as
+    // a bitmask, a chunk of slots at a time so the mask fits on the stack.
+    quint64 mask[MaskChunk / 64];
+    int totalEntries = 0;
+    for (int base = 0; base < size(); base += MaskChunk) {
+        const int count = qMin(MaskChunk, size() - base);
+        Eligibility::compute(lastPressed + base, m_minIntervals.constData() + base, count, now, mask);
+        for (int w = 0; w < Eligibility::wordCount(count); ++w) {
+            for (quint64 bits = mask[w]; bits; bits &= bits - 1) {
+                totalEntries += m_slots[base + w * 64 + qCountTrailingZeroBits(bits)].entries;
+            }
+        }
+    }
+
+    if (totalEntries == 0) {
+        return -1;
+    }
+
+    int remaining = static_cast<int>(rng->bounded(totalEntries));
+    for (int base = 0; base < size(); base += MaskChunk) {
+        const int count = qMin(MaskChunk, size() - base);
+        Eligibility::compute(lastPressed + base, m_minIntervals.constData() + base, count, now, mask);
+        for (int w = 0; w < Eligibility::wordCount(count); ++w) {
+            for (quint64 bits = mask[w]; bits; bits &= bits - 1) {
+                const int i = base + w * 64 + qCountTrailingZeroBits(bits);
+                remaining -= m_slots[i].entries;
+                if (remaining < 0) {
+                    return i;
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+int ExecutionPlan::pickUrgent(const qint64 *lastPressed, qint64 now) const {
+    quint64 mask[MaskChunk / 64];
+    int best = -1;
+    double bestScore = -1.0;
+    for (int base = 0; base < size(); base += MaskChunk) {
+        const int count = qMin(MaskChunk, size() - base);
+        Eligibility::compute(lastPressed + base, m_minIntervals.constData() + base, count, now, mask);
+        for (int w = 0; w < Eligibility::wordCount(count); ++w) {
+            for (quint64 bits = mask[w]; bits; bits &= bits - 1) {
+                const int i = base + w * 64 + qCountTrailingZeroBits(bits);
+                const qint64 waited = now - lastPressed[i];
+                const double urgency = qMin(MaxUrgency, double(waited) / qMax(1, m_slots[i].maxInterval));
+                const double score = m_slots[i].weight * urgency;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = i;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+qint64 ExecutionPlan::nextReadyTime(const qint64 *lastPressed) const {
+    qint64 earliest = NeverReady;
+    for (int i = 0; i < m_slots.size(); ++i) {
+        earliest = qMin(earliest, lastPressed[i] + m_slots[i].minInterval);
+    }
+    return earliest;
+}
+
+void ExecutionPlan::markPressed(qint64 *lastPressed, int index, qint64 now) const {
+    int i = index;
+    do {
+        lastPressed[i] = now;
+        i = m_slots[i].nextSameKey;
+    } while (i != index);
+}
+
+ExecutionPlan::Step ExecutionPlan::step(qint64 *lastPressed, TokenBucket &budget, qint64 now,
+                                        QRandomGenerator *rng, int spacing) const {
+    Step result{-1, false, NeverReady, 0};
+
+    // Without a token nothing may be sent, even if keys are ready. With the
+    // last token the press goes to the most urgent key rather than a random
+    // one, so a tight budget is spent where it matters.
+    budget.refill(now);
+    if (budget.tokens() >= 1.0 || !budget.isLimited()) {
+        const bool scarce = budget.isLimited() && budget.tokens() < 2.0;
+        result.slot = scarce ? pickUrgent(lastPressed, now) : pick(lastPressed, now, rng);
+        result.urgent = scarce && result.slot >= 0;
+    }
+    if (result.slot >= 0) {
+        budget.tryTake();
+        markPressed(lastPressed, result.slot, now);
+    }
+
+    // Decide again after the spacing, or once the first cooldown expires
+    // instead of polling while every key is cooling down
+    const qint64 readyTime = nextReadyTime(lastPressed);
+    if (readyTime == NeverReady) {
+        return result;
+    }
+    result.next = qMax(now + (result.slot >= 0 ? spacing : 0), readyTime);
+
+    // A key would be ready before the budget allows another press
+    const qint64 tokenTime = budget.nextTokenTime(now);
+    if (tokenTime > result.next) {
+        result.throttled = tokenTime - result.next;
+        result.next = tokenTime;
+    }
+    return result;
+}
+
+void ExecutionPlan::carryOverState(const ExecutionPlan &previous, const qint64 *previousState,
+                                   qint64 *state) const {
+    // Virtual keys fit a byte; a table on the stack keeps the swap off the heap
+    std::array<int, 256> previousIndex;
+    previousIndex.fill(-1);
+    for (int i = previous.size() - 1; i >= 0; --i) {
+        const int key = previous.m_slots[i].key;
+        if (key < int(previousIndex.size())) {
+            previousIndex[key] = i;
+        }
+    }
+
+    for (int i = 0; i < m_slots.size(); ++i) {
+        const int key = m_slots[i].key;
+        const int oldIndex = key < int(previousIndex.size()) ? previousIndex[key] : previous.indexOfKey(key);
+        state[i] = oldIndex >= 0 ? previousState[oldIndex] : NeverPressed;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef EXECUTIONPLAN_H
+#define EXECUTIONPLAN_H
+
+#include <QString>
+#include <QVector>
+#include <QRandomGenerator>
+#include <limits>
+#include <memory>
+#include "classprofile.h"
+#include "tokenbucket.h"
+
+// Immutable, pre-compiled form of a ClassProfile used by the simulation engine.
+// Only enabled keyboard actions with a key are kept, and the squared-weight
+// pool size of each action is computed once instead of on every tick.
+class ExecutionPlan {
+public:
+    struct Slot {
+        int key;           // Virtual key code
+        int weight;        // Weight (1-100)
+        int entries;       // Pool entries derived from the squared weight
+        int minInterval;   // Cooldown in milliseconds
+        int maxInterval;   // Maximum interval in milliseconds
+        int nextSameKey;   // Next slot sharing this key (cyclic, self if unique)
+    };
+
+    // Cooldown timestamp of a slot that has never been pressed
+    static constexpr qint64 NeverPressed = std::numeric_limits<qint64>::min() / 2;
+    // Result of nextReadyTime() for an empty plan
+    static constexpr qint64 NeverReady = std::numeric_limits<qint64>::max();
+
+    ExecutionPlan() = default;
+
+    static std::shared_ptr<const ExecutionPlan> compile(const ClassProfile &profile);
+
+    QString profileName() const { return m_profileName; }
+    // Rate budget of the profile, see ClassProfile::getRateLimit()
+    double rateLimit() const { return m_rateLimit; }
+    int rateBurst() const { return m_rateBurst; }
+    int size() const { return m_slots.size(); }
+    bool isEmpty() const { return m_slots.isEmpty(); }
+    const Slot &slot(int index) const { return m_slots[index]; }
+    int indexOfKey(int key) const;
+
+    // Picks the next slot to press given the per-slot cooldown timestamps.
+    // Returns -1 if the plan is empty or every slot is on cooldown.
+    int pick(const qint64 *lastPressed, qint64 now, QRandomGenerator *rng) const;
+
+    // Picks the ready slot with the highest weight times urgency, where
+    // urgency is the time since its last press relative to maxInterval.
+    // Used instead of pick() when the rate budget is down to its last token,
+    // so the presses that remain go to the keys that need them most.
+    int pickUrgent(const qint64 *lastPressed, qint64 now) const;
+
+    // Earliest time at which any slot comes off cooldown
+    qint64 nextReadyTime(const qint64 *lastPressed) const;
+
+    // Marks a slot (and every slot sharing its key) as pressed at the given time
+    void markPressed(qint64 *lastPressed, int index, qint64 now) const;
+
+    // Outcome of one engine decision
+    struct Step {
+        int slot;          // Slot pressed, -1 if none
+        bool urgent;       // Chosen by pickUrgent() because the budget was scarce
+        qint64 next;       // When to decide again, NeverReady if the plan is empty
+        qint64 throttled;  // How far the rate budget pushed 'next' back
+    };
+
+    // One decision at time now, as the engine makes it: presses a ready slot
+    // if the budget has a token, marks it and takes the token, then works out
+    // when the next decision is due. Presses are at least 'spacing' apart.
+    Step step(qint64 *lastPressed, TokenBucket &budget, qint64 now, QRandomGenerator *rng,
+              int spacing) const;
+
+    // Maps the cooldown state of a previous plan onto this plan by key
+    void carryOverState(const ExecutionPlan &previous, const qint64 *previousState,
+                        qint64 *state) const;
+
+private:
+    // Urgency stops growing once a key is this many maxIntervals overdue,
+    // so keys that were never pressed rank by weight among themselves
+    static constexpr double MaxUrgency = 10.0;
+    // Slots tested per eligibility mask
+    static const int MaskChunk = 1024;
+
+    QString m_profileName;
+    double m_rateLimit = 0.0;
+    int m_rateBurst = 1;
+    QVector<Slot> m_slots;
+    // Cooldowns again as a flat array next to the engine's timestamps, so
+    // eligibility is tested several slots per instruction
+    QVector<qint64> m_minIntervals;
+};
+
+using ExecutionPlanPtr = std::shared_ptr<const ExecutionPlan>;
+
+#endif // EXECUTIONPLAN_H
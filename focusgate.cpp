@@ -0,0 +1,81 @@
+#include "focusgate.h"
+#include <QDebug>
+
+FocusGate::FocusGate(QObject *parent)
+    : QObject(parent)
+    , m_watcher(ForegroundWatcher::create())
+    , m_watching(false)
+    , m_targetActive(true) {
+}
+
+FocusGate::~FocusGate() {
+    if (m_watching) {
+        m_watcher->stop();
+    }
+}
+
+void FocusGate::setWatcher(ForegroundWatcher *watcher) {
+    if (m_watching) {
+        m_watcher->stop();
+        m_watching = false;
+    }
+    m_watcher.reset(watcher);
+}
+
+QString FocusGate::watcherName() const {
+    return m_watcher ? m_watcher->name() : QString("none");
+}
+
+bool FocusGate::setTarget(const QString &target, QString *errorString) {
+    m_target = target.trimmed();
+
+    // Without a target nothing needs to be observed at all
+    if (m_target.isEmpty()) {
+        if (m_watching) {
+            m_watcher->stop();
+            m_watching = false;
+        }
+        setTargetActive(true);
+        return true;
+    }
+
+    if (!m_watcher) {
+        if (errorString) {
+            *errorString = "Focus changes cannot be observed on this system";
+        }
+        setTargetActive(true);
+        return false;
+    }
+    if (!m_watching) {
+        // start() reports the current window, which is matched right away
+        m_watching = m_watcher->start(this, errorString);
+        if (!m_watching) {
+            setTargetActive(true);
+            return false;
+        }
+        qDebug() << "Watching the foreground window with" << m_watcher->name();
+    }
+
+    setTargetActive(matches(m_foreground, m_target));
+    return true;
+}
+
+bool FocusGate::matches(const ForegroundWindow &window, const QString &target) {
+    return window.processName.compare(target, Qt::CaseInsensitive) == 0
+        || window.title.contains(target, Qt::CaseInsensitive);
+}
+
+void FocusGate::foregroundChanged(const ForegroundWindow &window) {
+    m_foreground = window;
+    if (!m_target.isEmpty()) {
+        setTargetActive(matches(window, m_target));
+    }
+}
+
+void FocusGate::setTargetActive(bool active) {
+    if (active == m_targetActive) {
+        return;
+    }
+    m_targetActive = active;
+    emit targetActiveChanged(active);
+}
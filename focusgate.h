@@ -0,0 +1,54 @@
+#ifndef FOCUSGATE_H
+#define FOCUSGATE_H
+
+#include <QObject>
+#include <QString>
+#include <memory>
+#include "foregroundwatcher.h"
+
+// Tells whether the target window has the focus, so the engine only sends
+// keys to the game. A watcher reports focus changes as they happen and the
+// gate emits targetActiveChanged() only when the answer changes; the engine
+// is paused and resumed from that signal instead of checking the foreground
+// window on every tick.
+class FocusGate : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FocusGate(QObject *parent = nullptr);
+    ~FocusGate();
+
+    // A window matches if its title contains target or its executable is
+    // target, ignoring case. An empty target turns the gate off. Returns
+    // false if focus changes cannot be observed; the gate then stays open.
+    bool setTarget(const QString &target, QString *errorString);
+    QString target() const { return m_target; }
+
+    // Replaces the platform watcher, e.g. with a FakeForegroundWatcher.
+    // Takes ownership; must be called before setTarget().
+    void setWatcher(ForegroundWatcher *watcher);
+    QString watcherName() const;
+    bool isWatching() const { return m_watching; }
+
+    bool isTargetActive() const { return m_targetActive; }
+    ForegroundWindow foreground() const { return m_foreground; }
+
+    static bool matches(const ForegroundWindow &window, const QString &target);
+
+    // Called by watchers
+    void foregroundChanged(const ForegroundWindow &window);
+
+signals:
+    void targetActiveChanged(bool active);
+
+private:
+    void setTargetActive(bool active);
+
+    std::unique_ptr<ForegroundWatcher> m_watcher;
+    bool m_watching;
+    QString m_target;
+    ForegroundWindow m_foreground;
+    bool m_targetActive;
+};
+
+#endif // FOCUSGATE_H
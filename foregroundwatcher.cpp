@@ -0,0 +1,39 @@
+#include "foregroundwatcher.h"
+#include "focusgate.h"
+
+#if defined(Q_OS_WIN)
+#include "win32foregroundwatcher.h"
+#elif defined(AUTOKEY_HAVE_X11)
+#include "x11foregroundwatcher.h"
+#endif
+
+ForegroundWatcher *ForegroundWatcher::create() {
+#if defined(Q_OS_WIN)
+    return new Win32ForegroundWatcher();
+#elif defined(AUTOKEY_HAVE_X11)
+    return new X11ForegroundWatcher();
+#else
+    return nullptr;
+#endif
+}
+
+FakeForegroundWatcher::FakeForegroundWatcher()
+    : m_gate(nullptr) {
+}
+
+bool FakeForegroundWatcher::start(FocusGate *gate, QString *) {
+    m_gate = gate;
+    m_gate->foregroundChanged(m_current);
+    return true;
+}
+
+void FakeForegroundWatcher::stop() {
+    m_gate = nullptr;
+}
+
+void FakeForegroundWatcher::activate(const ForegroundWindow &window) {
+    m_current = window;
+    if (m_gate) {
+        m_gate->foregroundChanged(window);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef FOREGROUNDWATCHER_H
+#define FOREGROUNDWATCHER_H
+
+#include <QString>
+
+class FocusGate;
+
+// The window that receives keyboard input
+struct ForegroundWindow {
+    quintptr id = 0;       // Native handle, 0 if unknown
+    QString title;
+    QString processName;   // Executable file name, or the X11 class name
+};
+
+// Platform side of the focus gate: reports every change of the foreground
+// window to FocusGate::foregroundChanged(). Watchers are driven by the
+// platform's own notifications, so nothing runs while the focus stays put.
+class ForegroundWatcher {
+public:
+    virtual ~ForegroundWatcher() = default;
+
+    virtual QString name() const = 0;
+    // Reports the current foreground window before returning
+    virtual bool start(FocusGate *gate, QString *errorString) = 0;
+    virtual void stop() = 0;
+
+    // Watcher for this platform, nullptr if focus changes cannot be observed
+    static ForegroundWatcher *create();
+};
+
+// Watcher driven by hand, for benchmarks and scripted checks of the gate
+class FakeForegroundWatcher : public ForegroundWatcher {
+public:
+    FakeForegroundWatcher();
+
+    QString name() const override { return "fake"; }
+    bool start(FocusGate *gate, QString *errorString) override;
+    void stop() override;
+
+    // Makes window the foreground window; reported if the watcher runs
+    void activate(const ForegroundWindow &window);
+
+private:
+    FocusGate *m_gate;
+    ForegroundWindow m_current;
+};
+
+#endif // FOREGROUNDWATCHER_H
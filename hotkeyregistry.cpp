@@ -0,0 +1,257 @@
+#include "hotkeyregistry.h"
+#include <QElapsedTimer>
+#include <QDebug>
+
+#if defined(Q_OS_WIN)
+#include "win32hotkeybackend.h"
+#elif defined(Q_OS_LINUX)
+#include "evdevhotkeybackend.h"
+#endif
+
+namespace {
+
+struct KeyName {
+    const char *name;
+    quint8 key;
+};
+
+// Named keys besides 0-9, A-Z and F1-F24. The first name of a key is the
+// one used when formatting.
+const KeyName NamedKeys[] = {
+    {"Backspace", 0x08},
+    {"Tab", 0x09},
+    {"Enter", 0x0D}, {"Return", 0x0D},
+    {"Pause", 0x13},
+    {"CapsLock", 0x14},
+    {"Escape", 0x1B}, {"Esc", 0x1B},
+    {"Space", 0x20},
+    {"PageUp", 0x21}, {"PgUp", 0x21},
+    {"PageDown", 0x22}, {"PgDown", 0x22},
+    {"End", 0x23},
+    {"Home", 0x24},
+    {"Left", 0x25},
+    {"Up", 0x26},
+    {"Right", 0x27},
+    {"Down", 0x28},
+    {"PrintScreen", 0x2C},
+    {"Insert", 0x2D}, {"Ins", 0x2D},
+    {"Delete", 0x2E}, {"Del", 0x2E},
+    {"NumpadMultiply", 0x6A},
+    {"NumpadAdd", 0x6B},
+    {"NumpadSubtract", 0x6D},
+    {"NumpadDecimal", 0x6E},
+    {"NumpadDivide", 0x6F},
+    {"ScrollLock", 0x91},
+};
+
+struct ModifierName {
+    const char *name;
+    quint8 modifier;
+};
+
+const ModifierName ModifierNames[] = {
+    {"Ctrl", HotkeyCtrl}, {"Control", HotkeyCtrl},
+    {"Alt", HotkeyAlt},
+    {"Shift", HotkeyShift},
+    {"Win", HotkeyWin}, {"Meta", HotkeyWin}, {"Super", HotkeyWin},
+};
+
+int parseKey(const QString &name) {
+    if (name.size() == 1) {
+        const QChar c = name.at(0).toUpper();
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')) {
+            return c.unicode();
+        }
+    }
+
+    bool ok = false;
+    if (name.startsWith('F', Qt::CaseInsensitive)) {
+        const int number = name.mid(1).toInt(&ok);
+        if (ok && number >= 1 && number <= 24) {
+            return 0x70 + number - 1;
+        }
+    }
+    if (name.startsWith("Numpad", Qt::CaseInsensitive) && name.size() == 7) {
+        const int digit = name.mid(6).toInt(&ok);
+        if (ok) {
+            return 0x60 + digit;
+        }
+    }
+
+    for (const KeyName &named : NamedKeys) {
+        if (name.compare(QLatin1String(named.name), Qt::CaseInsensitive) == 0) {
+            return named.key;
+        }
+    }
+    return 0;
+}
+
+QString keyName(int key) {
+    if ((key >= 0x30 && key <= 0x39) || (key >= 0x41 && key <= 0x5A)) {
+        return QString(QChar(key));
+    }
+    if (key >= 0x70 && key <= 0x87) {
+        return QString("F%1").arg(key - 0x70 + 1);
+    }
+    if (key >= 0x60 && key <= 0x69) {
+        return QString("Numpad%1").arg(key - 0x60);
+    }
+    for (const KeyName &named : NamedKeys) {
+        if (named.key == key) {
+            return QString::fromLatin1(named.name);
+        }
+    }
+    return QString("0x%1").arg(key, 2, 16, QChar('0'));
+}
+
+QString commandName(const HotkeyBinding &binding) {
+    switch (binding.command) {
+    case HotkeyCommand::Start: return "Start";
+    case HotkeyCommand::Stop: return "Stop";
+    case HotkeyCommand::Pause: return "Pause";
+    case HotkeyCommand::SwitchProfile: return QString("Profile %1").arg(binding.argument + 1);
+    }
+    return QString();
+}
+
+} // namespace
+
+HotkeyChord HotkeyChord::parse(const QString &text, QString *error) {
+    HotkeyChord chord;
+    const QStringList parts = text.split('+');
+    for (int i = 0; i < parts.size(); ++i) {
+        const QString part = parts[i].trimmed();
+        const bool last = i == parts.size() - 1;
+
+        bool isModifier = false;
+        for (const ModifierName &modifier : ModifierNames) {
+            if (part.compare(QLatin1String(modifier.name), Qt::CaseInsensitive) == 0) {
+                chord.modifiers |= modifier.modifier;
+                isModifier = true;
+                break;
+            }
+        }
+        if (isModifier && !last) {
+            continue;
+        }
+
+        const int key = last ? parseKey(part) : 0;
+        if (key == 0) {
+            if (error) {
+                *error = part.isEmpty() ? QString("Missing key in \"%1\"").arg(text)
+                       : isModifier ? QString("\"%1\" has no key besides its modifiers").arg(text)
+                       : !last ? QString("Unknown modifier \"%1\"").arg(part)
+                       : QString("Unknown key \"%1\"").arg(part);
+            }
+            return HotkeyChord();
+        }
+        chord.key = static_cast<quint8>(key);
+    }
+    return chord;
+}
+
+QString HotkeyChord::toString() const {
+    if (!isValid()) {
+        return QString();
+    }
+
+    QString text;
+    if (modifiers & HotkeyCtrl) text += "Ctrl+";
+    if (modifiers & HotkeyAlt) text += "Alt+";
+    if (modifiers & HotkeyShift) text += "Shift+";
+    if (modifiers & HotkeyWin) text += "Win+";
+    return text + keyName(key);
+}
+
+HotkeyRegistry::HotkeyRegistry(QObject *parent)
+    : QObject(parent)
+    , m_latencyCount(0)
+    , m_latencySumUs(0)
+    , m_latencyMaxUs(0)
+    , m_lastLatencyUs(0) {
+    m_table.fill(-1);
+
+#if defined(Q_OS_WIN)
+    m_backend.reset(new Win32HotkeyBackend(this));
+#elif defined(Q_OS_LINUX)
+    m_backend.reset(new EvdevHotkeyBackend(this));
+#endif
+}
+
+HotkeyRegistry::~HotkeyRegistry() {
+    if (m_backend) {
+        m_backend->releaseAll();
+    }
+}
+
+QString HotkeyRegistry::backendName() const {
+    return m_backend ? m_backend->name() : QString("none");
+}
+
+QStringList HotkeyRegistry::setBindings(const QVector<HotkeyBinding> &bindings) {
+    if (m_backend) {
+        m_backend->releaseAll();
+    }
+    m_bindings.clear();
+    m_table.fill(-1);
+
+    QStringList failures;
+    for (const HotkeyBinding &binding : bindings) {
+        if (!binding.chord.isValid()) {
+            continue;
+        }
+
+        const int code = binding.chord.code();
+        if (m_table[code] >= 0) {
+            failures << QString("%1: %2 is already used for %3")
+                .arg(commandName(binding), binding.chord.toString(),
+                     commandName(m_bindings[m_table[code]]));
+            continue;
+        }
+        if (!m_backend || !m_backend->grab(binding.chord)) {
+            failures << QString("%1: %2 could not be registered")
+                .arg(commandName(binding), binding.chord.toString());
+            continue;
+        }
+
+        m_table[code] = static_cast<qint16>(m_bindings.size());
+        m_bindings.append(binding);
+    }
+
+    qDebug() << "Registered" << m_bindings.size() << "hotkeys with the" << backendName() << "backend";
+    return failures;
+}
+
+bool HotkeyRegistry::dispatch(int modifiers, int key, qint64 ageUs) {
+    if (key <= 0 || key > 0xFF) {
+        return false;
+    }
+    const int index = m_table[(modifiers & 0xF) << 8 | key];
+    if (index < 0) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Copy: a handler may replace the bindings
+    const HotkeyBinding binding = m_bindings[index];
+    emit commandTriggered(binding.command, binding.argument);
+
+    const qint64 latencyUs = qMax<qint64>(0, ageUs) + timer.nsecsElapsed() / 1000;
+    ++m_latencyCount;
+    m_latencySumUs += latencyUs;
+    m_latencyMaxUs = qMax(m_latencyMaxUs, latencyUs);
+    m_lastLatencyUs = latencyUs;
+    emit latencyMeasured(latencyUs);
+    return true;
+}
+
+HotkeyRegistry::LatencyStats HotkeyRegistry::latency() const {
+    LatencyStats stats;
+    stats.count = m_latencyCount;
+    stats.lastUs = m_lastLatencyUs;
+    stats.meanUs = m_latencyCount > 0 ? m_latencySumUs / m_latencyCount : 0;
+    stats.maxUs = m_latencyMaxUs;
+    return stats;
+}
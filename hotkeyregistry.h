@@ -0,0 +1,109 @@
+#ifndef HOTKEYREGISTRY_H
+#define HOTKEYREGISTRY_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QScopedPointer>
+#include <array>
+
+// Modifier bits of a chord, identical to the Win32 MOD_* flags so the
+// Win32 backend can pass them through unchanged
+enum HotkeyModifier {
+    HotkeyAlt = 0x1,
+    HotkeyCtrl = 0x2,
+    HotkeyShift = 0x4,
+    HotkeyWin = 0x8
+};
+
+// A key with modifiers, e.g. "Ctrl+Shift+F5". Keys are Windows virtual key
+// codes on every platform; other backends translate their native codes.
+struct HotkeyChord {
+    quint8 modifiers = 0;
+    quint8 key = 0;
+
+    bool isValid() const { return key != 0; }
+    // Index into the dispatch table
+    int code() const { return (modifiers & 0xF) << 8 | key; }
+
+    // Parses "Ctrl+Alt+P", "F5", "Numpad1" etc.; returns an invalid chord
+    // and sets error for unknown names
+    static HotkeyChord parse(const QString &text, QString *error = nullptr);
+    QString toString() const;
+};
+
+enum class HotkeyCommand : quint8 {
+    Start,
+    Stop,
+    Pause,          // Toggles pause of the running simulation
+    SwitchProfile   // Argument is the profile index
+};
+
+struct HotkeyBinding {
+    HotkeyChord chord;
+    HotkeyCommand command;
+    int argument;
+};
+
+class HotkeyRegistry;
+
+// Platform side of the registry: grabs chords system-wide and reports the
+// ones that were pressed through HotkeyRegistry::dispatch()
+class HotkeyBackend {
+public:
+    virtual ~HotkeyBackend() = default;
+    virtual QString name() const = 0;
+    virtual bool grab(const HotkeyChord &chord) = 0;
+    virtual void releaseAll() = 0;
+};
+
+// Binds any number of chords to commands. Bindings are compiled into a flat
+// table indexed by chord code, so a hotkey is dispatched with one lookup and
+// without any string handling. The time from the key event to the end of
+// the command handler is measured for every hotkey.
+class HotkeyRegistry : public QObject {
+    Q_OBJECT
+
+public:
+    explicit HotkeyRegistry(QObject *parent = nullptr);
+    ~HotkeyRegistry();
+
+    // Replaces all bindings. Returns one message per binding that could not
+    // be registered, e.g. because another application owns the chord.
+    QStringList setBindings(const QVector<HotkeyBinding> &bindings);
+    const QVector<HotkeyBinding> &bindings() const { return m_bindings; }
+    QString backendName() const;
+
+    // Called by backends. ageUs is how long the event took to reach the
+    // registry, as far as the backend can tell. Returns false for chords
+    // that are not bound.
+    bool dispatch(int modifiers, int key, qint64 ageUs);
+
+    struct LatencyStats {
+        qint64 count;
+        qint64 lastUs;
+        qint64 meanUs;
+        qint64 maxUs;
+    };
+    LatencyStats latency() const;
+
+signals:
+    // Emitted synchronously; handlers are part of the measured latency
+    void commandTriggered(HotkeyCommand command, int argument);
+    void latencyMeasured(qint64 latencyUs);
+
+private:
+    static const int TableSize = 16 * 256;
+
+    QScopedPointer<HotkeyBackend> m_backend;
+    QVector<HotkeyBinding> m_bindings;
+    std::array<qint16, TableSize> m_table;  // Binding per chord code, -1 if unbound
+
+    qint64 m_latencyCount;
+    qint64 m_latencySumUs;
+    qint64 m_latencyMaxUs;
+    qint64 m_lastLatencyUs;
+};
+
+#endif // HOTKEYREGISTRY_H
@@ -0,0 +1,17 @@
+#include "inputcapture.h"
+
+#if defined(Q_OS_WIN)
+#include "win32inputcapture.h"
+#elif defined(Q_OS_LINUX)
+#include "evdevinputcapture.h"
+#endif
+
+InputCaptureSource *InputCaptureSource::create() {
+#if defined(Q_OS_WIN)
+    return new Win32InputCapture();
+#elif defined(Q_OS_LINUX)
+    return new EvdevInputCapture();
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,23 @@
+#ifndef INPUTCAPTURE_H
+#define INPUTCAPTURE_H
+
+#include <QString>
+
+class TraceRecorder;
+
+// Captures the user's real key and mouse button transitions into a
+// recorder. Input generated by AutoKey itself is not captured where the
+// platform can tell it apart.
+class InputCaptureSource {
+public:
+    virtual ~InputCaptureSource() = default;
+
+    virtual QString name() const = 0;
+    virtual bool start(TraceRecorder *recorder, QString *errorString) = 0;
+    virtual void stop() = 0;
+
+    // Source for this platform, nullptr if input cannot be captured here
+    static InputCaptureSource *create();
+};
+
+#endif // INPUTCAPTURE_H
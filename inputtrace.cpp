@@ -0,0 +1,233 @@
+#include "inputtrace.h"
+#include <QIODevice>
+#include <cstring>
+
+const char InputTraceWriter::Magic[4] = {'A', 'K', 'T', 'R'};
+
+namespace {
+
+const int HeaderSize = 8;
+
+// The reader and the cursor decode through these, over the bytes they have
+// at hand. Incomplete leaves *position alone, so the reader can load more
+// and retry, and the cursor knows it reached the end.
+enum class Decoded { Ok, Incomplete, Corrupt };
+
+Decoded decodeVarint(const uchar *data, qint64 size, qint64 *position, quint64 *value) {
+    quint64 result = 0;
+    qint64 at = *position;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (at >= size) {
+            return Decoded::Incomplete;
+        }
+        const quint8 byte = data[at++];
+        result |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            *position = at;
+            return Decoded::Ok;
+        }
+    }
+    return Decoded::Corrupt;
+}
+
+// Sets errorString unless the header was decoded; at the end of the data
+// an incomplete header is an error too
+Decoded decodeHeader(const uchar *data, qint64 size, qint64 *position, qint64 *startTimeUs,
+                     QString *errorString) {
+    if (size < HeaderSize) {
+        *errorString = "Not an AutoKey input trace";
+        return Decoded::Incomplete;
+    }
+    if (memcmp(data, InputTraceWriter::Magic, 4) != 0) {
+        *errorString = "Not an AutoKey input trace";
+        return Decoded::Corrupt;
+    }
+    if (data[4] != InputTraceWriter::Version) {
+        *errorString = QString("Unsupported trace version %1").arg(data[4]);
+        return Decoded::Corrupt;
+    }
+
+    qint64 at = HeaderSize;
+    quint64 startTime = 0;
+    const Decoded result = decodeVarint(data, size, &at, &startTime);
+    if (result != Decoded::Ok) {
+        *errorString = "Truncated trace header";
+        return result;
+    }
+    *startTimeUs = static_cast<qint64>(startTime);
+    *position = at;
+    return Decoded::Ok;
+}
+
+// One event record; *timestamp accumulates the deltas. Sets errorString
+// only for a corrupt record: an incomplete one ends the trace.
+Decoded decodeEvent(const uchar *data, qint64 size, qint64 *position, qint64 *timestamp,
+                    qint64 index, InputTraceEvent *event, QString *errorString) {
+    qint64 at = *position;
+    quint64 delta = 0;
+    quint64 payload = 0;
+    Decoded result = decodeVarint(data, size, &at, &delta);
+    if (result == Decoded::Ok) {
+        result = decodeVarint(data, size, &at, &payload);
+    }
+    if (result == Decoded::Corrupt) {
+        *errorString = "Corrupt varint in trace";
+    }
+    if (result != Decoded::Ok) {
+        return result;
+    }
+
+    const int type = static_cast<int>(payload >> 1 & 0x3);
+    const quint64 key = payload >> 3;
+    if (type > static_cast<int>(InputType::MouseRight) || key > 0xFF) {
+        *errorString = QString("Corrupt event %1 in trace").arg(index);
+        return Decoded::Corrupt;
+    }
+
+    *timestamp += static_cast<qint64>(delta);
+    event->timestampUs = *timestamp;
+    event->type = static_cast<InputType>(type);
+    event->key = static_cast<quint8>(key);
+    event->down = payload & 1;
+    *position = at;
+    return Decoded::Ok;
+}
+
+} // namespace
+
+InputTraceWriter::InputTraceWriter(QIODevice *device)
+    : m_device(device)
+    , m_lastTimestamp(0)
+    , m_eventCount(0)
+    , m_bytesWritten(0) {
+    m_buffer.reserve(FlushThreshold + 32);
+}
+
+bool InputTraceWriter::begin(qint64 startTimeUs, qint64 originUs) {
+    m_buffer.append(Magic, sizeof(Magic));
+    m_buffer.append(static_cast<char>(Version));
+    m_buffer.append(3, '\0');
+    appendVarint(static_cast<quint64>(qMax<qint64>(0, startTimeUs)));
+    m_lastTimestamp = originUs;
+    return flush();
+}
+
+bool InputTraceWriter::append(const InputTraceEvent &event) {
+    // Events of several devices may arrive slightly out of order
+    const qint64 delta = qMax<qint64>(0, event.timestampUs - m_lastTimestamp);
+    m_lastTimestamp = qMax(m_lastTimestamp, event.timestampUs);
+
+    appendVarint(static_cast<quint64>(delta));
+    appendVarint(static_cast<quint64>(event.key) << 3
+                 | (static_cast<quint64>(event.type) & 0x3) << 1
+                 | (event.down ? 1 : 0));
+    ++m_eventCount;
+
+    return m_buffer.size() < FlushThreshold || flush();
+}
+
+bool InputTraceWriter::flush() {
+    if (m_buffer.isEmpty()) {
+        return true;
+    }
+
+    const qint64 written = m_device->write(m_buffer);
+    if (written != m_buffer.size()) {
+        return false;
+    }
+    m_bytesWritten += written;
+    m_buffer.clear();
+    return true;
+}
+
+void InputTraceWriter::appendVarint(quint64 value) {
+    while (value >= 0x80) {
+        m_buffer.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_buffer.append(static_cast<char>(value));
+}
+
+InputTraceReader::InputTraceReader(QIODevice *device)
+    : m_device(device)
+    , m_position(0)
+    , m_timestamp(0)
+    , m_startTimeUs(0)
+    , m_eventCount(0) {
+}
+
+bool InputTraceReader::fill() {
+    // Keep the unread tail and append the next block
+    m_buffer.remove(0, static_cast<int>(m_position));
+    m_position = 0;
+
+    const QByteArray block = m_device->read(BufferSize);
+    m_buffer.append(block);
+    return !block.isEmpty();
+}
+
+const uchar *InputTraceReader::bytes() const {
+    return reinterpret_cast<const uchar *>(m_buffer.constData());
+}
+
+bool InputTraceReader::readHeader() {
+    QString error;
+    Decoded result;
+    while ((result = decodeHeader(bytes(), m_buffer.size(), &m_position, &m_startTimeUs, &error))
+               == Decoded::Incomplete
+           && fill()) {
+    }
+    if (result != Decoded::Ok) {
+        m_errorString = error;
+        return false;
+    }
+    return true;
+}
+
+bool InputTraceReader::next(InputTraceEvent *event) {
+    for (;;) {
+        const Decoded result = decodeEvent(bytes(), m_buffer.size(), &m_position, &m_timestamp,
+                                           m_eventCount, event, &m_errorString);
+        if (result == Decoded::Ok) {
+            ++m_eventCount;
+            return true;
+        }
+        if (result == Decoded::Corrupt || !fill()) {
+            return false;
+        }
+    }
+}
+
+InputTraceCursor::InputTraceCursor(const uchar *data, qint64 size)
+    : m_data(data)
+    , m_size(size)
+    , m_position(0)
+    , m_firstEvent(0)
+    , m_timestamp(0)
+    , m_startTimeUs(0)
+    , m_eventCount(0) {
+}
+
+bool InputTraceCursor::readHeader() {
+    if (decodeHeader(m_data, m_size, &m_position, &m_startTimeUs, &m_errorString) != Decoded::Ok) {
+        return false;
+    }
+    m_firstEvent = m_position;
+    return true;
+}
+
+void InputTraceCursor::rewind() {
+    m_position = m_firstEvent;
+    m_timestamp = 0;
+    m_eventCount = 0;
+}
+
+bool InputTraceCursor::next(InputTraceEvent *event) {
+    if (decodeEvent(m_data, m_size, &m_position, &m_timestamp, m_eventCount, event, &m_errorString)
+        != Decoded::Ok) {
+        return false;
+    }
+    ++m_eventCount;
+    return true;
+}
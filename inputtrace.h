@@ -0,0 +1,112 @@
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include "classprofile.h"
+
+class QIODevice;
+
+// One key or mouse button transition of a recorded session
+struct InputTraceEvent {
+    qint64 timestampUs;  // Microseconds; only differences between events matter
+    InputType type;
+    quint8 key;          // Virtual key code for keyboard, 0 for mouse
+    bool down;
+};
+
+// Trace files (*.aktrace) start with an 8 byte header: "AKTR", a version
+// byte and three reserved bytes, followed by the wall-clock start time in
+// microseconds since the epoch as a varint. Each event is then two varints:
+// the microseconds since the previous event, and key << 3 | type << 1 | down.
+// Events at human speed take 4-5 bytes.
+class InputTraceWriter {
+public:
+    explicit InputTraceWriter(QIODevice *device);
+
+    // Writes the header. originUs is the timestamp the first event's delta
+    // is taken from, in the clock of the events.
+    bool begin(qint64 startTimeUs, qint64 originUs);
+    // Events are buffered and written in blocks of FlushThreshold bytes
+    bool append(const InputTraceEvent &event);
+    bool flush();
+
+    qint64 eventCount() const { return m_eventCount; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+    static const char Magic[4];
+    static const quint8 Version = 1;
+
+private:
+    static const int FlushThreshold = 64 * 1024;
+
+    void appendVarint(quint64 value);
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    qint64 m_lastTimestamp;
+    qint64 m_eventCount;
+    qint64 m_bytesWritten;
+};
+
+// Reads a trace sequentially through a fixed-size buffer, so traces of any
+// length are read in constant memory. Timestamps are microseconds since the
+// start of the recording.
+class InputTraceReader {
+public:
+    explicit InputTraceReader(QIODevice *device);
+
+    bool readHeader();
+    // False at the end of the trace or on an error. A record cut off by a
+    // crash during recording ends the trace without an error.
+    bool next(InputTraceEvent *event);
+
+    bool hasError() const { return !m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+    qint64 startTimeUs() const { return m_startTimeUs; }
+    qint64 eventCount() const { return m_eventCount; }
+
+private:
+    static const int BufferSize = 64 * 1024;
+
+    bool fill();
+    const uchar *bytes() const;
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    qint64 m_position;
+    qint64 m_timestamp;
+    qint64 m_startTimeUs;
+    qint64 m_eventCount;
+    QString m_errorString;
+};
+
+// Decodes a trace that is entirely in memory, typically a mapped file.
+// Nothing is copied or allocated while decoding, and rewind() restarts at
+// the first event, so a trace can be played in a loop at no extra cost.
+class InputTraceCursor {
+public:
+    InputTraceCursor(const uchar *data, qint64 size);
+
+    bool readHeader();
+    // Same semantics as InputTraceReader::next()
+    bool next(InputTraceEvent *event);
+    void rewind();
+
+    bool hasError() const { return !m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+    qint64 startTimeUs() const { return m_startTimeUs; }
+    qint64 eventCount() const { return m_eventCount; }
+
+private:
+    const uchar *m_data;
+    qint64 m_size;
+    qint64 m_position;
+    qint64 m_firstEvent;   // Offset of the first event, after the header
+    qint64 m_timestamp;
+    qint64 m_startTimeUs;
+    qint64 m_eventCount;
+    QString m_errorString;
+};
+
+#endif // INPUTTRACE_H
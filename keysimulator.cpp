@@ -1,124 +1,196 @@
 #include "keysimulator.h"
+#include "allocationcounter.h"
 #include <QDebug>
-#include <QApplication>
-#include <QWidget>
 #include <QtCore>
 #include <climits>
 
 KeySimulator::KeySimulator(QObject *parent)
-    : QObject(parent), m_isRunning(false) {
-    // Initialize timer for smart simulation
+    : QObject(parent), m_isRunning(false), m_isPaused(false), m_targetActive(true), m_dryRun(false), m_nextDeadline(0)
+    , m_tickLateness(0), m_throttledCount(0), m_urgentPicks(0), m_pressCount(0) {
+    // The engine timer is re-armed for each deadline instead of polling. It
+    // repeats, so ticks that sleep equally long do not re-arm it at all.
     m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
     connect(m_timer, &QTimer::timeout, this, &KeySimulator::executeAction);
 }
 
 KeySimulator::~KeySimulator() {
     stopSimulation();
-    unregisterGlobalHotkeys();
 }
 
 void KeySimulator::startSimulation(const ClassProfile &profile) {
+    startSimulation(ExecutionPlan::compile(profile));
+}
+
+void KeySimulator::startSimulation(const ExecutionPlanPtr &plan) {
     if (m_isRunning) {
-        stopSimulation();
+        // Switching builds mid-fight must not lose the cooldowns
+        publishPlan(plan);
+        return;
     }
 
-    m_currentProfile = profile;
+    // Start from a clean plan without any cooldown state
+    m_activePlan = plan;
+    m_lastPressed.reserve(qMax(StateReserve, m_activePlan->size()));
+    m_lastPressed.fill(ExecutionPlan::NeverPressed, m_activePlan->size());
+    m_stateScratch.reserve(m_lastPressed.capacity());
+    std::atomic_store(&m_publishedPlan, m_activePlan);
     m_isRunning = true;
+    m_isPaused = false;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_budget = TokenBucket();
+    m_budget.configure(m_activePlan->rateLimit(), m_activePlan->rateBurst(), now);
+    m_throttledCount = 0;
+    m_urgentPicks = 0;
+    m_pressCount = 0;
+    if (m_lookAhead) {
+        // The first tick decides inline and starts the planner from there
+        m_lookAhead->reserve(m_lastPressed.capacity());
+        m_lookAhead->invalidate();
+    }
 
-    // Clear previous key states
-    m_keyStates.clear();
-
-    // Start timer with 50ms interval for smart simulation
-    m_timer->start(50);
+    if (!isHeld()) {
+        scheduleTick(now + TickInterval, now);
+    }
 
-    qDebug() << "Smart key simulation started with profile:" << profile.getName();
+    qDebug() << "Smart key simulation started with profile:" << m_activePlan->profileName();
     emit simulationStarted();
 }
 
+void KeySimulator::updateProfile(const ClassProfile &profile) {
+    if (!m_isRunning) {
+        return;
+    }
+
+    publishPlan(ExecutionPlan::compile(profile));
+}
 
+void KeySimulator::publishPlan(const ExecutionPlanPtr &plan) {
+    // The tick picks the new plan up on its next run; the old plan stays
+    // alive until the tick has dropped its reference to it
+    std::atomic_store(&m_publishedPlan, plan);
 
-void KeySimulator::stopSimulation() {
-    if (!m_isRunning) {
+    // The engine may be sleeping until a cooldown of the old plan expires;
+    // make sure it looks at the new plan within one tick
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_isRunning || isHeld()) {
+            return;
+        }
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (!m_timer->isActive() || m_nextDeadline > now + TickInterval) {
+            scheduleTick(now + TickInterval, now);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void KeySimulator::setPaused(bool paused) {
+    if (!m_isRunning || paused == m_isPaused) {
         return;
     }
 
-    // Clear key states and stop timer
-    m_keyStates.clear();
-    m_timer->stop();
-    m_isRunning = false;
+    const bool wasHeld = isHeld();
+    m_isPaused = paused;
+    applyHold(wasHeld);
 
-    qDebug() << "Simulation stopped";
-    emit simulationStopped();
+    qDebug() << (paused ? "Simulation paused" : "Simulation resumed");
+    emit pausedChanged(paused);
 }
 
-bool KeySimulator::registerGlobalHotkeys() {
-    // Get the main window handle safely
-    QWidget *mainWindow = QApplication::activeWindow();
-    if (!mainWindow) {
-        // If no active window, try to get the first top-level widget
-        QWidgetList topLevelWidgets = QApplication::topLevelWidgets();
-        if (!topLevelWidgets.isEmpty()) {
-            mainWindow = topLevelWidgets.first();
-        }
+void KeySimulator::setTargetActive(bool active) {
+    if (active == m_targetActive) {
+        return;
     }
 
-    if (!mainWindow) {
-        qDebug() << "No main window available for hotkey registration";
-        return false;
+    const bool wasHeld = isHeld();
+    m_targetActive = active;
+    if (m_isRunning) {
+        applyHold(wasHeld);
+    }
+}
+
+void KeySimulator::applyHold(bool wasHeld) {
+    const bool held = isHeld();
+    if (held == wasHeld) {
+        return;
     }
 
-    HWND hwnd = reinterpret_cast<HWND>(mainWindow->winId());
-    qDebug() << "Registering hotkeys for window handle:" << hwnd;
-
-    // Register F5 as start hotkey (VK_F5 = 0x74)
-    bool f5Success = RegisterHotKey(
-        hwnd,
-        HOTKEY_START,
-        0, // No modifiers - this makes it work globally across all applications
-        0x74 // VK_F5
-    );
-
-    // Register F6 as stop hotkey (VK_F6 = 0x75)
-    bool f6Success = RegisterHotKey(
-        hwnd,
-        HOTKEY_STOP,
-        0, // No modifiers - this makes it work globally across all applications
-        0x75 // VK_F6
-    );
-
-    if (f5Success && f6Success) {
-        qDebug() << "Global hotkeys registered successfully - F5:" << f5Success << "F6:" << f6Success;
-        return true;
+    if (held) {
+        m_timer->stop();
+        m_nextDeadline = 0;
+        if (m_lookAhead) {
+            m_lookAhead->invalidate();
+        }
     } else {
-        qDebug() << "Failed to register global hotkeys - F5:" << f5Success << "F6:" << f6Success;
-        // Try to get more specific error information
-        DWORD error = GetLastError();
-        qDebug() << "Windows error code:" << error;
-        unregisterGlobalHotkeys();
-        return false;
+        // Cooldowns are absolute timestamps, so they simply continue
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        scheduleTick(now + TickInterval, now);
     }
 }
 
-void KeySimulator::unregisterGlobalHotkeys() {
-    // Get the main window handle safely
-    QWidget *mainWindow = QApplication::activeWindow();
-    if (!mainWindow) {
-        // If no active window, try to get the first top-level widget
-        QWidgetList topLevelWidgets = QApplication::topLevelWidgets();
-        if (!topLevelWidgets.isEmpty()) {
-            mainWindow = topLevelWidgets.first();
-        }
+QString KeySimulator::activeProfileName() const {
+    return m_activePlan ? m_activePlan->profileName() : QString();
+}
+
+int KeySimulator::sleepInterval(qint64 deadline, qint64 now) {
+    return static_cast<int>(qBound<qint64>(0, deadline - now, MaxSleep));
+}
+
+void KeySimulator::scheduleTick(qint64 deadline, qint64 now) {
+    m_nextDeadline = deadline;
+    m_timer->start(sleepInterval(deadline, now));
+}
+
+void KeySimulator::adoptPublishedPlan() {
+    ExecutionPlanPtr published = std::atomic_load(&m_publishedPlan);
+    if (published == m_activePlan) {
+        return;
     }
 
-    if (mainWindow) {
-        HWND hwnd = reinterpret_cast<HWND>(mainWindow->winId());
-        UnregisterHotKey(hwnd, HOTKEY_START);
-        UnregisterHotKey(hwnd, HOTKEY_STOP);
+    // Both buffers stay detached, so this only allocates for a plan larger
+    // than any before
+    m_stateScratch.resize(published->size());
+    published->carryOverState(*m_activePlan, m_lastPressed.constData(), m_stateScratch.data());
+    m_lastPressed.swap(m_stateScratch);
+
+    const bool renamed = published->profileName() != m_activePlan->profileName();
+    m_activePlan = published;
+    m_budget.configure(m_activePlan->rateLimit(), m_activePlan->rateBurst(),
+                       QDateTime::currentMSecsSinceEpoch());
+    if (m_lookAhead) {
+        m_lookAhead->reserve(m_lastPressed.capacity());
+        m_lookAhead->invalidate();
+    }
+    if (renamed) {
+        emit activeProfileChanged(m_activePlan->profileName());
     }
 }
 
+void KeySimulator::stopSimulation() {
+    if (!m_isRunning) {
+        return;
+    }
+
+    // Clear key states and stop timer
+    m_timer->stop();
+    m_nextDeadline = 0;
+    if (m_lookAhead) {
+        m_lookAhead->invalidate();
+    }
+    m_lastPressed.clear();
+    m_stateScratch.clear();
+    m_activePlan.reset();
+    std::atomic_store(&m_publishedPlan, ExecutionPlanPtr());
+    m_isRunning = false;
+    m_isPaused = false;
 
+    qDebug() << "Simulation stopped";
+    emit simulationStopped();
+}
 
+// Input is only injected on Windows; elsewhere the engine runs as if in
+// dry-run mode
+#ifdef Q_OS_WIN
 void KeySimulator::simulateKeyPress(int virtualKey) {
     INPUT inputs[2] = {};
     
@@ -141,6 +213,16 @@ void KeySimulator::simulateMouseClick(bool leftClick) {
     SendInput(2, inputs, sizeof(INPUT));
 }
 
+void KeySimulator::simulateKeyEvent(int virtualKey, bool keyUp) {
+    INPUT input = createKeyInput(virtualKey, keyUp);
+    SendInput(1, &input, sizeof(INPUT));
+}
+
+void KeySimulator::simulateMouseEvent(bool leftButton, bool buttonUp) {
+    INPUT input = createMouseInput(0, leftButton, buttonUp);
+    SendInput(1, &input, sizeof(INPUT));
+}
+
 INPUT KeySimulator::createKeyInput(WORD virtualKey, bool keyUp) {
     INPUT input = {};
     input.type = INPUT_KEYBOARD;
@@ -161,147 +243,189 @@ INPUT KeySimulator::createMouseInput(DWORD mouseData, bool leftButton, bool butt
     
     return input;
 }
+#else
+void KeySimulator::simulateKeyPress(int virtualKey) {
+    Q_UNUSED(virtualKey)
+}
+
+void KeySimulator::simulateMouseClick(bool leftClick) {
+    Q_UNUSED(leftClick)
+}
+
+void KeySimulator::simulateKeyEvent(int virtualKey, bool keyUp) {
+    Q_UNUSED(virtualKey)
+    Q_UNUSED(keyUp)
+}
+
+void KeySimulator::simulateMouseEvent(bool leftButton, bool buttonUp) {
+    Q_UNUSED(leftButton)
+    Q_UNUSED(buttonUp)
+}
+#endif // Q_OS_WIN
 
 
 
 void KeySimulator::executeAction() {
-    if (!m_isRunning) {
+    if (!m_isRunning || isHeld()) {
+        m_timer->stop();
         return;
     }
 
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    QVector<int> weightedPool;
-
-    // Create weighted pool - higher weight = more entries
-    for (const auto& action : m_currentProfile.getActions()) {
-        if (action.enabled && action.type == InputType::Keyboard) {
-            // Check if enough time has passed since last press
-            bool canPress = true;
-            if (m_keyStates.contains(action.key)) {
-                const auto& state = m_keyStates[action.key];
-                qint64 timeSinceLastPress = currentTime - state.lastPressed;
-                canPress = (timeSinceLastPress >= action.minInterval);
-            }
-
-            if (canPress) {
-                // Use squared weight to make differences more dramatic
-                // Weight 95 -> 95*95 = 9025 entries
-                // Weight 40 -> 40*40 = 1600 entries
-                // Weight 20 -> 20*20 = 400 entries
-                int entries = action.weight * action.weight / 100;  // Scale down to reasonable numbers
-                entries = qMax(1, entries);  // At least 1 entry
-
-                for (int i = 0; i < entries; ++i) {
-                    weightedPool.append(action.key);
-                }
-            }
-        }
+    adoptPublishedPlan();
+
+    const qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
+    const qint64 lateness = currentTime - m_nextDeadline;
+    if (lateness > DeadlineSlack) {
+        publishEvent(EngineEvent::DeadlineMiss, currentTime, -1, static_cast<int>(lateness));
+    }
+    m_tickLateness = m_nextDeadline > 0 ? static_cast<qint32>(qBound<qint64>(0, lateness, INT_MAX)) : 0;
+
+    // Plan swaps may emit signals whose slots allocate; the tick itself
+    // must not (checked in Debug builds, see AllocationCounter)
+    const quint64 allocationsBefore = AllocationCounter::count();
+    const qint64 deadline = tick(currentTime);
+    Q_ASSERT_X(AllocationCounter::count() == allocationsBefore, "KeySimulator::executeAction",
+               "the engine tick allocated memory");
+    Q_UNUSED(allocationsBefore)
+
+    if (deadline == ExecutionPlan::NeverReady) {
+        m_timer->stop();
+        m_nextDeadline = 0;
+        return;
     }
 
-    int selectedKey = 0;
-    if (!weightedPool.isEmpty()) {
-        // Randomly select from weighted pool
-        int index = QRandomGenerator::global()->bounded(weightedPool.size());
-        selectedKey = weightedPool[index];
+    // Re-arming allocates inside the event dispatcher; the running timer
+    // already fires at the right time if the sleep length is unchanged. The
+    // repeat is counted from when this tick was due, so a late tick re-arms.
+    if (lateness <= RepeatSlack && m_timer->isActive()
+        && m_timer->interval() == sleepInterval(deadline, currentTime)) {
+        m_nextDeadline = deadline;
     } else {
-        // If no keys available, find the highest weight key
-        int highestWeight = 0;
-        for (const auto& action : m_currentProfile.getActions()) {
-            if (action.enabled && action.type == InputType::Keyboard && action.weight > highestWeight) {
-                highestWeight = action.weight;
-                selectedKey = action.key;
-            }
-        }
+        scheduleTick(deadline, currentTime);
     }
+}
 
-    if (selectedKey > 0) {
-        simulateKeyPress(selectedKey);
+qint64 KeySimulator::tick(qint64 currentTime) {
+    return m_lookAhead ? followLookAhead(currentTime) : decide(currentTime);
+}
 
-        // Update the pressed key's state
-        if (!m_keyStates.contains(selectedKey)) {
-            m_keyStates[selectedKey] = SmartKeyState();
-        }
+qint64 KeySimulator::decide(qint64 currentTime) {
+    const ExecutionPlan::Step step = m_activePlan->step(m_lastPressed.data(), m_budget, currentTime,
+                                                        QRandomGenerator::global(), TickInterval);
+    if (step.slot >= 0) {
+        pressSlot(step.slot, step.urgent, currentTime);
+    }
 
-        auto& state = m_keyStates[selectedKey];
-        state.lastPressed = currentTime;
-        state.isActive = true;
+    if (step.next == ExecutionPlan::NeverReady) {
+        // Empty plan: nothing to do until a new plan is published
+        publishEvent(EngineEvent::Skip, currentTime, -1);
+        return ExecutionPlan::NeverReady;
+    }
+    if (step.throttled > 0) {
+        ++m_throttledCount;
+        publishEvent(EngineEvent::Throttled, currentTime, -1, static_cast<int>(step.throttled));
+    } else if (step.slot < 0) {
+        publishEvent(EngineEvent::Cooldown, currentTime, -1,
+                     static_cast<int>(qMin<qint64>(step.next - currentTime, MaxSleep)));
     }
+    return step.next;
 }
 
-
-
-
-
-QString KeySimulator::generateSequencePreview(const ClassProfile &profile, int length) {
-    if (profile.getActions().isEmpty()) {
-        return "No actions configured";
+qint64 KeySimulator::followLookAhead(qint64 currentTime) {
+    const PlannedPress *press = m_lookAhead->next();
+    if (press && press->time > currentTime) {
+        return press->time;
     }
 
-    QString sequence;
-    QMap<int, int> lastUsed;  // Track when each key was last used
-
-    // Initialize last used times
-    for (const auto& action : profile.getActions()) {
-        if (action.enabled && action.type == InputType::Keyboard) {
-            lastUsed[action.key] = -1000;  // Initialize to allow immediate use
+    // A late tick shifts real cooldowns against the planned ones, so each
+    // press is checked against the real state before it is sent. If the
+    // planner has nothing ready or its press no longer fits, this tick
+    // decides inline and the planner restarts from the result.
+    if (!press || !canPress(press->slot, currentTime)) {
+        const qint64 deadline = decide(currentTime);
+        if (deadline != ExecutionPlan::NeverReady) {
+            m_lookAhead->reset(m_activePlan, m_lastPressed.constData(), m_budget, deadline);
         }
+        return deadline;
     }
 
-    for (int i = 0; i < length; ++i) {
-        QVector<int> weightedPool;
-
-        // Create weighted pool based on availability and weight
-        for (const auto& action : profile.getActions()) {
-            if (action.enabled && action.type == InputType::Keyboard) {
-                // Check if enough time has passed since last use
-                int timeSinceLastUse = i - lastUsed[action.key];
-                int minGap = action.minInterval / 50;  // Convert to steps (50ms base interval)
-
-                if (timeSinceLastUse >= minGap) {
-                    // Use squared weight to make differences more dramatic
-                    int entries = action.weight * action.weight / 100;  // Scale down
-                    entries = qMax(1, entries);  // At least 1 entry
+    m_budget.tryTake();
+    m_activePlan->markPressed(m_lastPressed.data(), press->slot, currentTime);
+    pressSlot(press->slot, press->urgent, currentTime);
+    m_lookAhead->consume();
 
-                    for (int j = 0; j < entries; ++j) {
-                        weightedPool.append(action.key);
-                    }
-                }
-            }
-        }
+    const PlannedPress *following = m_lookAhead->next();
+    if (!following) {
+        return currentTime + TickInterval;
+    }
+    const qint64 deadline = qMax(following->time, currentTime + TickInterval);
+    if (following->throttled > 0) {
+        ++m_throttledCount;
+        publishEvent(EngineEvent::Throttled, currentTime, -1, static_cast<int>(following->throttled));
+    } else if (deadline - currentTime > TickInterval) {
+        publishEvent(EngineEvent::Cooldown, currentTime, -1,
+                     static_cast<int>(qMin<qint64>(deadline - currentTime, MaxSleep)));
+    }
+    return deadline;
+}
 
-        int selectedKey = 0;
-        if (!weightedPool.isEmpty()) {
-            // Randomly select from weighted pool
-            int index = QRandomGenerator::global()->bounded(weightedPool.size());
-            selectedKey = weightedPool[index];
-        } else {
-            // If no keys available, use highest weight key
-            int highestWeight = 0;
-            for (const auto& action : profile.getActions()) {
-                if (action.enabled && action.type == InputType::Keyboard && action.weight > highestWeight) {
-                    highestWeight = action.weight;
-                    selectedKey = action.key;
-                }
-            }
-        }
+bool KeySimulator::canPress(int slot, qint64 now) {
+    m_budget.refill(now);
+    if (m_budget.isLimited() && m_budget.tokens() < 1.0) {
+        return false;
+    }
+    return now - m_lastPressed[slot] >= m_activePlan->slot(slot).minInterval;
+}
 
-        if (selectedKey > 0) {
-            // Update last used time
-            lastUsed[selectedKey] = i;
+void KeySimulator::setLookAhead(bool enabled) {
+    if (enabled == bool(m_lookAhead)) {
+        return;
+    }
 
-            // Convert virtual key to character for display
-            char keyChar = '?';
-            if (selectedKey >= 49 && selectedKey <= 57) {  // 1-9 keys
-                keyChar = '0' + (selectedKey - 48);
-            } else if (selectedKey >= 65 && selectedKey <= 90) {  // A-Z keys
-                keyChar = 'A' + (selectedKey - 65);
-            }
+    if (enabled) {
+        m_lookAhead.reset(new LookAheadPlanner(TickInterval));
+        m_lookAhead->reserve(m_lastPressed.capacity());
+    } else {
+        m_lookAhead.reset();
+    }
+}
 
-            sequence += keyChar;
-        }
+void KeySimulator::pressSlot(int slot, bool urgent, qint64 now) {
+    ++m_pressCount;
+    if (urgent) {
+        ++m_urgentPicks;
+    }
+    if (!m_dryRun) {
+        simulateKeyPress(m_activePlan->slot(slot).key);
     }
+    const int budgetLeft = m_budget.isLimited()
+        ? static_cast<int>(m_budget.tokens() * 100 / m_budget.burst()) : -1;
+    publishEvent(EngineEvent::Press, now, slot, budgetLeft);
+
+    SessionEvent event;
+    event.timestamp = now;
+    event.lateness = m_tickLateness;
+    event.key = static_cast<quint16>(m_activePlan->slot(slot).key);
+    event.slot = static_cast<qint16>(slot);
+    event.queueDepth = static_cast<quint16>(m_lookAhead ? m_lookAhead->queued() : 0);
+    m_sessionEvents.push(event);
+}
 
-    return sequence;
+KeySimulator::BudgetStats KeySimulator::budgetStats() const {
+    return BudgetStats{m_budget.isLimited(), m_budget.tokens(), m_budget.burst(),
+                       m_throttledCount, m_urgentPicks};
 }
 
+void KeySimulator::publishEvent(EngineEvent::Type type, qint64 time, int slot, int value) {
+    EngineEvent event;
+    event.timestamp = time;
+    event.key = slot >= 0 ? m_activePlan->slot(slot).key : 0;
+    event.value = value;
+    event.slot = static_cast<qint16>(slot);
+    event.type = type;
 
+    if (type == EngineEvent::Press) {
+        m_pressEvents.push(event);
+    }
+    m_logEvents.push(event);
+}
@@ -7,8 +7,16 @@
 #include <QDateTime>
 #include <QRandomGenerator>
 #include <QVector>
-#include <windows.h>
 #include "classprofile.h"
+#include "executionplan.h"
+#include "engineevent.h"
+#include "tokenbucket.h"
+#include "lookaheadplanner.h"
+#include <memory>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
 
 
 
@@ -19,57 +27,136 @@ public:
     explicit KeySimulator(QObject *parent = nullptr);
     ~KeySimulator();
     
-    // Main control methods
+    // Main control methods. Starting while running switches to the plan at
+    // the next tick instead of restarting, see publishPlan().
     void startSimulation(const ClassProfile &profile);
+    void startSimulation(const ExecutionPlanPtr &plan);
     void stopSimulation();
     bool isRunning() const { return m_isRunning; }
+    // Pausing keeps the plan and its cooldowns; nothing is pressed until resumed
+    void setPaused(bool paused);
+    bool isPaused() const { return m_isPaused; }
+    // Cleared while the target window is not focused; holds the engine like
+    // a pause, but independently of it and across start and stop
+    void setTargetActive(bool active);
+    bool isTargetActive() const { return m_targetActive; }
+    QString activeProfileName() const;
 
-    // Sequence preview
-    QString generateSequencePreview(const ClassProfile &profile, int length = 50);
-    
-    // Global hotkey management
-    bool registerGlobalHotkeys();
-    void unregisterGlobalHotkeys();
+    // Hot-reload: compiles the profile and swaps it into the running engine.
+    // Cooldowns of keys that exist in both plans are kept.
+    void updateProfile(const ClassProfile &profile);
+    // Swaps a compiled plan in at the next tick boundary; no compile, no
+    // restart, and the rate budget keeps its tokens
+    void publishPlan(const ExecutionPlanPtr &plan);
+
+    // Engine events for visualization. The engine is the only producer; each
+    // ring must be drained from a single thread.
+    EngineEventRing *pressEvents() { return &m_pressEvents; }  // Presses only
+    EngineEventRing *logEvents() { return &m_logEvents; }      // All event types
+    // Every key sent, with the tick's lateness, for the SessionLog
+    SessionEventRing *sessionEvents() { return &m_sessionEvents; }
+
+    // State of the profile's rate budget since the simulation started
+    struct BudgetStats {
+        bool limited;
+        double tokens;        // Occupancy at the last tick
+        int burst;
+        quint64 throttled;    // Times a ready key had to wait for a token
+        quint64 urgentPicks;  // Presses picked by urgency with the last token
+    };
+    BudgetStats budgetStats() const;
+    // Keys sent since the simulation started
+    quint64 pressCount() const { return m_pressCount; }
+
+    // One engine tick at the given time: presses at most one key and
+    // returns when the next tick is due, or ExecutionPlan::NeverReady for an
+    // empty plan. Allocation-free once the simulation has started; the
+    // engine timer runs it, benchmarks call it directly.
+    qint64 tick(qint64 now);
+    // Decides and publishes presses without sending any input
+    void setDryRun(bool dryRun) { m_dryRun = dryRun; }
+    // Presses are decided ahead on a worker thread; the engine timer then
+    // only checks and sends them. Decides inline on every tick when off.
+    void setLookAhead(bool enabled);
+    bool isLookAhead() const { return bool(m_lookAhead); }
+    // Presses decided by the planner and not sent yet, 0 without look-ahead
+    int plannedAhead() const { return m_lookAhead ? m_lookAhead->queued() : 0; }
+
+    // Minimum spacing between presses
+    static const int TickInterval = 50;
     
     // Static key simulation methods
     static void simulateKeyPress(int virtualKey);
     static void simulateMouseClick(bool leftClick);
+    // Single transitions, for replaying recorded input
+    static void simulateKeyEvent(int virtualKey, bool keyUp);
+    static void simulateMouseEvent(bool leftButton, bool buttonUp);
     
 signals:
     void simulationStarted();
     void simulationStopped();
-    void hotkeyPressed(int hotkeyId);
-    
-protected:
-    // Windows message handling for global hotkeys
-    bool nativeEventFilter(const QByteArray &eventType, void *message, long *result);
+    // The running engine switched to a plan for a differently named profile
+    void activeProfileChanged(const QString &profileName);
+    void pausedChanged(bool paused);
     
 private slots:
     void executeAction();
     
 private:
-    // Smart key state tracking
-    struct SmartKeyState {
-        qint64 lastPressed;
-        bool isActive;
-
-        SmartKeyState() : lastPressed(0), isActive(true) {}
-    };
-
     bool m_isRunning;
-    ClassProfile m_currentProfile;
-    QMap<int, SmartKeyState> m_keyStates;
+    bool m_isPaused;
+    bool m_targetActive;
+    bool m_dryRun;
+
+    // Plan published by the GUI; only accessed through std::atomic_load/store
+    ExecutionPlanPtr m_publishedPlan;
+    // Plan the tick is currently reading, with per-slot cooldown timestamps
+    ExecutionPlanPtr m_activePlan;
+    QVector<qint64> m_lastPressed;
+    // Preallocated target of the state carried over by the next plan swap
+    QVector<qint64> m_stateScratch;
     QTimer *m_timer;
-    
-    // Global hotkey IDs
-    static const int HOTKEY_START = 1;
-    static const int HOTKEY_STOP = 2;
+    qint64 m_nextDeadline;  // When the pending tick is due, 0 if none
+    EngineEventRing m_pressEvents;
+    EngineEventRing m_logEvents;
+    SessionEventRing m_sessionEvents;
+    qint32 m_tickLateness;  // Of the running tick, recorded with its press
+    TokenBucket m_budget;
+    quint64 m_throttledCount;
+    quint64 m_urgentPicks;
+    quint64 m_pressCount;
+    std::unique_ptr<LookAheadPlanner> m_lookAhead;
+
+    // How late a tick may run before it is reported
+    static const int DeadlineSlack = 25;
+    // How late a tick may run and still keep the repeating timer
+    static const int RepeatSlack = 1;
+    // Upper bound of a single sleep; a plan with huge cooldowns re-checks hourly
+    static const int MaxSleep = 3600000;
+    // Slots the state buffers hold without reallocating on a plan swap
+    static const int StateReserve = 64;
     
     // Helper methods
+    void adoptPublishedPlan();
+    // Nothing is pressed while paused or while the target is not focused
+    bool isHeld() const { return m_isPaused || !m_targetActive; }
+    // Stops or re-arms the timer after isHeld() changed
+    void applyHold(bool wasHeld);
+    static int sleepInterval(qint64 deadline, qint64 now);
+    void scheduleTick(qint64 deadline, qint64 now);
+    // The decision on the engine thread, and its look-ahead counterpart
+    qint64 decide(qint64 now);
+    qint64 followLookAhead(qint64 now);
+    // Whether a planned press still fits the cooldowns and the budget
+    bool canPress(int slot, qint64 now);
+    void pressSlot(int slot, bool urgent, qint64 now);
+    void publishEvent(EngineEvent::Type type, qint64 time, int slot, int value = 0);
     
+#ifdef Q_OS_WIN
     // Windows API helpers
     static INPUT createKeyInput(WORD virtualKey, bool keyUp = false);
     static INPUT createMouseInput(DWORD mouseData, bool leftButton, bool buttonUp = false);
+#endif
 };
 
 #endif // KEYSIMULATOR_H
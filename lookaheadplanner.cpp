@@ -0,0 +1,138 @@
+#include "lookaheadplanner.h"
+#include <algorithm>
+
+LookAheadPlanner::LookAheadPlanner(int spacing)
+    : m_spacing(spacing)
+    , m_epoch(0)
+    , m_planned(0)
+    , m_requestPending(false)
+    , m_stopping(false)
+    , m_requestStart(0)
+    , m_requestEpoch(0) {
+    m_worker = std::thread([this]() { workerLoop(); });
+}
+
+LookAheadPlanner::~LookAheadPlanner() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+void LookAheadPlanner::reserve(int slots) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requestState.reserve(slots);
+}
+
+void LookAheadPlanner::reset(const ExecutionPlanPtr &plan, const qint64 *state,
+                             const TokenBucket &budget, qint64 start) {
+    m_ring.drain([](const PlannedPress &) {});
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requestEpoch = m_epoch.fetch_add(1, std::memory_order_release) + 1;
+        m_requestPlan = plan;
+        m_requestState.resize(plan->size());
+        std::copy(state, state + plan->size(), m_requestState.begin());
+        m_requestBudget = budget;
+        m_requestStart = start;
+        m_requestPending = true;
+    }
+    m_wake.notify_one();
+}
+
+void LookAheadPlanner::invalidate() {
+    m_ring.drain([](const PlannedPress &) {});
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_requestPending = false;
+    m_requestPlan.reset();
+}
+
+const PlannedPress *LookAheadPlanner::next() {
+    // Presses of an earlier epoch are dropped here; the worker may still
+    // queue one right after the epoch changed
+    const quint32 epoch = m_epoch.load(std::memory_order_acquire);
+    while (const PlannedPress *press = m_ring.front()) {
+        if (press->epoch == epoch) {
+            return press;
+        }
+        m_ring.pop();
+    }
+    return nullptr;
+}
+
+void LookAheadPlanner::consume() {
+    m_ring.pop();
+    if (m_ring.size() == Depth - Batch) {
+        wakeWorker();
+    }
+}
+
+void LookAheadPlanner::wakeWorker() {
+    // Taking the lock orders the wake-up after the worker's check of the
+    // queue, so it cannot be lost
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_one();
+}
+
+void LookAheadPlanner::workerLoop() {
+    // The worker's own copy of the engine state, advanced on a virtual clock
+    ExecutionPlanPtr plan;
+    QVector<qint64> state;
+    TokenBucket budget;
+    qint64 time = 0;
+    qint64 throttled = 0;
+    quint32 epoch = 0;
+    QRandomGenerator rng(QRandomGenerator::global()->generate());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_requestPending) {
+            // Copied rather than shared, so the engine's buffer never detaches
+            m_requestPending = false;
+            plan = m_requestPlan;
+            state.resize(m_requestState.size());
+            std::copy(m_requestState.cbegin(), m_requestState.cend(), state.begin());
+            budget = m_requestBudget;
+            time = m_requestStart;
+            epoch = m_requestEpoch;
+            throttled = 0;
+        }
+        if (epoch != m_epoch.load(std::memory_order_acquire)) {
+            plan.reset();
+        }
+        if (!plan || m_ring.size() > Depth - Batch) {
+            m_wake.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        bool planEmpty = false;
+        int planned = 0;
+        while (planned < Batch && epoch == m_epoch.load(std::memory_order_relaxed)) {
+            const ExecutionPlan::Step step = plan->step(state.data(), budget, time, &rng, m_spacing);
+            if (step.slot >= 0) {
+                m_ring.push(PlannedPress{time, throttled, epoch, static_cast<qint16>(step.slot),
+                                         step.urgent});
+                m_planned.fetch_add(1, std::memory_order_relaxed);
+                throttled = 0;
+                ++planned;
+            }
+            if (step.next == ExecutionPlan::NeverReady) {
+                planEmpty = true;
+                break;
+            }
+            throttled += step.throttled;
+            time = step.next;
+        }
+        lock.lock();
+
+        if (planEmpty) {
+            plan.reset();
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef LOOKAHEADPLANNER_H
+#define LOOKAHEADPLANNER_H
+
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "executionplan.h"
+#include "spscring.h"
+#include "tokenbucket.h"
+
+// A press decided ahead of time by the LookAheadPlanner
+struct PlannedPress {
+    qint64 time;       // When to press, engine milliseconds
+    qint64 throttled;  // How long the rate budget delayed this press
+    quint32 epoch;     // Planner epoch the press was decided in
+    qint16 slot;       // Slot index in the plan
+    bool urgent;       // Chosen by urgency with the budget's last token
+};
+
+// Decides the engine's presses ahead of time. A worker thread runs
+// ExecutionPlan::step() on a virtual clock, starting from a copy of the
+// engine's cooldown and budget state, and queues the resulting presses with
+// their times; the engine thread only checks and sends them.
+//
+// reset() hands the worker a new starting point and invalidate() stops it.
+// Both bump the epoch, which discards everything queued before, so a new
+// plan, a pause or a press that no longer fits the real state takes effect
+// at the next tick.
+class LookAheadPlanner {
+public:
+    explicit LookAheadPlanner(int spacing);
+    ~LookAheadPlanner();
+
+    // Engine thread. Plans from 'state' (one timestamp per plan slot) and
+    // 'budget' at time 'start'. Does not allocate for plans up to the
+    // reserved size.
+    void reset(const ExecutionPlanPtr &plan, const qint64 *state, const TokenBucket &budget,
+               qint64 start);
+    void invalidate();
+    void reserve(int slots);
+
+    // Engine thread. The next press of the current epoch, nullptr if the
+    // worker has not decided it yet; consume() removes it once sent.
+    const PlannedPress *next();
+    void consume();
+
+    // Presses queued, some possibly of an earlier epoch
+    int queued() const { return m_ring.size(); }
+    // Presses decided since construction, including discarded ones
+    quint64 plannedCount() const { return m_planned.load(std::memory_order_relaxed); }
+
+    // Presses kept ready; the worker tops the queue up in batches
+    static const int Depth = 128;
+    static const int Batch = 32;
+
+private:
+    using PressRing = SpscRing<PlannedPress, Depth>;
+
+    void workerLoop();
+    void wakeWorker();
+
+    const int m_spacing;
+    PressRing m_ring;
+    std::atomic<quint32> m_epoch;
+    std::atomic<quint64> m_planned;
+
+    // Starting point for the worker, guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_requestPending;
+    bool m_stopping;
+    ExecutionPlanPtr m_requestPlan;
+    QVector<qint64> m_requestState;
+    TokenBucket m_requestBudget;
+    qint64 m_requestStart;
+    quint32 m_requestEpoch;
+
+    // A thread of its own: the worker waits for requests for the planner's
+    // whole life and would hold a global QThreadPool thread all that time
+    std::thread m_worker;
+};
+
+#endif // LOOKAHEADPLANNER_H
@@ -4,7 +4,12 @@
 #include <QDir>
 #include <QStandardPaths>
 #include <QDebug>
+#include <QThread>
 #include "mainwindow.h"
+#include "benchmarks.h"
+#include "tracecommands.h"
+#include "controlclient.h"
+#include "controlserver.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -13,7 +18,40 @@
 #include <iostream>
 #endif
 
+#ifdef _WIN32
+// The GUI subsystem starts without a console, so headless commands write
+// their results to the console they were started from. Output that already
+// goes somewhere (a console build, a file or a pipe) is left alone.
+static void attachParentConsole() {
+    const bool hasOutput = GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) != FILE_TYPE_UNKNOWN;
+    if (hasOutput || !AttachConsole(ATTACH_PARENT_PROCESS)) {
+        return;
+    }
+    FILE *stream = nullptr;
+    freopen_s(&stream, "CONOUT$", "w", stdout);
+    freopen_s(&stream, "CONOUT$", "w", stderr);
+    std::ios::sync_with_stdio(true);
+}
+#endif
+
 int main(int argc, char *argv[]) {
+    // Headless benchmarks run without creating any windows
+    const bool headless = argc > 1 && (QByteArray(argv[1]).startsWith("--bench-")
+                                       || QByteArray(argv[1]).startsWith("--trace-"));
+#ifdef _WIN32
+    if (headless) {
+        attachParentConsole();
+    }
+#endif
+    if (headless && QByteArray(argv[1]).startsWith("--bench-")) {
+        QCoreApplication app(argc, argv);
+        return runBenchmark(app.arguments());
+    }
+    if (headless) {
+        QCoreApplication app(argc, argv);
+        return runTraceCommand(app.arguments());
+    }
+
     QApplication app(argc, argv);
 
 #ifdef _WIN32
@@ -43,6 +81,23 @@ int main(int argc, char *argv[]) {
     app.setOrganizationName("AutoKey");
     app.setOrganizationDomain("autokey.local");
     
+    // One instance at a time: a second launch brings the first to the front.
+    // The first may still be starting up, so give its control channel a
+    // moment to appear.
+    if (!ControlServer::claimInstance()) {
+        ControlClient runningInstance;
+        for (int attempt = 0; attempt < 10; ++attempt) {
+            if (runningInstance.connectToServer(200, nullptr)) {
+                ControlProtocol::Request request;
+                request.command = ControlProtocol::Activate;
+                runningInstance.call(request, nullptr, nullptr);
+                break;
+            }
+            QThread::msleep(200);
+        }
+        return 0;
+    }
+    
     // Check if system tray is available
     if (!QSystemTrayIcon::isSystemTrayAvailable()) {
         QMessageBox::critical(nullptr, "System Tray",
@@ -10,8 +10,12 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QPushButton>
+#include <QTableView>
+#include <QListView>
 #include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QFontDatabase>
+#include <QSignalBlocker>
+#include <QSortFilterProxyModel>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QCheckBox>
@@ -24,20 +28,44 @@
 #include <QMenu>
 #include <QAction>
 #include <QCloseEvent>
-#include <QShowEvent>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QFile>
 #include <QTimer>
+#include <QFileSystemWatcher>
 #include <QStandardPaths>
+#include <QFileInfo>
+#include <QDir>
+#include <QPointer>
+#include <QtConcurrent>
 #include <QDebug>
-#include <windows.h>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , m_aboutTab(nullptr)
+    , m_undoAction(nullptr)
+    , m_redoAction(nullptr)
     , m_configManager(new ConfigManager())
     , m_keySimulator(new KeySimulator(this))
+    , m_hotkeyRegistry(new HotkeyRegistry(this))
+    , m_traceRecorder(new TraceRecorder())
+    , m_sessionLog(new SessionLog())
+    , m_captureSource(InputCaptureSource::create())
+    , m_traceReplayer(new TraceReplayer(this))
+    , m_focusGate(new FocusGate(this))
+    , m_controlServer(new ControlServer(this))
     , m_isSimulationRunning(false)
-    , m_statusUpdateTimer(new QTimer(this)) {
+    , m_runningProfileIndex(-1)
+    , m_wakeupMonitor(new WakeupMonitor(this))
+    , m_configWatcher(new QFileSystemWatcher(this))
+    , m_autoSaveWatcher(new QFutureWatcher<QByteArray>(this))
+    , m_autoSaveRunning(false)
+    , m_autoSavePending(false)
+    , m_configChangedDuringSave(false)
+    , m_importer(nullptr)
+    , m_importThread(nullptr)
+    , m_importReplaces(false)
+    , m_traceWatcher(nullptr) {
     
     setupUI();
     setupSystemTray();
@@ -47,19 +75,41 @@ MainWindow::MainWindow(QWidget *parent)
     
     // Load configuration
     m_configManager->loadConfiguration();
+    {
+        QSignalBlocker blocker(m_profileComboBox);
+        m_profileModel->reload();
+    }
+    // Every profile is compiled up front, so hotkeys switch without compiling
+    m_planCache.refresh(m_configManager->getProfiles());
+
+    // Watch the config file so external edits reach a running simulation
+    m_configWatcher->addPath(m_configManager->getDefaultConfigPath());
+    connect(m_configWatcher, &QFileSystemWatcher::fileChanged,
+            this, &MainWindow::onConfigFileChanged);
+    connect(m_autoSaveWatcher, &QFutureWatcher<QByteArray>::finished,
+            this, &MainWindow::onAutoSaveFinished);
 
     // DEBUG: Add breakpoint here to check if UI is properly initialized
     qDebug() << "About to call updateUI()";
     updateUI();
     qDebug() << "updateUI() completed";
 
-    // Delay hotkey registration until after the window is shown
-    // We'll register hotkeys in showEvent() instead
-    
-    // Setup status update timer
-    m_statusUpdateTimer->setInterval(1000); // Update every second
-    connect(m_statusUpdateTimer, &QTimer::timeout, this, &MainWindow::updateStatusBar);
-    m_statusUpdateTimer->start();
+    // Hotkeys belong to the GUI thread rather than a window, so they work
+    // even when the application starts minimized
+    applyHotkeys();
+    applyTargetWindow();
+    m_keySimulator->setLookAhead(m_configManager->getLookAhead());
+
+    // Scripts and external tools command the engine through a local socket
+    m_controlServer->setHandler([this](const ControlProtocol::Request &request) {
+        return handleControlRequest(request);
+    });
+    QString controlError;
+    if (!m_controlServer->listen(&controlError)) {
+        qWarning() << "Control channel unavailable:" << controlError;
+    }
+
+    // The status bar is updated from engine signals; nothing polls while idle
     
     setWindowTitle("AutoKey for Diablo 3 v1.0");
 
@@ -74,14 +124,23 @@ MainWindow::MainWindow(QWidget *parent)
 }
 
 MainWindow::~MainWindow() {
-    m_keySimulator->stopSimulation();
-    m_keySimulator->unregisterGlobalHotkeys();
-
-    // Also unregister hotkeys from this window
-    HWND hwnd = reinterpret_cast<HWND>(this->winId());
-    UnregisterHotKey(hwnd, 1);
-    UnregisterHotKey(hwnd, 2);
+    if (m_importer) {
+        m_importer->cancel();
+        m_importThread->quit();
+        m_importThread->wait();
+        delete m_importer;
+    }
+    if (m_traceWatcher) {
+        m_traceWatcher->waitForFinished();
+    }
+    m_autoSaveWatcher->waitForFinished();
 
+    m_keySimulator->stopSimulation();
+    m_traceReplayer->stop();
+    stopRecording();
+    delete m_captureSource;
+    delete m_traceRecorder;
+    delete m_sessionLog;
     m_configManager->saveConfiguration();
 }
 
@@ -92,6 +151,7 @@ void MainWindow::setupUI() {
     createProfileTab();
     createActionsTab();
     createSettingsTab();
+    createMonitorTab();
     createAboutTab();
 }
 
@@ -104,8 +164,24 @@ void MainWindow::createProfileTab() {
     QGridLayout *selectionLayout = new QGridLayout(selectionGroup);
     
     selectionLayout->addWidget(new QLabel("Current Profile:"), 0, 0);
+    m_profileModel = new ProfileListModel(m_configManager, this);
+    m_profileFilterModel = new QSortFilterProxyModel(this);
+    m_profileFilterModel->setSourceModel(m_profileModel);
+    m_profileFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
     m_profileComboBox = new QComboBox();
+    // Uniform item sizes keep the popup cheap for large profile libraries
+    QListView *profileView = new QListView(m_profileComboBox);
+    profileView->setUniformItemSizes(true);
+    m_profileComboBox->setView(profileView);
+    m_profileComboBox->setModel(m_profileFilterModel);
+    m_profileComboBox->setMaxVisibleItems(20);
     selectionLayout->addWidget(m_profileComboBox, 0, 1, 1, 2);
+
+    m_profileFilterEdit = new QLineEdit();
+    m_profileFilterEdit->setPlaceholderText("Filter profiles...");
+    m_profileFilterEdit->setClearButtonEnabled(true);
+    selectionLayout->addWidget(m_profileFilterEdit, 0, 3);
     
     m_addProfileButton = new QPushButton("Add");
     m_removeProfileButton = new QPushButton("Remove");
@@ -130,27 +206,50 @@ void MainWindow::createProfileTab() {
     m_profileEnabledCheckBox = new QCheckBox("Enabled");
     detailsLayout->addWidget(m_profileEnabledCheckBox, 1, 0, 1, 2);
     
+    // Rate budget: a token bucket the engine may not exceed
+    detailsLayout->addWidget(new QLabel("Rate Limit:"), 2, 0);
+    QHBoxLayout *budgetLayout = new QHBoxLayout();
+    m_rateLimitSpinBox = new QDoubleSpinBox();
+    m_rateLimitSpinBox->setRange(0.0, 50.0);
+    m_rateLimitSpinBox->setSingleStep(0.5);
+    m_rateLimitSpinBox->setDecimals(1);
+    m_rateLimitSpinBox->setSuffix(" presses/s");
+    m_rateLimitSpinBox->setSpecialValueText("Unlimited");
+    m_rateLimitSpinBox->setKeyboardTracking(false);
+    m_rateBurstSpinBox = new QSpinBox();
+    m_rateBurstSpinBox->setRange(1, 50);
+    m_rateBurstSpinBox->setPrefix("burst ");
+    m_rateBurstSpinBox->setToolTip("Presses that may go out back to back after a quiet moment");
+    m_rateBurstSpinBox->setKeyboardTracking(false);
+    budgetLayout->addWidget(m_rateLimitSpinBox);
+    budgetLayout->addWidget(m_rateBurstSpinBox);
+    budgetLayout->addStretch();
+    detailsLayout->addLayout(budgetLayout, 2, 1);
+    connect(m_rateLimitSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &MainWindow::onRateBudgetEdited);
+    connect(m_rateBurstSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onRateBudgetEdited);
+    
     layout->addWidget(detailsGroup);
     
     // Control buttons
     QGroupBox *controlGroup = new QGroupBox("Simulation Control");
     QHBoxLayout *controlLayout = new QHBoxLayout(controlGroup);
     
-    m_startButton = new QPushButton("Start (F5)");
-    m_stopButton = new QPushButton("Stop (F6)");
-    QPushButton *testSmartButton = new QPushButton("Test Smart Keys");
+    m_startButton = new QPushButton("Start");
+    m_stopButton = new QPushButton("Stop");
+    QPushButton *previewButton = new QPushButton("Preview Sequence");
 
     m_startButton->setStyleSheet("QPushButton { background-color: #4CAF50; color: white; font-weight: bold; }");
     m_stopButton->setStyleSheet("QPushButton { background-color: #f44336; color: white; font-weight: bold; }");
-    testSmartButton->setStyleSheet("QPushButton { background-color: #2196F3; color: white; font-weight: bold; }");
+    previewButton->setStyleSheet("QPushButton { background-color: #2196F3; color: white; font-weight: bold; }");
 
     controlLayout->addWidget(m_startButton);
     controlLayout->addWidget(m_stopButton);
-    controlLayout->addWidget(testSmartButton);
+    controlLayout->addWidget(previewButton);
     controlLayout->addStretch();
 
-    // Connect test button
-    connect(testSmartButton, &QPushButton::clicked, this, &MainWindow::onTestSmartSimulation);
+    connect(previewButton, &QPushButton::clicked, this, &MainWindow::onPreviewSequence);
     
     layout->addWidget(controlGroup);
     
@@ -163,15 +262,13 @@ void MainWindow::createActionsTab() {
     QVBoxLayout *layout = new QVBoxLayout(actionsWidget);
     
     // Actions table
-    m_actionsTable = new QTableWidget();
-    m_actionsTable->setColumnCount(6);
-    QStringList headers = {"Type", "Key/Button", "Interval (ms)", "Weight", "Min/Max Interval", "Enabled"};
-    m_actionsTable->setHorizontalHeaderLabels(headers);
+    m_actionModel = new ActionTableModel(m_configManager, this);
+    m_actionsTable = new QTableView();
+    m_actionsTable->setModel(m_actionModel);
     m_actionsTable->horizontalHeader()->setStretchLastSection(true);
     m_actionsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-
-    // Make interval column editable
-    connect(m_actionsTable, &QTableWidget::itemChanged, this, &MainWindow::onActionTableItemChanged);
+    // Uniform row heights let the view skip per-row size hints on large profiles
+    m_actionsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     
     layout->addWidget(m_actionsTable);
     
@@ -201,16 +298,55 @@ void MainWindow::createSettingsTab() {
     
     hotkeyLayout->addWidget(new QLabel("Start Hotkey:"), 0, 0);
     m_startHotkeyEdit = new QLineEdit();
-    m_startHotkeyEdit->setReadOnly(true);
     hotkeyLayout->addWidget(m_startHotkeyEdit, 0, 1);
     
     hotkeyLayout->addWidget(new QLabel("Stop Hotkey:"), 1, 0);
     m_stopHotkeyEdit = new QLineEdit();
-    m_stopHotkeyEdit->setReadOnly(true);
     hotkeyLayout->addWidget(m_stopHotkeyEdit, 1, 1);
     
+    hotkeyLayout->addWidget(new QLabel("Pause Hotkey:"), 2, 0);
+    m_pauseHotkeyEdit = new QLineEdit();
+    hotkeyLayout->addWidget(m_pauseHotkeyEdit, 2, 1);
+    
+    for (QLineEdit *edit : {m_startHotkeyEdit, m_stopHotkeyEdit, m_pauseHotkeyEdit}) {
+        edit->setPlaceholderText("None");
+        edit->setToolTip("A key with optional modifiers, e.g. F5, Ctrl+Shift+S or Alt+Numpad1");
+        connect(edit, &QLineEdit::editingFinished, this, &MainWindow::onHotkeyEdited);
+    }
+    
+    // One row per profile; its hotkey switches the simulation to that profile
+    hotkeyLayout->addWidget(new QLabel("Profile Hotkeys:"), 3, 0, Qt::AlignTop);
+    m_profileHotkeysTable = new QTableWidget(0, 2);
+    m_profileHotkeysTable->setHorizontalHeaderLabels({"Profile", "Hotkey"});
+    m_profileHotkeysTable->horizontalHeader()->setStretchLastSection(true);
+    m_profileHotkeysTable->verticalHeader()->setVisible(false);
+    m_profileHotkeysTable->setMaximumHeight(160);
+    hotkeyLayout->addWidget(m_profileHotkeysTable, 3, 1);
+    connect(m_profileHotkeysTable, &QTableWidget::itemChanged,
+            this, &MainWindow::onProfileHotkeyEdited);
+    
+    m_hotkeyLatencyLabel = new QLabel("Hotkey latency: no hotkey pressed yet");
+    hotkeyLayout->addWidget(m_hotkeyLatencyLabel, 4, 0, 1, 2);
+    
     layout->addWidget(hotkeyGroup);
     
+    // Target window; the engine holds while any other window is focused
+    QGroupBox *targetGroup = new QGroupBox("Target Window");
+    QGridLayout *targetLayout = new QGridLayout(targetGroup);
+    
+    targetLayout->addWidget(new QLabel("Only send keys to:"), 0, 0);
+    m_targetWindowEdit = new QLineEdit();
+    m_targetWindowEdit->setPlaceholderText("Any window");
+    m_targetWindowEdit->setToolTip("Part of the window title or the program's file name, "
+                                   "e.g. Diablo III or Diablo III64.exe");
+    targetLayout->addWidget(m_targetWindowEdit, 0, 1);
+    connect(m_targetWindowEdit, &QLineEdit::editingFinished, this, &MainWindow::onTargetWindowEdited);
+    
+    m_foregroundLabel = new QLabel();
+    targetLayout->addWidget(m_foregroundLabel, 1, 0, 1, 2);
+    
+    layout->addWidget(targetGroup);
+    
     // Application settings
     QGroupBox *appGroup = new QGroupBox("Application Settings");
     QVBoxLayout *appLayout = new QVBoxLayout(appGroup);
@@ -221,8 +357,30 @@ void MainWindow::createSettingsTab() {
     appLayout->addWidget(m_minimizeToTrayCheckBox);
     appLayout->addWidget(m_startMinimizedCheckBox);
     
+    m_lookAheadCheckBox = new QCheckBox("Plan key presses ahead on a worker thread");
+    m_lookAheadCheckBox->setToolTip("The engine only checks and sends presses that were decided "
+                                    "in advance; turn off to decide each press when it is due");
+    appLayout->addWidget(m_lookAheadCheckBox);
+    connect(m_lookAheadCheckBox, &QCheckBox::toggled, this, &MainWindow::onLookAheadToggled);
+    
     layout->addWidget(appGroup);
     
+    // Trace replay settings
+    QGroupBox *replayGroup = new QGroupBox("Trace Replay");
+    QHBoxLayout *replayLayout = new QHBoxLayout(replayGroup);
+    
+    replayLayout->addWidget(new QLabel("Speed:"));
+    m_replaySpeedSpinBox = new QDoubleSpinBox();
+    m_replaySpeedSpinBox->setRange(0.1, 10.0);
+    m_replaySpeedSpinBox->setSingleStep(0.25);
+    m_replaySpeedSpinBox->setSuffix("x");
+    replayLayout->addWidget(m_replaySpeedSpinBox);
+    m_replayLoopCheckBox = new QCheckBox("Loop until stopped");
+    replayLayout->addWidget(m_replayLoopCheckBox);
+    replayLayout->addStretch();
+    
+    layout->addWidget(replayGroup);
+    
     // Configuration buttons
     QGroupBox *configGroup = new QGroupBox("Configuration");
     QHBoxLayout *configLayout = new QHBoxLayout(configGroup);
@@ -242,6 +400,68 @@ void MainWindow::createSettingsTab() {
     m_tabWidget->addTab(settingsWidget, "Settings");
 }
 
+void MainWindow::createMonitorTab() {
+    QWidget *monitorWidget = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(monitorWidget);
+    
+    QGroupBox *timelineGroup = new QGroupBox("Key Press Timeline (last 10 seconds)");
+    QVBoxLayout *timelineLayout = new QVBoxLayout(timelineGroup);
+    m_timelineWidget = new PressTimelineWidget();
+    m_timelineWidget->setSource(m_keySimulator->pressEvents());
+    timelineLayout->addWidget(m_timelineWidget);
+    
+    layout->addWidget(timelineGroup);
+    
+    // Engine event log; rows are formatted only when visible
+    QGroupBox *logGroup = new QGroupBox("Engine Log");
+    QVBoxLayout *logLayout = new QVBoxLayout(logGroup);
+    m_logModel = new EventLogModel(this);
+    m_logModel->setSource(m_keySimulator->logEvents());
+    m_logView = new QListView();
+    m_logView->setModel(m_logModel);
+    m_logView->setUniformItemSizes(true);
+    m_logView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_logModel->setView(m_logView);
+    logLayout->addWidget(m_logView);
+    
+    QHBoxLayout *logButtonLayout = new QHBoxLayout();
+    m_logFollowCheckBox = new QCheckBox("Follow new events");
+    m_logFollowCheckBox->setChecked(true);
+    QPushButton *clearLogButton = new QPushButton("Clear");
+    m_budgetLabel = new QLabel();
+    logButtonLayout->addWidget(m_logFollowCheckBox);
+    logButtonLayout->addStretch();
+    logButtonLayout->addWidget(m_budgetLabel);
+    logButtonLayout->addWidget(clearLogButton);
+    logLayout->addLayout(logButtonLayout);
+    
+    connect(m_logModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::onLogRowsInserted);
+    connect(clearLogButton, &QPushButton::clicked, m_logModel, &EventLogModel::clear);
+    
+    layout->addWidget(logGroup, 1);
+    
+    m_tabWidget->addTab(monitorWidget, "Monitor");
+}
+
+void MainWindow::onLogRowsInserted() {
+    if (m_logFollowCheckBox->isChecked()) {
+        m_logView->scrollToBottom();
+    }
+
+    // Budget metrics change with engine events, so they follow the log
+    const KeySimulator::BudgetStats budget = m_keySimulator->budgetStats();
+    if (budget.limited) {
+        m_budgetLabel->setText(QString("Rate budget: %1/%2 tokens, %3 throttled, %4 urgent picks")
+            .arg(budget.tokens, 0, 'f', 1)
+            .arg(budget.burst)
+            .arg(budget.throttled)
+            .arg(budget.urgentPicks));
+    } else {
+        m_budgetLabel->setText("Rate budget: unlimited");
+    }
+}
+
 void MainWindow::createAboutTab() {
     QWidget *aboutWidget = new QWidget();
     QVBoxLayout *layout = new QVBoxLayout(aboutWidget);
@@ -256,7 +476,7 @@ void MainWindow::createAboutTab() {
         "<ul>"
         "<li>Multiple character class profiles with customizable key sequences</li>"
         "<li>Configurable intervals for each key/mouse action</li>"
-        "<li>Global hotkeys (F5 to start, F6 to stop)</li>"
+        "<li>Configurable global hotkeys to start, stop, pause and switch profiles</li>"
         "<li>System tray integration</li>"
         "<li>JSON-based configuration storage</li>"
         "<li>5 pre-configured class profiles</li>"
@@ -265,8 +485,8 @@ void MainWindow::createAboutTab() {
         "<ol>"
         "<li>Select or create a character class profile</li>"
         "<li>Configure the keys and intervals for your abilities</li>"
-        "<li>Press F5 to start auto-key simulation</li>"
-        "<li>Press F6 to stop simulation</li>"
+        "<li>Press the start hotkey (F5 by default) to start auto-key simulation</li>"
+        "<li>Press the stop hotkey (F6 by default) to stop simulation</li>"
         "</ol>"
         "<p><b>Note:</b> This application is designed for legitimate gameplay enhancement. "
         "Please ensure compliance with game terms of service.</p>"
@@ -275,6 +495,7 @@ void MainWindow::createAboutTab() {
     
     layout->addWidget(aboutText);
     m_tabWidget->addTab(aboutWidget, "About");
+    m_aboutTab = aboutWidget;
 }
 
 void MainWindow::setupSystemTray() {
@@ -299,8 +520,8 @@ void MainWindow::setupSystemTray() {
 
     m_showAction = new QAction("Show", this);
     m_hideAction = new QAction("Hide", this);
-    m_startAction = new QAction("Start (F5)", this);
-    m_stopAction = new QAction("Stop (F6)", this);
+    m_startAction = new QAction("Start", this);
+    m_stopAction = new QAction("Stop", this);
     m_quitAction = new QAction("Quit", this);
 
     m_trayMenu->addAction(m_showAction);
@@ -320,26 +541,48 @@ void MainWindow::setupMenuBar() {
 
     QAction *loadAction = new QAction("&Load Configuration", this);
     QAction *saveAction = new QAction("&Save Configuration", this);
+    QAction *importAction = new QAction("&Import Profiles...", this);
+    QAction *exportPackAction = new QAction("&Export Profile Pack...", this);
+    QAction *traceProfileAction = new QAction("Create Profile from &Trace...", this);
     QAction *exitAction = new QAction("E&xit", this);
 
     fileMenu->addAction(loadAction);
     fileMenu->addAction(saveAction);
     fileMenu->addSeparator();
+    fileMenu->addAction(importAction);
+    fileMenu->addAction(exportPackAction);
+    fileMenu->addAction(traceProfileAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
 
     QMenu *editMenu = menuBar()->addMenu("&Edit");
+    m_undoAction = new QAction("&Undo", this);
+    m_undoAction->setShortcut(QKeySequence::Undo);
+    m_redoAction = new QAction("&Redo", this);
+    m_redoAction->setShortcut(QKeySequence::Redo);
     QAction *addProfileAction = new QAction("&Add Profile", this);
     QAction *removeProfileAction = new QAction("&Remove Profile", this);
 
+    editMenu->addAction(m_undoAction);
+    editMenu->addAction(m_redoAction);
+    editMenu->addSeparator();
     editMenu->addAction(addProfileAction);
     editMenu->addAction(removeProfileAction);
 
     QMenu *controlMenu = menuBar()->addMenu("&Control");
-    QAction *startAction = new QAction("&Start (F5)", this);
-    QAction *stopAction = new QAction("S&top (F6)", this);
-
-    controlMenu->addAction(startAction);
-    controlMenu->addAction(stopAction);
+    m_startMenuAction = new QAction("&Start", this);
+    m_stopMenuAction = new QAction("S&top", this);
+
+    controlMenu->addAction(m_startMenuAction);
+    controlMenu->addAction(m_stopMenuAction);
+    controlMenu->addSeparator();
+    m_recordAction = new QAction("&Record Input Session...", this);
+    m_recordAction->setCheckable(true);
+    m_recordAction->setEnabled(m_captureSource != nullptr);
+    controlMenu->addAction(m_recordAction);
+    m_replayAction = new QAction("Re&play Input Session...", this);
+    m_replayAction->setCheckable(true);
+    controlMenu->addAction(m_replayAction);
 
     QMenu *helpMenu = menuBar()->addMenu("&Help");
     QAction *aboutAction = new QAction("&About", this);
@@ -348,13 +591,22 @@ void MainWindow::setupMenuBar() {
     // Connect menu actions
     connect(loadAction, &QAction::triggered, this, &MainWindow::onLoadConfiguration);
     connect(saveAction, &QAction::triggered, this, &MainWindow::onSaveConfiguration);
+    connect(importAction, &QAction::triggered, this, &MainWindow::onImportProfiles);
+    connect(exportPackAction, &QAction::triggered, this, &MainWindow::onExportProfilePack);
+    connect(traceProfileAction, &QAction::triggered, this, &MainWindow::onCreateProfileFromTrace);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
+    connect(m_undoAction, &QAction::triggered, this, &MainWindow::onUndo);
+    connect(m_redoAction, &QAction::triggered, this, &MainWindow::onRedo);
     connect(addProfileAction, &QAction::triggered, this, &MainWindow::onAddProfile);
     connect(removeProfileAction, &QAction::triggered, this, &MainWindow::onRemoveProfile);
-    connect(startAction, &QAction::triggered, this, &MainWindow::onStartSimulation);
-    connect(stopAction, &QAction::triggered, this, &MainWindow::onStopSimulation);
+    connect(m_startMenuAction, &QAction::triggered, this, &MainWindow::onStartSimulation);
+    connect(m_stopMenuAction, &QAction::triggered, this, &MainWindow::onStopSimulation);
+    connect(m_recordAction, &QAction::toggled, this, &MainWindow::onRecordToggled);
+    connect(m_replayAction, &QAction::toggled, this, &MainWindow::onReplayToggled);
+    connect(m_traceReplayer, &TraceReplayer::finished, this, &MainWindow::onReplayFinished);
+    connect(m_focusGate, &FocusGate::targetActiveChanged, this, &MainWindow::onTargetActiveChanged);
     connect(aboutAction, &QAction::triggered, [this]() {
-        m_tabWidget->setCurrentIndex(3); // Switch to About tab
+        m_tabWidget->setCurrentWidget(m_aboutTab);
     });
 }
 
@@ -365,12 +617,22 @@ void MainWindow::setupStatusBar() {
 
     statusBar()->addWidget(m_statusLabel);
     statusBar()->addPermanentWidget(m_progressBar);
+    
+    // Event loop wakeups, refreshed once per measurement window
+    m_wakeupLabel = new QLabel();
+    m_wakeupLabel->setToolTip("How often AutoKey woke up the CPU during the last minute");
+    statusBar()->addPermanentWidget(m_wakeupLabel);
+    connect(m_wakeupMonitor, &WakeupMonitor::rateUpdated, this, [this](int rate) {
+        m_wakeupLabel->setText(QString("%1 wakeups/min").arg(rate));
+    });
 }
 
 void MainWindow::setupConnections() {
     // Profile management
     connect(m_profileComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onProfileChanged);
+    connect(m_profileFilterEdit, &QLineEdit::textChanged,
+            m_profileFilterModel, &QSortFilterProxyModel::setFilterFixedString);
     connect(m_addProfileButton, &QPushButton::clicked, this, &MainWindow::onAddProfile);
     connect(m_removeProfileButton, &QPushButton::clicked, this, &MainWindow::onRemoveProfile);
     connect(m_editProfileButton, &QPushButton::clicked, this, &MainWindow::onEditProfile);
@@ -380,10 +642,12 @@ void MainWindow::setupConnections() {
     connect(m_addActionButton, &QPushButton::clicked, this, &MainWindow::onAddAction);
     connect(m_removeActionButton, &QPushButton::clicked, this, &MainWindow::onRemoveAction);
     connect(m_editActionButton, &QPushButton::clicked, this, &MainWindow::onEditAction);
-    connect(m_actionsTable, &QTableWidget::itemSelectionChanged,
+    connect(m_actionsTable->selectionModel(), &QItemSelectionModel::currentRowChanged,
             this, &MainWindow::onActionSelectionChanged);
-    connect(m_actionsTable, &QTableWidget::itemChanged,
-            this, &MainWindow::onActionTableItemChanged);
+    connect(m_actionModel, &ActionTableModel::actionsEdited,
+            this, &MainWindow::onActionsEdited);
+    connect(m_actionModel, &ActionTableModel::editRejected,
+            this, &MainWindow::onActionEditRejected);
 
     // Simulation control
     connect(m_startButton, &QPushButton::clicked, this, &MainWindow::onStartSimulation);
@@ -394,8 +658,16 @@ void MainWindow::setupConnections() {
             this, &MainWindow::onSimulationStarted);
     connect(m_keySimulator, &KeySimulator::simulationStopped,
             this, &MainWindow::onSimulationStopped);
-    connect(m_keySimulator, &KeySimulator::hotkeyPressed,
-            this, &MainWindow::onHotkeyPressed);
+    connect(m_keySimulator, &KeySimulator::activeProfileChanged,
+            this, &MainWindow::updateStatusBar);
+    connect(m_keySimulator, &KeySimulator::pausedChanged,
+            this, &MainWindow::updateStatusBar);
+
+    // Hotkeys
+    connect(m_hotkeyRegistry, &HotkeyRegistry::commandTriggered,
+            this, &MainWindow::onHotkeyCommand);
+    connect(m_hotkeyRegistry, &HotkeyRegistry::latencyMeasured,
+            this, &MainWindow::updateHotkeyLatency);
 
     // System tray
     connect(m_trayIcon, &QSystemTrayIcon::activated,
@@ -409,29 +681,47 @@ void MainWindow::setupConnections() {
 
 // Profile management slots
 void MainWindow::onProfileChanged(int index) {
-    if (index >= 0 && index < m_configManager->getProfiles().size()) {
-        m_configManager->setCurrentProfileIndex(index);
+    Q_UNUSED(index);  // Row in the filtered combo box, not a profile index
+
+    int profileIndex = currentProfileIndex();
+    if (profileIndex >= 0) {
+        m_configManager->setCurrentProfileIndex(profileIndex);
         updateUI();
     }
 }
 
 void MainWindow::onAddProfile() {
     ClassProfile newProfile("New Profile");
-    m_configManager->addProfile(newProfile);
-    m_configManager->setCurrentProfileIndex(m_configManager->getProfiles().size() - 1);
-    updateProfileList();
+    {
+        QSignalBlocker blocker(m_profileComboBox);
+        m_profileModel->appendProfile(newProfile);
+    }
+    m_configManager->setCurrentProfileIndex(m_configManager->profileCount() - 1);
+    updateUI();
 }
 
 void MainWindow::onRemoveProfile() {
-    int currentIndex = m_profileComboBox->currentIndex();
-    if (currentIndex >= 0 && m_configManager->getProfiles().size() > 1) {
+    int currentIndex = currentProfileIndex();
+    if (currentIndex >= 0 && m_configManager->profileCount() > 1) {
         QMessageBox::StandardButton reply = QMessageBox::question(this,
             "Remove Profile", "Are you sure you want to remove this profile?",
             QMessageBox::Yes | QMessageBox::No);
 
         if (reply == QMessageBox::Yes) {
-            m_configManager->removeProfile(currentIndex);
-            updateProfileList();
+            if (currentIndex == m_runningProfileIndex) {
+                m_keySimulator->stopSimulation();
+                m_runningProfileIndex = -1;
+            } else if (currentIndex < m_runningProfileIndex) {
+                --m_runningProfileIndex;
+            }
+
+            {
+                QSignalBlocker blocker(m_profileComboBox);
+                m_profileModel->removeProfile(currentIndex);
+            }
+            m_planCache.removeAt(currentIndex);
+            updateUI();
+            applyHotkeys();  // Profile hotkeys moved up with their profiles
         }
     } else {
         QMessageBox::information(this, "Cannot Remove",
@@ -446,68 +736,85 @@ void MainWindow::onEditProfile() {
 }
 
 void MainWindow::onDuplicateProfile() {
-    int currentIndex = m_profileComboBox->currentIndex();
+    int currentIndex = currentProfileIndex();
     if (currentIndex >= 0) {
-        ClassProfile currentProfile = m_configManager->getProfiles()[currentIndex];
+        ClassProfile currentProfile = m_configManager->profileAt(currentIndex);
         currentProfile.setName(currentProfile.getName() + " (Copy)");
-        m_configManager->addProfile(currentProfile);
-        m_configManager->setCurrentProfileIndex(m_configManager->getProfiles().size() - 1);
-        updateProfileList();
+        {
+            QSignalBlocker blocker(m_profileComboBox);
+            m_profileModel->appendProfile(currentProfile);
+        }
+        m_configManager->setCurrentProfileIndex(m_configManager->profileCount() - 1);
+        updateUI();
+    }
+}
+
+void MainWindow::onUndo() {
+    if (m_configManager->undo()) {
+        restoreProfiles();
+    }
+}
+
+void MainWindow::onRedo() {
+    if (m_configManager->redo()) {
+        restoreProfiles();
+    }
+}
+
+void MainWindow::restoreProfiles() {
+    reloadProfiles();
+    syncRunningSimulation();
+    autoSaveConfiguration();
+}
+
+void MainWindow::onRateBudgetEdited() {
+    const int profileIndex = currentProfileIndex();
+    if (profileIndex < 0) {
+        return;
     }
+
+    ClassProfile profile = m_configManager->profileAt(profileIndex);
+    profile.setRateLimit(m_rateLimitSpinBox->value());
+    profile.setRateBurst(m_rateBurstSpinBox->value());
+    m_rateBurstSpinBox->setEnabled(profile.getRateLimit() > 0.0);
+    m_configManager->updateProfile(profileIndex, profile);
+
+    m_profileModel->profileChanged(profileIndex);
+    syncRunningSimulation();
+    autoSaveConfiguration();
 }
 
 // Action management slots
 void MainWindow::onAddAction() {
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-    if (currentProfileIndex >= 0) {
+    if (m_actionModel->profileIndex() >= 0) {
         KeyAction newAction(InputType::Keyboard, 0x32, 200); // Default: Key '2', 200ms
-
-        auto profiles = m_configManager->getProfiles();
-        profiles[currentProfileIndex].addAction(newAction);
-        m_configManager->setProfiles(profiles);
-
-        updateActionList();
-        autoSaveConfiguration();
+        m_actionModel->appendAction(newAction);
     }
 }
 
 void MainWindow::onRemoveAction() {
-    int currentRow = m_actionsTable->currentRow();
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-
-    if (currentRow >= 0 && currentProfileIndex >= 0) {
-        auto profiles = m_configManager->getProfiles();
-        profiles[currentProfileIndex].removeAction(currentRow);
-        m_configManager->setProfiles(profiles);
-
-        updateActionList();
-        autoSaveConfiguration();
+    int currentRow = currentActionRow();
+    if (currentRow >= 0) {
+        m_actionModel->removeAction(currentRow);
     }
 }
 
 void MainWindow::onEditAction() {
-    int currentRow = m_actionsTable->currentRow();
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-
-    if (currentRow >= 0 && currentProfileIndex >= 0) {
-        auto profiles = m_configManager->getProfiles();
-        if (currentProfileIndex < profiles.size()) {
-            const auto &actions = profiles[currentProfileIndex].getActions();
-            if (currentRow < actions.size()) {
-                KeyAction currentAction = actions[currentRow];
-
-                ActionEditDialog dialog(currentAction, this);
-                if (dialog.exec() == QDialog::Accepted) {
-                    KeyAction editedAction = dialog.getAction();
-                    profiles[currentProfileIndex].updateAction(currentRow, editedAction);
-                    m_configManager->setProfiles(profiles);
-
-                    updateActionList();
-                    autoSaveConfiguration();
-                }
-            }
-        }
+    int currentRow = currentActionRow();
+    if (currentRow < 0) {
+        return;
     }
+
+    const ActionList &siblings = m_configManager->profileAt(m_actionModel->profileIndex()).actions();
+    ActionEditDialog dialog(m_actionModel->actionAt(currentRow), siblings, currentRow, this);
+    if (dialog.exec() == QDialog::Accepted) {
+        m_actionModel->replaceAction(currentRow, dialog.getAction());
+    }
+}
+
+int MainWindow::currentActionRow() const {
+    QModelIndex current = m_actionsTable->currentIndex();
+    return current.isValid() ? current.row() : -1;
 }
 
 void MainWindow::onActionSelectionChanged() {
@@ -515,76 +822,41 @@ void MainWindow::onActionSelectionChanged() {
         return;
     }
 
-    bool hasSelection = m_actionsTable->currentRow() >= 0;
+    bool hasSelection = currentActionRow() >= 0;
     m_removeActionButton->setEnabled(hasSelection);
     m_editActionButton->setEnabled(hasSelection);
 }
 
-void MainWindow::onActionTableItemChanged(QTableWidgetItem *item) {
-    if (!item) return;
-
-    int row = item->row();
-    int column = item->column();
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-
-    if (currentProfileIndex < 0) return;
-
-    auto profiles = m_configManager->getProfiles();
-    if (currentProfileIndex >= profiles.size()) return;
-
-    auto actions = profiles[currentProfileIndex].getActions();
-    if (row >= actions.size()) return;
-
-    KeyAction action = actions[row];
-    bool changed = false;
-
-    // Handle different columns
-    if (column == 2) { // Interval column
-        bool ok;
-        int newInterval = item->text().toInt(&ok);
-        if (ok && newInterval >= 100 && newInterval <= 60000) {
-            action.interval = newInterval;
-            changed = true;
-        } else {
-            // Revert to original value if invalid
-            item->setText(QString::number(action.interval));
-            QMessageBox::warning(this, "Invalid Interval",
-                "Interval must be between 100 and 60000 milliseconds.");
-        }
-    } else if (column == 3) { // Weight column
-        bool ok;
-        int newWeight = item->text().toInt(&ok);
-        if (ok && newWeight >= 1 && newWeight <= 100) {
-            action.weight = newWeight;
-            changed = true;
-        } else {
-            // Revert to original value if invalid
-            item->setText(QString::number(action.weight));
-            QMessageBox::warning(this, "Invalid Weight",
-                "Weight must be between 1 and 100.");
-        }
-    } else if (column == 5) { // Enabled column (moved to column 5)
-        action.enabled = (item->checkState() == Qt::Checked);
-        changed = true;
-    }
+void MainWindow::onActionsEdited() {
+    m_profileModel->profileChanged(m_actionModel->profileIndex());
+    syncRunningSimulation();
+    autoSaveConfiguration();
+}
 
-    if (changed) {
-        profiles[currentProfileIndex].updateAction(row, action);
-        m_configManager->setProfiles(profiles);
-        autoSaveConfiguration();
-    }
+void MainWindow::onActionEditRejected(const QString &title, const QString &message) {
+    QMessageBox::warning(this, title, message);
 }
 
 // Simulation control slots
 void MainWindow::onStartSimulation() {
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-    if (currentProfileIndex >= 0) {
+    startProfile(currentProfileIndex());
+}
+
+void MainWindow::startProfile(int profileIndex) {
+    if (profileIndex >= 0) {
         const auto &profiles = m_configManager->getProfiles();
-        if (currentProfileIndex < profiles.size()) {
-            const ClassProfile &profile = profiles[currentProfileIndex];
-            if (profile.isEnabled() && !profile.getActions().isEmpty()) {
-                // Always use smart simulation
-                m_keySimulator->startSimulation(profile);
+        if (profileIndex < profiles.size()) {
+            const ClassProfile &profile = profiles[profileIndex];
+            if (profile.isEnabled() && !profile.actions().isEmpty()) {
+                // Replay and simulation would both be sending input
+                if (m_replayAction->isChecked()) {
+                    m_replayAction->setChecked(false);
+                }
+                // Always use smart simulation. A running engine switches to
+                // the cached plan at its next tick and keeps its cooldowns.
+                m_runningProfileIndex = profileIndex;
+                m_runningProfileName = profile.getName();
+                m_keySimulator->startSimulation(m_planCache.plan(profileIndex, profile));
             } else {
                 QMessageBox::warning(this, "Cannot Start",
                     "Profile is disabled or has no actions configured.");
@@ -595,6 +867,9 @@ void MainWindow::onStartSimulation() {
 
 void MainWindow::onStopSimulation() {
     m_keySimulator->stopSimulation();
+    if (m_replayAction->isChecked()) {
+        m_replayAction->setChecked(false);
+    }
 }
 
 void MainWindow::onSimulationStarted() {
@@ -602,8 +877,23 @@ void MainWindow::onSimulationStarted() {
     m_startButton->setEnabled(false);
     m_stopButton->setEnabled(true);
 
-    // Update status
-    m_statusLabel->setText("Smart simulation running...");
+    updateStatusBar();
+    m_timelineWidget->clear();
+    m_timelineWidget->setActive(true);
+    m_logModel->setActive(true);
+
+    // One file per run in the sessions folder, for --trace-session. Only
+    // the newest runs are kept.
+    const QString sessionDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sessions";
+    QDir().mkpath(sessionDir);
+    SessionLog::prune(sessionDir, SessionLog::KeptSessions - 1);
+    const QString sessionFile = sessionDir + "/session-"
+        + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".aksession";
+    QString error;
+    if (!m_sessionLog->start(m_keySimulator->sessionEvents(), sessionFile, &error)) {
+        qWarning() << "Session log not written to" << sessionFile << ":" << error;
+        m_sessionLog->start(m_keySimulator->sessionEvents(), QString(), nullptr);
+    }
 
     if (m_trayIcon) {
         m_trayIcon->showMessage("AutoKey", "Smart simulation started",
@@ -616,6 +906,15 @@ void MainWindow::onSimulationStopped() {
     m_startButton->setEnabled(true);
     m_stopButton->setEnabled(false);
     m_statusLabel->setText("Simulation stopped");
+    m_timelineWidget->setActive(false);
+    m_logModel->setActive(false);
+    if (m_logModel->droppedEvents() > 0) {
+        qDebug() << "Engine log dropped" << m_logModel->droppedEvents() << "events";
+    }
+    m_sessionLog->stop();
+    if (m_sessionLog->hasWriteError()) {
+        qWarning() << "Session log could not be written completely";
+    }
 
     if (m_trayIcon) {
         m_trayIcon->showMessage("AutoKey", "Simulation stopped",
@@ -665,18 +964,174 @@ void MainWindow::onSaveConfiguration() {
 
 void MainWindow::onLoadConfiguration() {
     QString fileName = QFileDialog::getOpenFileName(this,
-        "Load Configuration", "config.json", "JSON Files (*.json)");
+        "Load Configuration", "config.json",
+        "Configurations (*.json *.akpack);;JSON Files (*.json);;Profile Packs (*.akpack)");
 
     if (!fileName.isEmpty()) {
-        if (m_configManager->loadConfiguration(fileName)) {
-            updateUI();
-            QMessageBox::information(this, "Success", "Configuration loaded successfully.");
+        startImport(fileName, true);
+    }
+}
+
+void MainWindow::onImportProfiles() {
+    QString fileName = QFileDialog::getOpenFileName(this,
+        "Import Profiles", QString(),
+        "Profiles (*.akpack *.json);;Profile Packs (*.akpack);;JSON Files (*.json)");
+
+    if (!fileName.isEmpty()) {
+        startImport(fileName, false);
+    }
+}
+
+void MainWindow::onExportProfilePack() {
+    QString fileName = QFileDialog::getSaveFileName(this,
+        "Export Profile Pack", "profiles.akpack", "Profile Packs (*.akpack)");
+
+    if (!fileName.isEmpty()) {
+        if (m_configManager->exportPack(fileName)) {
+            QMessageBox::information(this, "Success", "Profile pack exported successfully.");
         } else {
-            QMessageBox::warning(this, "Error", "Failed to load configuration.");
+            QMessageBox::warning(this, "Error", "Failed to export profile pack.");
         }
     }
 }
 
+void MainWindow::startImport(const QString &filePath, bool replace) {
+    if (m_importer) {
+        QMessageBox::information(this, "Import", "An import is already in progress.");
+        return;
+    }
+
+    m_importReplaces = replace;
+    m_configManager->beginImport();
+
+    m_importThread = new QThread(this);
+    m_importer = new ProfileImporter(filePath);
+    m_importer->moveToThread(m_importThread);
+
+    connect(m_importThread, &QThread::started, m_importer, &ProfileImporter::run);
+    connect(m_importer, &ProfileImporter::profilesParsed, this, &MainWindow::onImportBatch);
+    connect(m_importer, &ProfileImporter::progressChanged, m_progressBar, &QProgressBar::setValue);
+    connect(m_importer, &ProfileImporter::finished, this, &MainWindow::onImportFinished);
+
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    m_progressBar->setVisible(true);
+    m_statusLabel->setText("Importing profiles...");
+
+    m_importThread->start();
+}
+
+void MainWindow::onCreateProfileFromTrace() {
+    if (m_traceWatcher) {
+        QMessageBox::information(this, "Create Profile", "A trace is already being analyzed.");
+        return;
+    }
+
+    const QString filePath = QFileDialog::getOpenFileName(this,
+        "Create Profile from Trace", QString(), "Input Traces (*.aktrace);;All Files (*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    m_progressBar->setVisible(true);
+    m_statusLabel->setText("Analyzing trace...");
+
+    // The analyzer reads the whole trace on a worker thread; progress is
+    // queued back to the progress bar
+    m_traceAnalyzer = std::make_shared<TraceAnalyzer>(KeySimulator::TickInterval);
+    auto error = std::make_shared<QString>();
+    std::shared_ptr<TraceAnalyzer> analyzer = m_traceAnalyzer;
+    QPointer<QProgressBar> progressBar = m_progressBar;
+    auto progress = [progressBar](int percent) {
+        QMetaObject::invokeMethod(progressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, percent));
+    };
+
+    m_traceWatcher = new QFutureWatcher<bool>(this);
+    connect(m_traceWatcher, &QFutureWatcher<bool>::finished, this, [this, filePath, error]() {
+        finishTraceAnalysis(filePath, m_traceWatcher->result(), *error);
+    });
+    m_traceWatcher->setFuture(QtConcurrent::run([analyzer, filePath, error, progress]() {
+        return analyzer->analyzeFile(filePath, error.get(), progress);
+    }));
+}
+
+void MainWindow::finishTraceAnalysis(const QString &filePath, bool success, const QString &errorString) {
+    m_traceWatcher->deleteLater();
+    m_traceWatcher = nullptr;
+    std::shared_ptr<TraceAnalyzer> analyzer = std::move(m_traceAnalyzer);
+
+    m_progressBar->setVisible(false);
+    updateStatusBar();
+
+    if (!success) {
+        QMessageBox::warning(this, "Error",
+            QString("Failed to analyze trace: %1").arg(errorString));
+        return;
+    }
+
+    ClassProfile profile = analyzer->profile(QFileInfo(filePath).completeBaseName());
+    if (profile.actions().isEmpty()) {
+        QMessageBox::information(this, "Create Profile",
+            QString("No key was pressed often enough in %1 input events to derive a profile.")
+                .arg(analyzer->eventCount()));
+        return;
+    }
+
+    {
+        QSignalBlocker blocker(m_profileComboBox);
+        m_profileModel->appendProfile(profile);
+    }
+    m_configManager->setCurrentProfileIndex(m_configManager->profileCount() - 1);
+    updateUI();
+    autoSaveConfiguration();
+
+    statusBar()->showMessage(QString("Created profile \"%1\" with %2 actions from %3 presses over %4 minutes")
+        .arg(profile.getName())
+        .arg(profile.actions().size())
+        .arg(analyzer->pressCount())
+        .arg(analyzer->activeUs() / 60e6, 0, 'f', 1), 10000);
+}
+
+void MainWindow::onImportBatch(const QList<ClassProfile> &batch) {
+    m_configManager->appendImportedProfiles(batch);
+    if (m_importer) {
+        m_importer->batchConsumed();
+    }
+}
+
+void MainWindow::onImportFinished(bool success, const QString &errorString, const QJsonObject &settings) {
+    // Batches are delivered before this slot, so the worker is done with them
+    m_importThread->quit();
+    m_importThread->wait();
+    delete m_importer;
+    m_importer = nullptr;
+    m_importThread->deleteLater();
+    m_importThread = nullptr;
+
+    m_progressBar->setVisible(false);
+    updateStatusBar();
+
+    if (!success) {
+        m_configManager->abortImport();
+        QMessageBox::warning(this, "Error",
+            QString("Failed to load configuration: %1").arg(errorString));
+        return;
+    }
+
+    m_configManager->commitImport(settings, m_importReplaces);
+    reloadProfiles();
+    syncRunningSimulation();
+
+    if (m_importReplaces) {
+        QMessageBox::information(this, "Success", "Configuration loaded successfully.");
+    } else {
+        autoSaveConfiguration();
+        QMessageBox::information(this, "Success", "Profiles imported successfully.");
+    }
+}
+
 void MainWindow::onResetToDefaults() {
     QMessageBox::StandardButton reply = QMessageBox::question(this,
         "Reset to Defaults", "Are you sure you want to reset all settings to defaults?",
@@ -684,27 +1139,368 @@ void MainWindow::onResetToDefaults() {
 
     if (reply == QMessageBox::Yes) {
         m_configManager->resetToDefaults();
-        updateUI();
+        restoreProfiles();
         QMessageBox::information(this, "Reset Complete", "Settings have been reset to defaults.");
     }
 }
 
+void MainWindow::onConfigFileChanged(const QString &path) {
+    // Editors that save by replacing the file drop it from the watcher
+    if (!m_configWatcher->files().contains(path) && QFile::exists(path)) {
+        m_configWatcher->addPath(path);
+    }
+
+    // While a snapshot is being written the file cannot be told apart from
+    // our own; it is checked again once the write has finished
+    if (m_autoSaveRunning) {
+        m_configChangedDuringSave = true;
+        return;
+    }
+    reloadExternalChanges(path);
+}
+
+void MainWindow::reloadExternalChanges(const QString &path) {
+    // Ignore notifications caused by our own auto-save
+    if (!m_configManager->hasExternalChanges(path)) {
+        return;
+    }
+
+    if (m_configManager->reloadConfiguration(path)) {
+        qDebug() << "External configuration change applied";
+        reloadProfiles();
+        syncRunningSimulation();
+    }
+}
+
 // Hotkey handling
-void MainWindow::onHotkeyPressed(int hotkeyId) {
-    qDebug() << "Processing hotkey ID:" << hotkeyId;
-    switch (hotkeyId) {
-    case 1: // Start hotkey
-        qDebug() << "F5 pressed - starting simulation";
+void MainWindow::onHotkeyCommand(HotkeyCommand command, int argument) {
+    switch (command) {
+    case HotkeyCommand::Start:
         onStartSimulation();
         break;
-    case 2: // Stop hotkey
-        qDebug() << "F6 pressed - stopping simulation";
+    case HotkeyCommand::Stop:
+        onStopSimulation();
+        break;
+    case HotkeyCommand::Pause:
+        m_keySimulator->setPaused(!m_keySimulator->isPaused());
+        break;
+    case HotkeyCommand::SwitchProfile:
+        if (argument < 0 || argument >= m_configManager->profileCount()) {
+            break;
+        }
+        // A running simulation moves over to the new profile. The engine
+        // goes first: updating the UI takes far longer than the switch.
+        if (m_isSimulationRunning && argument != m_runningProfileIndex) {
+            startProfile(argument);
+        }
+        selectProfile(argument);
+        m_configManager->setCurrentProfileIndex(argument);
+        updateUI();
+        break;
+    }
+}
+
+bool MainWindow::checkRunnableProfile(int index, ControlProtocol::Response *response) const {
+    if (index < 0 || index >= m_configManager->profileCount()) {
+        response->status = ControlProtocol::InvalidArgument;
+        response->message = QString("No profile %1").arg(index + 1);
+        return false;
+    }
+    // onStartSimulation() would show a message box instead
+    const ClassProfile &profile = m_configManager->profileAt(index);
+    if (!profile.isEnabled() || profile.actions().isEmpty()) {
+        response->status = ControlProtocol::Failed;
+        response->message = QString("Profile \"%1\" is disabled or has no actions").arg(profile.getName());
+        return false;
+    }
+    return true;
+}
+
+ControlProtocol::Response MainWindow::handleControlRequest(const ControlProtocol::Request &request) {
+    ControlProtocol::Response response;
+    switch (request.command) {
+    case ControlProtocol::Ping:
+        break;
+    case ControlProtocol::Activate:
+        showWindow();
+        break;
+    case ControlProtocol::Start: {
+        const int index = request.profile >= 0 ? request.profile : currentProfileIndex();
+        if (!checkRunnableProfile(index, &response)) {
+            break;
+        }
+        // Same as the profile hotkey followed by the start hotkey
+        if (index != currentProfileIndex()) {
+            onHotkeyCommand(HotkeyCommand::SwitchProfile, index);
+        }
+        if (!m_isSimulationRunning) {
+            onStartSimulation();
+        }
+        break;
+    }
+    case ControlProtocol::Stop:
         onStopSimulation();
         break;
+    case ControlProtocol::SwitchProfile:
+        if (request.profile < 0 || request.profile >= m_configManager->profileCount()) {
+            response.status = ControlProtocol::InvalidArgument;
+            response.message = QString("No profile %1").arg(request.profile + 1);
+        } else if (!m_isSimulationRunning || checkRunnableProfile(request.profile, &response)) {
+            // A running simulation moves over, so the profile must be runnable
+            onHotkeyCommand(HotkeyCommand::SwitchProfile, request.profile);
+        }
+        break;
+    case ControlProtocol::SetWeight: {
+        if (request.profile < 0 || request.profile >= m_configManager->profileCount()
+            || request.action < 0
+            || request.action >= m_configManager->profileAt(request.profile).actions().size()) {
+            response.status = ControlProtocol::InvalidArgument;
+            response.message = QString("No action %1 in profile %2").arg(request.action + 1).arg(request.profile + 1);
+            break;
+        }
+        if (request.value < 1 || request.value > 100) {
+            response.status = ControlProtocol::InvalidArgument;
+            response.message = "The weight must be between 1 and 100";
+            break;
+        }
+
+        KeyAction action = m_configManager->profileAt(request.profile).actions().at(request.action);
+        action.weight = request.value;
+        if (request.profile == m_actionModel->profileIndex()) {
+            // Updates the table; its actionsEdited() syncs and saves
+            m_actionModel->replaceAction(request.action, action);
+        } else {
+            m_configManager->updateAction(request.profile, request.action, action);
+            m_profileModel->profileChanged(request.profile);
+            syncRunningSimulation();
+            autoSaveConfiguration();
+        }
+        break;
+    }
+    case ControlProtocol::QueryStats: {
+        ControlProtocol::Stats &stats = response.stats;
+        const KeySimulator::BudgetStats budget = m_keySimulator->budgetStats();
+        stats.running = m_keySimulator->isRunning();
+        stats.paused = m_keySimulator->isPaused();
+        stats.targetActive = m_keySimulator->isTargetActive();
+        stats.profile = stats.running ? m_runningProfileIndex : -1;
+        stats.profileName = m_keySimulator->activeProfileName();
+        stats.presses = m_keySimulator->pressCount();
+        stats.throttled = budget.throttled;
+        stats.urgentPicks = budget.urgentPicks;
+        stats.plannedAhead = m_keySimulator->plannedAhead();
+        break;
+    }
+    case ControlProtocol::ListProfiles:
+        for (const ClassProfile &profile : m_configManager->getProfiles()) {
+            response.profiles.append(profile.getName());
+        }
+        break;
     default:
-        qDebug() << "Unknown hotkey ID:" << hotkeyId;
+        response.status = ControlProtocol::UnknownCommand;
+        response.message = "Unknown command";
         break;
     }
+    return response;
+}
+
+void MainWindow::onHotkeyEdited() {
+    QLineEdit *edit = qobject_cast<QLineEdit *>(sender());
+    QString current;
+    if (edit == m_startHotkeyEdit) {
+        current = m_configManager->getStartHotkey();
+    } else if (edit == m_stopHotkeyEdit) {
+        current = m_configManager->getStopHotkey();
+    } else if (edit == m_pauseHotkeyEdit) {
+        current = m_configManager->getPauseHotkey();
+    } else {
+        return;
+    }
+
+    QString hotkey;
+    if (!edit->text().trimmed().isEmpty()) {
+        QString error;
+        const HotkeyChord chord = HotkeyChord::parse(edit->text(), &error);
+        if (!chord.isValid()) {
+            // Restore first: the message box takes the focus, which finishes
+            // editing a second time
+            edit->setText(current);
+            QMessageBox::warning(this, "Invalid Hotkey", error);
+            return;
+        }
+        hotkey = chord.toString();
+    }
+
+    edit->setText(hotkey);
+    if (hotkey == current) {
+        return;
+    }
+
+    if (edit == m_startHotkeyEdit) {
+        m_configManager->setStartHotkey(hotkey);
+    } else if (edit == m_stopHotkeyEdit) {
+        m_configManager->setStopHotkey(hotkey);
+    } else {
+        m_configManager->setPauseHotkey(hotkey);
+    }
+    applyHotkeys();
+    autoSaveConfiguration();
+}
+
+void MainWindow::onProfileHotkeyEdited(QTableWidgetItem *item) {
+    const int profileIndex = item->row();
+    if (item->column() != 1 || profileIndex >= m_configManager->profileCount()) {
+        return;
+    }
+
+    const QString current = m_configManager->getProfileHotkey(profileIndex);
+    QString hotkey;
+    if (!item->text().trimmed().isEmpty()) {
+        QString error;
+        const HotkeyChord chord = HotkeyChord::parse(item->text(), &error);
+        if (!chord.isValid()) {
+            {
+                QSignalBlocker blocker(m_profileHotkeysTable);
+                item->setText(current);
+            }
+            QMessageBox::warning(this, "Invalid Hotkey", error);
+            return;
+        }
+        hotkey = chord.toString();
+    }
+
+    {
+        QSignalBlocker blocker(m_profileHotkeysTable);
+        item->setText(hotkey);
+    }
+    if (hotkey == current) {
+        return;
+    }
+
+    m_configManager->setProfileHotkey(profileIndex, hotkey);
+    applyHotkeys();
+    autoSaveConfiguration();
+}
+
+void MainWindow::applyHotkeys() {
+    QVector<HotkeyBinding> bindings;
+    QStringList problems;
+    auto bind = [&](const QString &text, HotkeyCommand command, int argument, const QString &label) {
+        if (text.trimmed().isEmpty()) {
+            return QString();
+        }
+        QString error;
+        const HotkeyChord chord = HotkeyChord::parse(text, &error);
+        if (!chord.isValid()) {
+            problems << QString("%1: %2").arg(label, error);
+            return QString();
+        }
+        bindings.append({chord, command, argument});
+        return chord.toString();
+    };
+
+    const QString start = bind(m_configManager->getStartHotkey(), HotkeyCommand::Start, 0, "Start");
+    const QString stop = bind(m_configManager->getStopHotkey(), HotkeyCommand::Stop, 0, "Stop");
+    bind(m_configManager->getPauseHotkey(), HotkeyCommand::Pause, 0, "Pause");
+    for (int i = 0; i < m_configManager->profileCount(); ++i) {
+        bind(m_configManager->getProfileHotkey(i), HotkeyCommand::SwitchProfile, i,
+             QString("Profile %1").arg(i + 1));
+    }
+
+    problems << m_hotkeyRegistry->setBindings(bindings);
+
+    // Show the hotkeys where the commands can also be clicked
+    auto withHotkey = [](const QString &label, const QString &hotkey) {
+        return hotkey.isEmpty() ? label : QString("%1 (%2)").arg(label, hotkey);
+    };
+    m_startButton->setText(withHotkey("Start", start));
+    m_stopButton->setText(withHotkey("Stop", stop));
+    m_startMenuAction->setText(withHotkey("&Start", start));
+    m_stopMenuAction->setText(withHotkey("S&top", stop));
+    if (m_trayIcon) {
+        m_startAction->setText(withHotkey("Start", start));
+        m_stopAction->setText(withHotkey("Stop", stop));
+    }
+    updateProfileHotkeys();
+
+    if (!problems.isEmpty()) {
+        QMessageBox::warning(this, "Hotkeys",
+            "Some hotkeys are not available. They may be invalid or in use by "
+            "another application.\n\n" + problems.join('\n'));
+    }
+}
+
+void MainWindow::onTargetWindowEdited() {
+    const QString target = m_targetWindowEdit->text().trimmed();
+    m_targetWindowEdit->setText(target);
+    if (target == m_configManager->getTargetWindow()) {
+        return;
+    }
+
+    m_configManager->setTargetWindow(target);
+    applyTargetWindow();
+    autoSaveConfiguration();
+}
+
+void MainWindow::applyTargetWindow() {
+    QString error;
+    if (!m_focusGate->setTarget(m_configManager->getTargetWindow(), &error)) {
+        // Not fatal: the engine simply keeps sending to any window
+        statusBar()->showMessage(QString("Target window ignored: %1").arg(error), 10000);
+    }
+    m_keySimulator->setTargetActive(m_focusGate->isTargetActive());
+    updateForegroundLabel();
+    updateStatusBar();
+}
+
+void MainWindow::onLookAheadToggled(bool enabled) {
+    // Safe while running: the next tick decides inline and the planner
+    // starts from there
+    m_configManager->setLookAhead(enabled);
+    m_keySimulator->setLookAhead(enabled);
+    autoSaveConfiguration();
+}
+
+void MainWindow::onTargetActiveChanged(bool active) {
+    // Reaches the engine straight from the watcher's notification; the
+    // engine timer is stopped or re-armed here, never polled
+    m_keySimulator->setTargetActive(active);
+    updateForegroundLabel();
+    updateStatusBar();
+}
+
+void MainWindow::updateForegroundLabel() {
+    if (!m_focusGate->isWatching()) {
+        m_foregroundLabel->setText("Keys are sent to whichever window has the focus");
+        return;
+    }
+
+    m_foregroundLabel->setText(QString("%1 (watched with %2)")
+        .arg(m_focusGate->isTargetActive() ? "Target window focused" : "Waiting for the target window")
+        .arg(m_focusGate->watcherName()));
+}
+
+void MainWindow::updateProfileHotkeys() {
+    QSignalBlocker blocker(m_profileHotkeysTable);
+    const int count = m_configManager->profileCount();
+    m_profileHotkeysTable->setRowCount(count);
+    for (int i = 0; i < count; ++i) {
+        QTableWidgetItem *nameItem = new QTableWidgetItem(m_configManager->profileAt(i).getName());
+        nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
+        m_profileHotkeysTable->setItem(i, 0, nameItem);
+        m_profileHotkeysTable->setItem(i, 1, new QTableWidgetItem(m_configManager->getProfileHotkey(i)));
+    }
+}
+
+void MainWindow::updateHotkeyLatency() {
+    const HotkeyRegistry::LatencyStats stats = m_hotkeyRegistry->latency();
+    m_hotkeyLatencyLabel->setText(
+        QString("Hotkey latency: last %1 ms, mean %2 ms, max %3 ms over %4 hotkeys (%5)")
+        .arg(stats.lastUs / 1000.0, 0, 'f', 2)
+        .arg(stats.meanUs / 1000.0, 0, 'f', 2)
+        .arg(stats.maxUs / 1000.0, 0, 'f', 2)
+        .arg(stats.count)
+        .arg(m_hotkeyRegistry->backendName()));
 }
 
 // UI update methods
@@ -713,92 +1509,50 @@ void MainWindow::updateProfileList() {
         return;
     }
 
-    // Temporarily disconnect the signal to avoid infinite recursion
-    disconnect(m_profileComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
-               this, &MainWindow::onProfileChanged);
+    // Rows are maintained by ProfileListModel; only the selection is synchronized
+    selectProfile(m_configManager->getCurrentProfileIndex());
+}
+
+void MainWindow::reloadProfiles() {
+    {
+        QSignalBlocker blocker(m_profileComboBox);
+        m_profileModel->reload();
+    }
+    m_planCache.refresh(m_configManager->getProfiles());
+    updateUI();
+    applyHotkeys();
+    applyTargetWindow();
+    m_keySimulator->setLookAhead(m_configManager->getLookAhead());
+}
 
-    m_profileComboBox->clear();
-    const auto &profiles = m_configManager->getProfiles();
-    for (const auto &profile : profiles) {
-        m_profileComboBox->addItem(profile.getName());
+int MainWindow::currentProfileIndex() const {
+    QModelIndex proxyIndex = m_profileFilterModel->index(m_profileComboBox->currentIndex(), 0);
+    if (!proxyIndex.isValid()) {
+        return -1;
     }
+    return m_profileFilterModel->mapToSource(proxyIndex).row();
+}
 
-    int currentIndex = m_configManager->getCurrentProfileIndex();
-    if (currentIndex >= 0 && currentIndex < profiles.size()) {
-        m_profileComboBox->setCurrentIndex(currentIndex);
+void MainWindow::selectProfile(int index) {
+    QModelIndex proxyIndex = m_profileFilterModel->mapFromSource(m_profileModel->index(index));
+    if (!proxyIndex.isValid() && !m_profileFilterEdit->text().isEmpty()) {
+        // The profile is hidden by the filter
+        QSignalBlocker blocker(m_profileFilterEdit);
+        m_profileFilterEdit->clear();
+        m_profileFilterModel->setFilterFixedString(QString());
+        proxyIndex = m_profileFilterModel->mapFromSource(m_profileModel->index(index));
     }
 
-    // Reconnect the signal
-    connect(m_profileComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
-            this, &MainWindow::onProfileChanged);
+    QSignalBlocker blocker(m_profileComboBox);
+    m_profileComboBox->setCurrentIndex(proxyIndex.isValid() ? proxyIndex.row() : -1);
 }
 
 void MainWindow::updateActionList() {
-    if (!m_actionsTable || !m_profileComboBox) {
+    if (!m_actionModel || !m_profileComboBox) {
         return;
     }
 
-    m_actionsTable->setRowCount(0);
-
-    int currentProfileIndex = m_profileComboBox->currentIndex();
-    if (currentProfileIndex >= 0) {
-        const auto &profiles = m_configManager->getProfiles();
-        if (currentProfileIndex < profiles.size()) {
-            const auto &actions = profiles[currentProfileIndex].getActions();
-
-            m_actionsTable->setRowCount(actions.size());
-            for (int i = 0; i < actions.size(); ++i) {
-                const auto &action = actions[i];
-
-                // Type column
-                QString typeStr;
-                switch (action.type) {
-                case InputType::Keyboard:
-                    typeStr = "Keyboard";
-                    break;
-                case InputType::MouseLeft:
-                    typeStr = "Mouse Left";
-                    break;
-                case InputType::MouseRight:
-                    typeStr = "Mouse Right";
-                    break;
-                }
-                m_actionsTable->setItem(i, 0, new QTableWidgetItem(typeStr));
-
-                // Key/Button column
-                QString keyStr;
-                if (action.type == InputType::Keyboard) {
-                    keyStr = QString("Key %1").arg(QChar(action.key));
-                } else {
-                    keyStr = "Click";
-                }
-                m_actionsTable->setItem(i, 1, new QTableWidgetItem(keyStr));
-
-                // Interval column - make it editable
-                QTableWidgetItem *intervalItem = new QTableWidgetItem(QString::number(action.interval));
-                intervalItem->setFlags(intervalItem->flags() | Qt::ItemIsEditable);
-                m_actionsTable->setItem(i, 2, intervalItem);
-
-                // Weight column - make it editable
-                QTableWidgetItem *weightItem = new QTableWidgetItem(QString::number(action.weight));
-                weightItem->setFlags(weightItem->flags() | Qt::ItemIsEditable);
-                m_actionsTable->setItem(i, 3, weightItem);
-
-                // Min/Max Interval column
-                QString intervalRange = QString("%1-%2ms").arg(action.minInterval).arg(action.maxInterval);
-                QTableWidgetItem *rangeItem = new QTableWidgetItem(intervalRange);
-                rangeItem->setFlags(rangeItem->flags() & ~Qt::ItemIsEditable); // Read-only
-                rangeItem->setToolTip("Edit in action dialog for detailed settings");
-                m_actionsTable->setItem(i, 4, rangeItem);
-
-                // Enabled column
-                QTableWidgetItem *enabledItem = new QTableWidgetItem();
-                enabledItem->setCheckState(action.enabled ? Qt::Checked : Qt::Unchecked);
-                enabledItem->setFlags(enabledItem->flags() | Qt::ItemIsUserCheckable);
-                m_actionsTable->setItem(i, 5, enabledItem);
-            }
-        }
-    }
+    m_actionModel->setProfileIndex(currentProfileIndex());
 }
 
 void MainWindow::updateUI() {
@@ -816,7 +1570,7 @@ void MainWindow::updateUI() {
     updateActionList();
 
     // Update profile details
-    int currentIndex = m_profileComboBox->currentIndex();
+    int currentIndex = currentProfileIndex();
     if (currentIndex >= 0) {
         const auto &profiles = m_configManager->getProfiles();
         if (currentIndex < profiles.size()) {
@@ -827,6 +1581,13 @@ void MainWindow::updateUI() {
             if (m_profileEnabledCheckBox) {
                 m_profileEnabledCheckBox->setChecked(profile.isEnabled());
             }
+            if (m_rateLimitSpinBox) {
+                QSignalBlocker limitBlocker(m_rateLimitSpinBox);
+                QSignalBlocker burstBlocker(m_rateBurstSpinBox);
+                m_rateLimitSpinBox->setValue(profile.getRateLimit());
+                m_rateBurstSpinBox->setValue(profile.getRateBurst());
+                m_rateBurstSpinBox->setEnabled(profile.getRateLimit() > 0.0);
+            }
         }
     }
 
@@ -837,12 +1598,31 @@ void MainWindow::updateUI() {
     if (m_stopHotkeyEdit) {
         m_stopHotkeyEdit->setText(m_configManager->getStopHotkey());
     }
+    if (m_pauseHotkeyEdit) {
+        m_pauseHotkeyEdit->setText(m_configManager->getPauseHotkey());
+    }
+    if (m_profileHotkeysTable && m_profileHotkeysTable->rowCount() != m_configManager->profileCount()) {
+        updateProfileHotkeys();  // Profiles were added
+    }
     if (m_minimizeToTrayCheckBox) {
         m_minimizeToTrayCheckBox->setChecked(m_configManager->getMinimizeToTray());
     }
     if (m_startMinimizedCheckBox) {
         m_startMinimizedCheckBox->setChecked(m_configManager->getStartMinimized());
     }
+    if (m_targetWindowEdit) {
+        m_targetWindowEdit->setText(m_configManager->getTargetWindow());
+    }
+    if (m_replaySpeedSpinBox) {
+        m_replaySpeedSpinBox->setValue(m_configManager->getReplaySpeed());
+    }
+    if (m_replayLoopCheckBox) {
+        m_replayLoopCheckBox->setChecked(m_configManager->getReplayLoop());
+    }
+    if (m_lookAheadCheckBox) {
+        QSignalBlocker blocker(m_lookAheadCheckBox);
+        m_lookAheadCheckBox->setChecked(m_configManager->getLookAhead());
+    }
 
     // Update button states
     if (m_startButton) {
@@ -853,56 +1633,111 @@ void MainWindow::updateUI() {
     }
 
     onActionSelectionChanged(); // Update action button states
+    updateUndoActions();
 }
 
 void MainWindow::updateStatusBar() {
-    if (m_isSimulationRunning) {
-        int currentIndex = m_profileComboBox->currentIndex();
-        if (currentIndex >= 0) {
-            const auto &profiles = m_configManager->getProfiles();
-            if (currentIndex < profiles.size()) {
-                const auto &profile = profiles[currentIndex];
-                m_statusLabel->setText(QString("Running: %1").arg(profile.getName()));
-            }
-        }
+    if (m_isSimulationRunning && !m_keySimulator->isPaused() && !m_keySimulator->isTargetActive()) {
+        m_statusLabel->setText(QString("Waiting for %1: %2")
+            .arg(m_configManager->getTargetWindow(), m_keySimulator->activeProfileName()));
+    } else if (m_isSimulationRunning) {
+        m_statusLabel->setText(QString(m_keySimulator->isPaused() ? "Paused: %1" : "Running: %1")
+            .arg(m_keySimulator->activeProfileName()));
     } else {
         m_statusLabel->setText("Ready");
     }
 }
 
 void MainWindow::autoSaveConfiguration() {
-    // Auto-save to the default configuration file
-    m_configManager->saveConfiguration(); // Uses default path
-    qDebug() << "Configuration auto-saved";
+    updateUndoActions();
+
+    // Edits made while a snapshot is being written go into the next one
+    if (m_autoSaveRunning) {
+        m_autoSavePending = true;
+        return;
+    }
+
+    // Auto-save to the default configuration file. The snapshot shares its
+    // profiles with the live state; serializing and writing it happen on a
+    // worker thread, so large configurations do not stall editing.
+    m_autoSaveRunning = true;
+    const ConfigManager::Snapshot snapshot = m_configManager->snapshot();
+    const QString configPath = m_configManager->getDefaultConfigPath();
+    m_autoSaveWatcher->setFuture(QtConcurrent::run([snapshot, configPath]() {
+        return ConfigManager::writeSnapshot(snapshot, configPath);
+    }));
 }
 
-// Event handlers
-void MainWindow::showEvent(QShowEvent *event) {
-    QMainWindow::showEvent(event);
+void MainWindow::onAutoSaveFinished() {
+    m_autoSaveRunning = false;
+    const QByteArray digest = m_autoSaveWatcher->result();
+    if (!digest.isEmpty()) {
+        m_configManager->markSynced(digest);
+        qDebug() << "Configuration auto-saved";
+    }
+
+    // The file may not have existed when the watcher was set up
+    QString configPath = m_configManager->getDefaultConfigPath();
+    if (!m_configWatcher->files().contains(configPath)) {
+        m_configWatcher->addPath(configPath);
+    }
+
+    // Edited by someone else while the snapshot was written; the watcher
+    // does not report it again
+    if (m_configChangedDuringSave) {
+        m_configChangedDuringSave = false;
+        reloadExternalChanges(configPath);
+    }
 
-    // Register global hotkeys after the window is shown
-    static bool hotkeysRegistered = false;
-    if (!hotkeysRegistered) {
-        // Use this window's handle directly for hotkey registration
-        HWND hwnd = reinterpret_cast<HWND>(this->winId());
+    if (m_autoSavePending) {
+        m_autoSavePending = false;
+        autoSaveConfiguration();
+    }
+}
 
-        // Register F5 as start hotkey (VK_F5 = 0x74)
-        bool f5Success = RegisterHotKey(hwnd, 1, 0, 0x74);
+void MainWindow::updateUndoActions() {
+    if (!m_undoAction) {
+        return;  // Menus not created yet
+    }
+    m_undoAction->setEnabled(m_configManager->canUndo());
+    m_redoAction->setEnabled(m_configManager->canRedo());
+}
 
-        // Register F6 as stop hotkey (VK_F6 = 0x75)
-        bool f6Success = RegisterHotKey(hwnd, 2, 0, 0x75);
+void MainWindow::syncRunningSimulation() {
+    const auto profiles = m_configManager->getProfiles();
+    m_planCache.refresh(profiles);
+    if (!m_isSimulationRunning || m_runningProfileIndex < 0) {
+        return;
+    }
 
-        if (f5Success && f6Success) {
-            hotkeysRegistered = true;
-            qDebug() << "Global hotkeys registered successfully";
-        } else {
-            QMessageBox::warning(this, "Warning",
-                "Failed to register global hotkeys F5/F6. "
-                "You may need to run the application as administrator.");
+    const int index = findRunningProfile(profiles);
+    if (index < 0) {
+        m_keySimulator->stopSimulation();
+        m_runningProfileIndex = -1;
+        statusBar()->showMessage(QString("Stopped: profile \"%1\" no longer exists")
+            .arg(m_runningProfileName), 10000);
+        return;
+    }
+    m_runningProfileIndex = index;
+    m_runningProfileName = profiles[index].getName();
+    m_keySimulator->publishPlan(m_planCache.plan(index, profiles[index]));
+}
+
+int MainWindow::findRunningProfile(const ProfileList &profiles) const {
+    // Where it was, unless a reload or an import moved other profiles there
+    if (m_runningProfileIndex < profiles.size()
+        && profiles[m_runningProfileIndex].getName() == m_runningProfileName) {
+        return m_runningProfileIndex;
+    }
+    for (int i = 0; i < profiles.size(); ++i) {
+        if (profiles[i].getName() == m_runningProfileName) {
+            return i;
         }
     }
+    return -1;
 }
 
+// Event handlers
 void MainWindow::closeEvent(QCloseEvent *event) {
     if (m_trayIcon && m_trayIcon->isVisible() && m_configManager->getMinimizeToTray()) {
         QMessageBox::information(this, "AutoKey",
@@ -912,62 +1747,124 @@ void MainWindow::closeEvent(QCloseEvent *event) {
         event->ignore();
     } else {
         m_keySimulator->stopSimulation();
+        m_autoSaveWatcher->waitForFinished();
         m_configManager->saveConfiguration();
         event->accept();
     }
 }
 
-bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, long *result) {
-    if (eventType == "windows_generic_MSG") {
-        MSG *msg = static_cast<MSG*>(message);
-        if (msg->message == WM_HOTKEY) {
-            int hotkeyId = msg->wParam;
-            qDebug() << "Hotkey received! ID:" << hotkeyId;
-            onHotkeyPressed(hotkeyId);
-            return true;
-        }
+void MainWindow::onPreviewSequence() {
+    SequencePreviewDialog dialog(m_configManager->getProfiles().toList(), currentProfileIndex(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
     }
 
-    return QMainWindow::nativeEvent(eventType, message, result);
+    // Start the previewed profile like the Start button would
+    int profileIndex = dialog.selectedProfileIndex();
+    if (profileIndex >= 0 && profileIndex < m_configManager->profileCount()) {
+        m_configManager->setCurrentProfileIndex(profileIndex);
+        updateUI();
+        onStartSimulation();
+    }
 }
 
-void MainWindow::onTestSmartSimulation() {
-    // Create a test profile with smart key actions
-    ClassProfile testProfile("Smart Test Profile");
+void MainWindow::onRecordToggled(bool checked) {
+    if (!checked) {
+        stopRecording();
+        return;
+    }
+
+    const QString fileName = QFileDialog::getSaveFileName(this,
+        "Record Input Session", "session.aktrace", "Input Traces (*.aktrace)");
+
+    QString error;
+    if (fileName.isEmpty()
+        || !m_traceRecorder->start(fileName, &error)
+        || !m_captureSource->start(m_traceRecorder, &error)) {
+        m_traceRecorder->stop();
+        QSignalBlocker blocker(m_recordAction);
+        m_recordAction->setChecked(false);
+        if (!error.isEmpty()) {
+            QMessageBox::warning(this, "Recording Failed", error);
+        }
+        return;
+    }
 
-    // Add test actions with different weights
-    KeyAction action1(InputType::Keyboard, 52, 1000, true, 80, 50, 300);   // 4 key - high weight
-    KeyAction action2(InputType::Keyboard, 49, 1000, true, 15, 2000, 5000); // 1 key - low weight
-    KeyAction action3(InputType::Keyboard, 50, 1000, true, 10, 3000, 8000); // 2 key - lowest weight
-    KeyAction action4(InputType::Keyboard, 51, 1000, true, 20, 1500, 4000); // 3 key - medium weight
+    m_recordAction->setText("Stop &Recording");
+    statusBar()->showMessage(QString("Recording input with %1 to %2")
+        .arg(m_captureSource->name(), fileName));
+}
 
-    testProfile.addAction(action1);
-    testProfile.addAction(action2);
-    testProfile.addAction(action3);
-    testProfile.addAction(action4);
+void MainWindow::stopRecording() {
+    if (!m_traceRecorder->isRecording()) {
+        return;
+    }
 
-    // Generate and show preview
-    QString preview = m_keySimulator->generateSequencePreview(testProfile, 50);
+    // The source first, so the recorder sees every captured event
+    m_captureSource->stop();
+    m_traceRecorder->stop();
+    m_recordAction->setText("&Record Input Session...");
 
-    // Show preview in a message box
-    QMessageBox msgBox;
-    msgBox.setWindowTitle("Smart Key Test");
-    msgBox.setText("Smart Key Sequence Preview:");
-    msgBox.setDetailedText(QString("Generated sequence (50 keys):\n%1\n\nProfile:\n- 4 key: weight 80, interval 50-300ms\n- 1 key: weight 15, interval 2000-5000ms\n- 2 key: weight 10, interval 3000-8000ms\n- 3 key: weight 20, interval 1500-4000ms").arg(preview));
-    msgBox.setStandardButtons(QMessageBox::Ok | QMessageBox::Apply);
-    msgBox.button(QMessageBox::Apply)->setText("Start Smart Simulation");
+    QString message = QString("Recorded %1 input events (%2 KiB)")
+        .arg(m_traceRecorder->eventCount())
+        .arg(m_traceRecorder->bytesWritten() / 1024);
+    if (m_traceRecorder->droppedEvents() > 0) {
+        message += QString(", %1 dropped").arg(m_traceRecorder->droppedEvents());
+    }
+    if (m_traceRecorder->hasWriteError()) {
+        message += ", write error";
+    }
+    statusBar()->showMessage(message, 10000);
+}
 
-    int result = msgBox.exec();
+void MainWindow::onReplayToggled(bool checked) {
+    if (!checked) {
+        // The result is reported by onReplayFinished()
+        m_traceReplayer->stop();
+        return;
+    }
 
-    if (result == QMessageBox::Apply) {
-        // Start smart simulation with test profile
-        if (m_isSimulationRunning) {
-            m_keySimulator->stopSimulation();
+    const QString fileName = QFileDialog::getOpenFileName(this,
+        "Replay Input Session", QString(), "Input Traces (*.aktrace);;All Files (*)");
+
+    m_configManager->setReplaySpeed(m_replaySpeedSpinBox->value());
+    m_configManager->setReplayLoop(m_replayLoopCheckBox->isChecked());
+    TraceReplayer::Options options;
+    options.speed = m_configManager->getReplaySpeed();
+    options.loops = m_configManager->getReplayLoop() ? 0 : 1;
+
+    QString error;
+    if (fileName.isEmpty() || !m_traceReplayer->start(fileName, options, &error)) {
+        QSignalBlocker blocker(m_replayAction);
+        m_replayAction->setChecked(false);
+        if (!error.isEmpty()) {
+            QMessageBox::warning(this, "Replay Failed", error);
         }
-
-        m_keySimulator->startSimulation(testProfile);
-        m_statusLabel->setText("Smart simulation running with test profile...");
+        return;
     }
+
+    m_keySimulator->stopSimulation();
+    m_replayAction->setText("Stop Re&play");
+    statusBar()->showMessage(QString("Replaying %1 at %2x").arg(fileName).arg(options.speed));
 }
 
+void MainWindow::onReplayFinished() {
+    // Queued from the replay thread; a newer replay may have started since
+    if (m_traceReplayer->isRunning()) {
+        return;
+    }
+    m_traceReplayer->stop();  // Releases the mapped file
+
+    {
+        QSignalBlocker blocker(m_replayAction);
+        m_replayAction->setChecked(false);
+    }
+    m_replayAction->setText("Re&play Input Session...");
 
+    const TraceReplayer::Stats stats = m_traceReplayer->stats();
+    QString message = "Replay finished: " + stats.summary();
+    if (!m_traceReplayer->errorString().isEmpty()) {
+        message += ", " + m_traceReplayer->errorString();
+    }
+    statusBar()->showMessage(message, 15000);
+}
@@ -8,8 +8,9 @@
 #include <QLabel>
 #include <QComboBox>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QCheckBox>
 #include <QGroupBox>
 #include <QVBoxLayout>
@@ -21,12 +22,35 @@
 #include <QTextEdit>
 #include <QProgressBar>
 #include <QTimer>
+#include <QFileSystemWatcher>
+#include <QThread>
+#include <QFutureWatcher>
 #include "configmanager.h"
 #include "keysimulator.h"
 #include "actioneditdialog.h"
+#include "profileimporter.h"
+#include "actiontablemodel.h"
+#include "profilelistmodel.h"
+#include "sequencepreviewdialog.h"
+#include "presstimelinewidget.h"
+#include "eventlogmodel.h"
+#include "wakeupmonitor.h"
+#include "hotkeyregistry.h"
+#include "tracerecorder.h"
+#include "inputcapture.h"
+#include "traceanalyzer.h"
+#include "tracereplayer.h"
+#include "focusgate.h"
+#include "controlserver.h"
+#include "plancache.h"
+#include "sessionlog.h"
 
 QT_BEGIN_NAMESPACE
 class QAction;
+class QSortFilterProxyModel;
+class QListView;
+class QTableWidget;
+class QTableWidgetItem;
 class QMenu;
 class QSystemTrayIcon;
 QT_END_NAMESPACE
@@ -40,8 +64,6 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
-    void showEvent(QShowEvent *event) override;
-    bool nativeEvent(const QByteArray &eventType, void *message, long *result) override;
 
 private slots:
     // Profile management
@@ -50,20 +72,27 @@ private slots:
     void onRemoveProfile();
     void onEditProfile();
     void onDuplicateProfile();
+    void onRateBudgetEdited();
+    void onUndo();
+    void onRedo();
     
     // Action management
     void onAddAction();
     void onRemoveAction();
     void onEditAction();
     void onActionSelectionChanged();
-    void onActionTableItemChanged(QTableWidgetItem *item);
+    void onActionsEdited();
+    void onActionEditRejected(const QString &title, const QString &message);
     
     // Simulation control
     void onStartSimulation();
     void onStopSimulation();
     void onSimulationStarted();
     void onSimulationStopped();
-    void onTestSmartSimulation();
+    void onPreviewSequence();
+    void onRecordToggled(bool checked);
+    void onReplayToggled(bool checked);
+    void onReplayFinished();
     
     // System tray
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
@@ -74,9 +103,24 @@ private slots:
     void onSaveConfiguration();
     void onLoadConfiguration();
     void onResetToDefaults();
+    void onConfigFileChanged(const QString &path);
+    void onAutoSaveFinished();
+    void onImportProfiles();
+    void onExportProfilePack();
+    void onCreateProfileFromTrace();
+    void onImportBatch(const QList<ClassProfile> &batch);
+    void onImportFinished(bool success, const QString &errorString, const QJsonObject &settings);
     
     // Hotkey handling
-    void onHotkeyPressed(int hotkeyId);
+    void onHotkeyCommand(HotkeyCommand command, int argument);
+    void onHotkeyEdited();
+    void onProfileHotkeyEdited(QTableWidgetItem *item);
+    void updateHotkeyLatency();
+    
+    // Target window gating
+    void onTargetWindowEdited();
+    void onTargetActiveChanged(bool active);
+    void onLookAheadToggled(bool enabled);
     
     // UI updates
     void updateProfileList();
@@ -84,6 +128,10 @@ private slots:
     void updateUI();
     void updateStatusBar();
     void autoSaveConfiguration();
+    void updateUndoActions();
+    // Shows the profiles after undo, redo or a reset replaced them, and
+    // applies and saves them
+    void restoreProfiles();
 
 private:
     void setupUI();
@@ -95,26 +143,73 @@ private:
     void createProfileTab();
     void createActionsTab();
     void createSettingsTab();
+    void createMonitorTab();
+    void onLogRowsInserted();
     void createAboutTab();
     
+    // Starts the profile, or switches a running engine over to it
+    void startProfile(int profileIndex);
+    // Recompiles edited profiles and pushes the running one into the engine
+    void syncRunningSimulation();
+    // Index of the running profile in the edited profiles, -1 if it is gone
+    int findRunningProfile(const ProfileList &profiles) const;
+    // Reloads the config file if it was changed outside the application
+    void reloadExternalChanges(const QString &path);
+    
+    void stopRecording();
+    
+    // Registers the configured hotkeys and shows them on buttons and menus
+    void applyHotkeys();
+    void updateProfileHotkeys();
+    // Points the focus gate at the configured target window
+    void applyTargetWindow();
+    void updateForegroundLabel();
+    
+    // Answers commands from the local control channel, e.g. autokeyctl
+    ControlProtocol::Response handleControlRequest(const ControlProtocol::Request &request);
+    // Whether a profile can run; sets a refusal on the response otherwise
+    bool checkRunnableProfile(int index, ControlProtocol::Response *response) const;
+    
+    // Streams a configuration or profile pack in on a worker thread
+    void startImport(const QString &filePath, bool replace);
+    void finishTraceAnalysis(const QString &filePath, bool success, const QString &errorString);
+    
+    int currentActionRow() const;
+    
+    // Profile index of the combo box selection, mapped through the filter
+    int currentProfileIndex() const;
+    void selectProfile(int index);
+    // Rebuilds the profile list after the whole configuration was replaced
+    void reloadProfiles();
+    
     // UI Components
     QTabWidget *m_tabWidget;
+    QWidget *m_aboutTab;
     
     // Profile tab
     QComboBox *m_profileComboBox;
+    ProfileListModel *m_profileModel;
+    QSortFilterProxyModel *m_profileFilterModel;
+    QLineEdit *m_profileFilterEdit;
     QPushButton *m_addProfileButton;
     QPushButton *m_removeProfileButton;
     QPushButton *m_editProfileButton;
     QPushButton *m_duplicateProfileButton;
     QLineEdit *m_profileNameEdit;
     QCheckBox *m_profileEnabledCheckBox;
+    QDoubleSpinBox *m_rateLimitSpinBox;
+    QSpinBox *m_rateBurstSpinBox;
     
     // Actions tab
-    QTableWidget *m_actionsTable;
+    QTableView *m_actionsTable;
+    ActionTableModel *m_actionModel;
     QPushButton *m_addActionButton;
     QPushButton *m_removeActionButton;
     QPushButton *m_editActionButton;
     
+    // Monitor tab
+    PressTimelineWidget *m_timelineWidget;
+    
     // Control buttons
     QPushButton *m_startButton;
     QPushButton *m_stopButton;
@@ -122,13 +217,24 @@ private:
     // Settings tab
     QLineEdit *m_startHotkeyEdit;
     QLineEdit *m_stopHotkeyEdit;
+    QLineEdit *m_pauseHotkeyEdit;
+    QTableWidget *m_profileHotkeysTable;
+    QLabel *m_hotkeyLatencyLabel;
     QCheckBox *m_minimizeToTrayCheckBox;
     QCheckBox *m_startMinimizedCheckBox;
+    QDoubleSpinBox *m_replaySpeedSpinBox;
+    QLineEdit *m_targetWindowEdit;
+    QLabel *m_foregroundLabel;
+    QCheckBox *m_replayLoopCheckBox;
+    QCheckBox *m_lookAheadCheckBox;
     
     // Status and info
     QLabel *m_statusLabel;
     QProgressBar *m_progressBar;
-    QTextEdit *m_logTextEdit;
+    QListView *m_logView;
+    EventLogModel *m_logModel;
+    QCheckBox *m_logFollowCheckBox;
+    QLabel *m_budgetLabel;
     
     // System tray
     QSystemTrayIcon *m_trayIcon;
@@ -138,14 +244,47 @@ private:
     QAction *m_quitAction;
     QAction *m_startAction;
     QAction *m_stopAction;
+    QAction *m_startMenuAction;
+    QAction *m_stopMenuAction;
+    QAction *m_recordAction;
+    QAction *m_replayAction;
+    QAction *m_undoAction;
+    QAction *m_redoAction;
     
     // Core components
     ConfigManager *m_configManager;
     KeySimulator *m_keySimulator;
+    HotkeyRegistry *m_hotkeyRegistry;
+    TraceRecorder *m_traceRecorder;
+    SessionLog *m_sessionLog;  // Every key sent while the simulation runs
+    InputCaptureSource *m_captureSource;  // nullptr where input cannot be captured
+    TraceReplayer *m_traceReplayer;
+    FocusGate *m_focusGate;
+    ControlServer *m_controlServer;
+    PlanCache m_planCache;
     
     // State
     bool m_isSimulationRunning;
-    QTimer *m_statusUpdateTimer;
+    int m_runningProfileIndex;   // -1 when running a profile not in the config
+    QString m_runningProfileName;  // Finds it again after a reload, an import or undo
+    WakeupMonitor *m_wakeupMonitor;
+    QLabel *m_wakeupLabel;
+    QFileSystemWatcher *m_configWatcher;
+    
+    // Background auto-save of configuration snapshots
+    QFutureWatcher<QByteArray> *m_autoSaveWatcher;
+    bool m_autoSaveRunning;   // Until its result has been recorded
+    bool m_autoSavePending;   // Edited while a snapshot was being written
+    bool m_configChangedDuringSave;  // File notification while a snapshot was being written
+    
+    // Background import
+    ProfileImporter *m_importer;
+    QThread *m_importThread;
+    bool m_importReplaces;
+    
+    // Background trace analysis, nullptr while none is running
+    QFutureWatcher<bool> *m_traceWatcher;
+    std::shared_ptr<TraceAnalyzer> m_traceAnalyzer;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,222 @@
+#ifndef PERSISTENTVECTOR_H
+#define PERSISTENTVECTOR_H
+
+#include <QList>
+#include <QtGlobal>
+#include <iterator>
+#include <memory>
+
+// Immutable sequence with structural sharing. Copies are O(1) and never
+// change; an edit builds a new version that shares every node but the
+// O(log n) ones on the path to the edited element, so keeping old versions
+// around (undo history, a snapshot being written) costs little memory.
+// Elements are held in a balanced binary tree (AVL) ordered by index.
+// Versions may be read from several threads at once.
+template <typename T>
+class PersistentVector {
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        Node(const T &value, NodePtr left, NodePtr right)
+            : value(value), left(std::move(left)), right(std::move(right))
+            , size(1 + sizeOf(this->left) + sizeOf(this->right))
+            , height(1 + qMax(heightOf(this->left), heightOf(this->right))) {}
+
+        T value;
+        NodePtr left;
+        NodePtr right;
+        int size;
+        int height;
+    };
+
+public:
+    PersistentVector() = default;
+    explicit PersistentVector(const QList<T> &values) : m_root(build(values, 0, values.size())) {}
+
+    int size() const { return sizeOf(m_root); }
+    bool isEmpty() const { return !m_root; }
+
+    // O(log n)
+    const T &at(int index) const {
+        Q_ASSERT_X(index >= 0 && index < size(), "PersistentVector::at", "index out of range");
+        const Node *node = m_root.get();
+        for (;;) {
+            const int leftSize = sizeOf(node->left);
+            if (index < leftSize) {
+                node = node->left.get();
+            } else if (index > leftSize) {
+                index -= leftSize + 1;
+                node = node->right.get();
+            } else {
+                return node->value;
+            }
+        }
+    }
+    const T &operator[](int index) const { return at(index); }
+    const T &first() const { return at(0); }
+    const T &last() const { return at(size() - 1); }
+
+    // Edits replace this version with a new one; copies keep the old one
+    void append(const T &value) { insert(size(), value); }
+    void insert(int index, const T &value) { m_root = insertAt(m_root, index, value); }
+    void replace(int index, const T &value) {
+        Q_ASSERT_X(index >= 0 && index < size(), "PersistentVector::replace", "index out of range");
+        m_root = replaceAt(m_root, index, value);
+    }
+    void removeAt(int index) {
+        Q_ASSERT_X(index >= 0 && index < size(), "PersistentVector::removeAt", "index out of range");
+        m_root = removeFrom(m_root, index);
+    }
+    void clear() { m_root.reset(); }
+
+    // True if both are the same version, without comparing elements
+    bool isSharedWith(const PersistentVector &other) const { return m_root == other.m_root; }
+
+    // Number of tree nodes the two versions do not share
+    int unsharedNodes(const PersistentVector &other) const {
+        return countUnshared(m_root, other.m_root);
+    }
+
+    QList<T> toList() const {
+        QList<T> values;
+        values.reserve(size());
+        forEach([&values](const T &value) { values.append(value); });
+        return values;
+    }
+
+    // In-order traversal, O(n)
+    template <typename Func>
+    void forEach(Func func) const { visit(m_root.get(), func); }
+
+    // Index-based, O(log n) per step; forEach() is cheaper for whole passes
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = int;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator(const PersistentVector *vector, int index) : m_vector(vector), m_index(index) {}
+        const T &operator*() const { return m_vector->at(m_index); }
+        const T *operator->() const { return &m_vector->at(m_index); }
+        const_iterator &operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+
+    private:
+        const PersistentVector *m_vector;
+        int m_index;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    static int sizeOf(const NodePtr &node) { return node ? node->size : 0; }
+    static int heightOf(const NodePtr &node) { return node ? node->height : 0; }
+
+    static NodePtr make(const T &value, NodePtr left, NodePtr right) {
+        return std::make_shared<Node>(value, std::move(left), std::move(right));
+    }
+
+    // Like make(), restoring the AVL invariant after one subtree changed
+    // height by at most one
+    static NodePtr balance(const T &value, NodePtr left, NodePtr right) {
+        const int leftHeight = heightOf(left);
+        const int rightHeight = heightOf(right);
+        if (leftHeight > rightHeight + 1) {
+            if (heightOf(left->left) >= heightOf(left->right)) {
+                return make(left->value, left->left, make(value, left->right, std::move(right)));
+            }
+            const Node *pivot = left->right.get();
+            return make(pivot->value, make(left->value, left->left, pivot->left),
+                        make(value, pivot->right, std::move(right)));
+        }
+        if (rightHeight > leftHeight + 1) {
+            if (heightOf(right->right) >= heightOf(right->left)) {
+                return make(right->value, make(value, std::move(left), right->left), right->right);
+            }
+            const Node *pivot = right->left.get();
+            return make(pivot->value, make(value, std::move(left), pivot->left),
+                        make(right->value, pivot->right, right->right));
+        }
+        return make(value, std::move(left), std::move(right));
+    }
+
+    static NodePtr build(const QList<T> &values, int begin, int end) {
+        if (begin >= end) {
+            return NodePtr();
+        }
+        const int middle = begin + (end - begin) / 2;
+        return make(values.at(middle), build(values, begin, middle), build(values, middle + 1, end));
+    }
+
+    static NodePtr insertAt(const NodePtr &node, int index, const T &value) {
+        if (!node) {
+            return make(value, NodePtr(), NodePtr());
+        }
+        const int leftSize = sizeOf(node->left);
+        if (index <= leftSize) {
+            return balance(node->value, insertAt(node->left, index, value), node->right);
+        }
+        return balance(node->value, node->left, insertAt(node->right, index - leftSize - 1, value));
+    }
+
+    static NodePtr replaceAt(const NodePtr &node, int index, const T &value) {
+        const int leftSize = sizeOf(node->left);
+        if (index < leftSize) {
+            return make(node->value, replaceAt(node->left, index, value), node->right);
+        }
+        if (index > leftSize) {
+            return make(node->value, node->left, replaceAt(node->right, index - leftSize - 1, value));
+        }
+        return make(value, node->left, node->right);
+    }
+
+    static NodePtr removeFrom(const NodePtr &node, int index) {
+        const int leftSize = sizeOf(node->left);
+        if (index < leftSize) {
+            return balance(node->value, removeFrom(node->left, index), node->right);
+        }
+        if (index > leftSize) {
+            return balance(node->value, node->left, removeFrom(node->right, index - leftSize - 1));
+        }
+        if (!node->left) {
+            return node->right;
+        }
+        if (!node->right) {
+            return node->left;
+        }
+        // The successor takes the removed element's place
+        const Node *successor = node->right.get();
+        while (successor->left) {
+            successor = successor->left.get();
+        }
+        return balance(successor->value, node->left, removeFrom(node->right, 0));
+    }
+
+    template <typename Func>
+    static void visit(const Node *node, Func &func) {
+        while (node) {
+            visit(node->left.get(), func);
+            func(node->value);
+            node = node->right.get();
+        }
+    }
+
+    static int countUnshared(const NodePtr &node, const NodePtr &other) {
+        if (!node || node == other) {
+            return 0;
+        }
+        // Compared by position: exact after replace(), an upper bound after
+        // inserts and removals moved subtrees around
+        const bool sameShape = other && sizeOf(node->left) == sizeOf(other->left);
+        return 1 + countUnshared(node->left, sameShape ? other->left : NodePtr())
+                 + countUnshared(node->right, sameShape ? other->right : NodePtr());
+    }
+
+    NodePtr m_root;
+};
+
+#endif // PERSISTENTVECTOR_H
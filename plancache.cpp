@@ -0,0 +1,46 @@
+#include "plancache.h"
+
+void PlanCache::refresh(const PersistentVector<ClassProfile> &profiles) {
+    m_entries.resize(profiles.size());
+    int index = 0;
+    profiles.forEach([this, &index](const ClassProfile &profile) {
+        Entry &entry = m_entries[index++];
+        if (!isCurrent(entry, profile)) {
+            compile(entry, profile);
+        }
+    });
+}
+
+ExecutionPlanPtr PlanCache::plan(int index, const ClassProfile &profile) {
+    if (index < 0) {
+        return ExecutionPlan::compile(profile);
+    }
+    if (index >= m_entries.size()) {
+        m_entries.resize(index + 1);
+    }
+
+    Entry &entry = m_entries[index];
+    if (!isCurrent(entry, profile)) {
+        compile(entry, profile);
+    }
+    return entry.plan;
+}
+
+bool PlanCache::isCurrent(const Entry &entry, const ClassProfile &profile) {
+    // Action lists are interned and immutable, so the same pointer means the
+    // same actions
+    return entry.plan
+        && entry.actions == profile.sharedActions()
+        && entry.rateLimit == profile.getRateLimit()
+        && entry.rateBurst == profile.getRateBurst()
+        && entry.name == profile.getName();
+}
+
+void PlanCache::compile(Entry &entry, const ClassProfile &profile) {
+    entry.actions = profile.sharedActions();
+    entry.name = profile.getName();
+    entry.rateLimit = profile.getRateLimit();
+    entry.rateBurst = profile.getRateBurst();
+    entry.plan = ExecutionPlan::compile(profile);
+    ++m_compileCount;
+}
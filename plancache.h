@@ -0,0 +1,52 @@
+#ifndef PLANCACHE_H
+#define PLANCACHE_H
+
+#include <QString>
+#include <QVector>
+#include "classprofile.h"
+#include "executionplan.h"
+#include "persistentvector.h"
+
+// Compiled execution plans of all profiles, so starting or switching to a
+// profile hands the engine a ready plan instead of compiling it first.
+// An entry remembers the action list, name and rate budget it was compiled
+// from; when the profile no longer matches, the plan is compiled again.
+class PlanCache {
+public:
+    PlanCache() : m_compileCount(0) {}
+
+    // Compiles the profiles whose plans are missing or out of date and drops
+    // the plans of removed profiles. Up-to-date entries cost a comparison.
+    void refresh(const PersistentVector<ClassProfile> &profiles);
+
+    // Plan of the profile at index, compiled on the spot if out of date
+    ExecutionPlanPtr plan(int index, const ClassProfile &profile);
+
+    // Keeps the plans of the following profiles when one is removed
+    void removeAt(int index) {
+        if (index >= 0 && index < m_entries.size()) {
+            m_entries.remove(index);
+        }
+    }
+    void clear() { m_entries.clear(); }
+    int size() const { return m_entries.size(); }
+    // Plans compiled since the cache was created
+    int compileCount() const { return m_compileCount; }
+
+private:
+    struct Entry {
+        SharedActionList actions;  // Held, so the pointer comparison stays valid
+        QString name;
+        double rateLimit = 0.0;
+        int rateBurst = 0;
+        ExecutionPlanPtr plan;
+    };
+
+    static bool isCurrent(const Entry &entry, const ClassProfile &profile);
+    void compile(Entry &entry, const ClassProfile &profile);
+
+    QVector<Entry> m_entries;
+    int m_compileCount;
+};
+
+#endif // PLANCACHE_H
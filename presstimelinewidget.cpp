@@ -0,0 +1,189 @@
+#include "presstimelinewidget.h"
+#include <QPainter>
+#include <QDateTime>
+#include <QGuiApplication>
+#include <QScreen>
+#include <cstring>
+
+PressTimelineWidget::PressTimelineWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_source(nullptr)
+    , m_frameTimer(new QTimer(this))
+    , m_active(false)
+    , m_history(HistorySize)
+    , m_historyHead(0)
+    , m_historyCount(0) {
+    std::memset(m_rowForKey, -1, sizeof(m_rowForKey));
+    m_rows.reserve(MaxRows);
+    m_batch.resize(HistorySize);
+
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &PressTimelineWidget::onFrame);
+    updateFrameInterval();
+
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(RowHeight * 4);
+}
+
+void PressTimelineWidget::setSource(EngineEventRing *ring) {
+    m_source = ring;
+}
+
+void PressTimelineWidget::setActive(bool active) {
+    m_active = active;
+    if (m_active) {
+        m_frameTimer->start();
+    } else {
+        // Pick up the presses of the last tick, then stop scheduling frames
+        onFrame();
+        m_frameTimer->stop();
+    }
+}
+
+void PressTimelineWidget::clear() {
+    m_historyHead = 0;
+    m_historyCount = 0;
+    m_rows.clear();
+    std::memset(m_rowForKey, -1, sizeof(m_rowForKey));
+    updateGeometry();
+    update();
+}
+
+QSize PressTimelineWidget::sizeHint() const {
+    return QSize(480, RowHeight * qMax(4, m_rows.size()) + RowHeight);
+}
+
+void PressTimelineWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    updateFrameInterval();
+}
+
+void PressTimelineWidget::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    updateFrameInterval();
+}
+
+void PressTimelineWidget::updateFrameInterval() {
+    // Draw at the display refresh rate while visible; when hidden, only
+    // drain often enough that the ring never overflows
+    int interval = HiddenDrainInterval;
+    if (isVisible()) {
+        qreal refreshRate = 60.0;
+        if (QScreen *screen = QGuiApplication::primaryScreen()) {
+            refreshRate = qMax<qreal>(screen->refreshRate(), 1.0);
+        }
+        interval = qMax(1, qRound(1000.0 / refreshRate));
+    }
+    m_frameTimer->setInterval(interval);
+}
+
+int PressTimelineWidget::rowForKey(int key) {
+    const int index = key & 0xFF;
+    if (m_rowForKey[index] >= 0) {
+        return m_rowForKey[index];
+    }
+
+    if (m_rows.size() >= MaxRows) {
+        // Out of rows: share the last one
+        return MaxRows - 1;
+    }
+
+    Row row;
+    row.label = (key >= 0x20 && key < 0x7F) ? QString("Key %1").arg(QChar(key))
+                                            : QString("0x%1").arg(key, 2, 16, QChar('0'));
+    row.color = QColor::fromHsv((m_rows.size() * 47) % 360, 170, 230);
+    row.count = 0;
+    row.offset = 0;
+    m_rows.append(row);
+    m_rowForKey[index] = static_cast<qint16>(m_rows.size() - 1);
+    updateGeometry();
+    return m_rows.size() - 1;
+}
+
+void PressTimelineWidget::onFrame() {
+    if (m_source) {
+        m_source->drain([this](const EngineEvent &event) {
+            if (event.type != EngineEvent::Press) {
+                return;
+            }
+            Press &press = m_history[m_historyHead];
+            press.timestamp = event.timestamp;
+            press.row = rowForKey(event.key);
+            m_historyHead = (m_historyHead + 1) % HistorySize;
+            m_historyCount = qMin(m_historyCount + 1, HistorySize);
+        });
+    }
+
+    if (isVisible() && m_historyCount > 0) {
+        update();
+    }
+}
+
+void PressTimelineWidget::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    const qint64 windowStart = QDateTime::currentMSecsSinceEpoch() - WindowMs;
+    const qreal plotWidth = qMax(1, width() - LabelWidth);
+    const qreal pixelsPerMs = plotWidth / WindowMs;
+    const int first = (m_historyHead - m_historyCount + HistorySize) % HistorySize;
+
+    // Count presses per row, then lay the rectangles out grouped by row so
+    // every row is a single drawRects() call
+    for (Row &row : m_rows) {
+        row.count = 0;
+    }
+    for (int n = 0; n < m_historyCount; ++n) {
+        const Press &press = m_history[(first + n) % HistorySize];
+        if (press.timestamp >= windowStart) {
+            ++m_rows[press.row].count;
+        }
+    }
+
+    int offset = 0;
+    for (Row &row : m_rows) {
+        row.offset = offset;
+        offset += row.count;
+        row.count = 0;
+    }
+
+    for (int n = 0; n < m_historyCount; ++n) {
+        const Press &press = m_history[(first + n) % HistorySize];
+        if (press.timestamp < windowStart) {
+            continue;
+        }
+        Row &row = m_rows[press.row];
+        const qreal x = LabelWidth + (press.timestamp - windowStart) * pixelsPerMs;
+        m_batch[row.offset + row.count++] = QRectF(x - 1.5, press.row * RowHeight + 3,
+                                                   3.0, RowHeight - 6);
+    }
+
+    // Grid lines every second
+    painter.setPen(palette().color(QPalette::Midlight));
+    for (int ms = 1000; ms < WindowMs; ms += 1000) {
+        const qreal x = LabelWidth + plotWidth - ms * pixelsPerMs;
+        painter.drawLine(QPointF(x, 0), QPointF(x, height()));
+    }
+
+    painter.setPen(Qt::NoPen);
+    for (int r = 0; r < m_rows.size(); ++r) {
+        const Row &row = m_rows[r];
+        painter.setBrush(row.color);
+        painter.drawRects(m_batch.data() + row.offset, row.count);
+    }
+
+    // Row labels with the number of presses in the window
+    painter.setPen(palette().color(QPalette::Text));
+    for (int r = 0; r < m_rows.size(); ++r) {
+        const QRect labelRect(4, r * RowHeight, LabelWidth - 8, RowHeight);
+        painter.drawText(labelRect, Qt::AlignLeft | Qt::AlignVCenter, m_rows[r].label);
+        painter.drawText(labelRect, Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(m_rows[r].count));
+    }
+
+    if (m_rows.isEmpty()) {
+        painter.drawText(rect(), Qt::AlignCenter, "No key presses yet");
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef PRESSTIMELINEWIDGET_H
+#define PRESSTIMELINEWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+#include <QColor>
+#include <vector>
+#include "engineevent.h"
+
+// Scrolling timeline of key presses, one row per key. Press events are read
+// from the engine's ring buffer once per display frame, so painting never
+// runs inside or delays executeAction(). History and paint buffers are
+// allocated up front; only a newly seen key adds a row.
+class PressTimelineWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit PressTimelineWidget(QWidget *parent = nullptr);
+
+    void setSource(EngineEventRing *ring);
+
+    // Frames are only scheduled while the engine is running
+    void setActive(bool active);
+    void clear();
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onFrame();
+
+private:
+    struct Press {
+        qint64 timestamp;
+        int row;
+    };
+
+    struct Row {
+        QString label;
+        QColor color;
+        int count;      // Presses inside the visible window, updated on paint
+        int offset;     // Start of this row's rectangles in m_batch
+    };
+
+    void updateFrameInterval();
+    int rowForKey(int key);
+
+    static const int HistorySize = 8192;
+    static const int MaxRows = 32;
+    static const int WindowMs = 10000;
+    static const int RowHeight = 18;
+    static const int LabelWidth = 90;
+    static const int HiddenDrainInterval = 10000;
+
+    EngineEventRing *m_source;
+    QTimer *m_frameTimer;
+    bool m_active;
+
+    // Circular press history, newest at m_historyHead - 1
+    std::vector<Press> m_history;
+    int m_historyHead;
+    int m_historyCount;
+
+    QVector<Row> m_rows;
+    qint16 m_rowForKey[256];
+
+    // Rectangles of one frame, grouped by row for batched drawRects()
+    std::vector<QRectF> m_batch;
+};
+
+#endif // PRESSTIMELINEWIDGET_H
@@ -0,0 +1,100 @@
+#include "profileimporter.h"
+#include "profilestreamreader.h"
+#include "profilepack.h"
+#include <QFile>
+#include <QDebug>
+
+ProfileImporter::ProfileImporter(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_batchSlots(MaxBatchesInFlight)
+    , m_cancelled(false) {
+    qRegisterMetaType<ClassProfile>();
+    qRegisterMetaType<QList<ClassProfile>>();
+}
+
+void ProfileImporter::batchConsumed() {
+    m_batchSlots.release();
+}
+
+void ProfileImporter::cancel() {
+    m_cancelled = true;
+    // Unblock a worker waiting for the GUI to consume a batch
+    m_batchSlots.release(MaxBatchesInFlight);
+}
+
+void ProfileImporter::emitBatch(QList<ClassProfile> &batch) {
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    m_batchSlots.acquire();
+    if (!m_cancelled) {
+        emit profilesParsed(batch);
+    }
+    batch.clear();
+}
+
+void ProfileImporter::run() {
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit finished(false, QString("Could not open %1").arg(m_filePath), QJsonObject());
+        return;
+    }
+
+    // Profile packs and JSON configurations share the import pipeline
+    const qint64 totalSize = qMax<qint64>(1, file.size());
+    if (ProfilePack::isPack(&file)) {
+        ProfilePackReader reader(&file);
+        readProfiles(reader, totalSize);
+    } else {
+        ProfileStreamReader reader(&file);
+        readProfiles(reader, totalSize);
+    }
+}
+
+template <typename Reader>
+void ProfileImporter::readProfiles(Reader &reader, qint64 totalSize) {
+    QList<ClassProfile> batch;
+    int lastPercent = -1;
+    int profileCount = 0;
+
+    ClassProfile profile;
+    int correctedCount = 0;
+    while (!m_cancelled && reader.readNextProfile(&profile)) {
+        if (!profile.validate()) {
+            ++correctedCount;
+        }
+        batch.append(profile);
+        ++profileCount;
+
+        if (batch.size() >= BatchSize) {
+            emitBatch(batch);
+        }
+
+        int percent = static_cast<int>(reader.bytesRead() * 100 / totalSize);
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            emit progressChanged(percent);
+        }
+    }
+
+    if (m_cancelled) {
+        emit finished(false, "Import cancelled", QJsonObject());
+        return;
+    }
+
+    if (reader.hasError()) {
+        qDebug() << "Import failed after" << profileCount << "profiles:" << reader.errorString();
+        emit finished(false, reader.errorString(), QJsonObject());
+        return;
+    }
+
+    emitBatch(batch);
+    emit progressChanged(100);
+    if (correctedCount > 0) {
+        qDebug() << correctedCount << "profiles had invalid action settings corrected";
+    }
+    qDebug() << "Imported" << profileCount << "profiles from:" << m_filePath;
+    emit finished(true, QString(), reader.settings());
+}
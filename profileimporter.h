@@ -0,0 +1,47 @@
+#ifndef PROFILEIMPORTER_H
+#define PROFILEIMPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <atomic>
+#include "classprofile.h"
+
+// Streams profiles out of a JSON configuration or *.akpack profile pack on a worker
+// thread. Profiles are handed to the GUI thread in small batches; at most
+// MaxBatchesInFlight batches are queued at once, so peak memory does not
+// grow with the size of the file.
+class ProfileImporter : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ProfileImporter(const QString &filePath, QObject *parent = nullptr);
+
+    // Must be called by the receiver once it has consumed a batch
+    void batchConsumed();
+    void cancel();
+
+public slots:
+    void run();
+
+signals:
+    void profilesParsed(const QList<ClassProfile> &batch);
+    void progressChanged(int percent);
+    void finished(bool success, const QString &errorString, const QJsonObject &settings);
+
+private:
+    static const int BatchSize = 64;
+    static const int MaxBatchesInFlight = 4;
+
+    void emitBatch(QList<ClassProfile> &batch);
+    template <typename Reader>
+    void readProfiles(Reader &reader, qint64 totalSize);
+
+    QString m_filePath;
+    QSemaphore m_batchSlots;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // PROFILEIMPORTER_H
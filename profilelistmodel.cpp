@@ -0,0 +1,55 @@
+#include "profilelistmodel.h"
+
+ProfileListModel::ProfileListModel(ConfigManager *configManager, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_configManager(configManager) {
+}
+
+void ProfileListModel::appendProfile(const ClassProfile &profile) {
+    const int row = m_configManager->profileCount();
+    beginInsertRows(QModelIndex(), row, row);
+    m_configManager->addProfile(profile);
+    endInsertRows();
+}
+
+void ProfileListModel::removeProfile(int row) {
+    if (row < 0 || row >= m_configManager->profileCount()) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_configManager->removeProfile(row);
+    endRemoveRows();
+}
+
+void ProfileListModel::profileChanged(int row) {
+    if (row >= 0 && row < m_configManager->profileCount()) {
+        emit dataChanged(index(row), index(row));
+    }
+}
+
+void ProfileListModel::reload() {
+    beginResetModel();
+    endResetModel();
+}
+
+int ProfileListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_configManager->profileCount();
+}
+
+QVariant ProfileListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_configManager->profileCount()) {
+        return QVariant();
+    }
+
+    const ClassProfile &profile = m_configManager->profileAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return profile.getName();
+    case Qt::ToolTipRole:
+        return QString("%1 actions").arg(profile.actions().size());
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef PROFILELISTMODEL_H
+#define PROFILELISTMODEL_H
+
+#include <QAbstractListModel>
+#include "configmanager.h"
+
+// List model over the profiles in ConfigManager, used by the profile
+// combo box. Adding or removing a profile inserts or removes one row
+// instead of repopulating the combo box.
+class ProfileListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit ProfileListModel(ConfigManager *configManager, QObject *parent = nullptr);
+
+    // Row operations, applied to ConfigManager
+    void appendProfile(const ClassProfile &profile);
+    void removeProfile(int row);
+    void profileChanged(int row);
+    // Re-reads all profiles after they were replaced outside the model
+    void reload();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    ConfigManager *m_configManager;
+};
+
+#endif // PROFILELISTMODEL_H
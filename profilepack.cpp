@@ -0,0 +1,221 @@
+#include "profilepack.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QtEndian>
+
+namespace {
+
+const int HeaderSize = 12;
+const int RecordHeaderSize = 9;
+
+struct Crc32Table {
+    quint32 entries[256];
+
+    Crc32Table() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+} // namespace
+
+quint32 ProfilePack::crc32(const QByteArray &data) {
+    static const Crc32Table table;
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (char byte : data) {
+        crc = table.entries[(crc ^ static_cast<quint8>(byte)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool ProfilePack::isPack(QIODevice *device) {
+    const QByteArray magic = device->peek(4);
+    return magic.size() == 4
+        && qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(magic.constData())) == Magic;
+}
+
+// ProfilePackWriter implementation
+ProfilePackWriter::ProfilePackWriter(QIODevice *device)
+    : m_device(device) {
+}
+
+bool ProfilePackWriter::write(const QJsonObject &settings, const QList<ClassProfile> &profiles) {
+    const QHash<const ActionList *, QString> refs = ClassProfile::sharedActionRefs(profiles);
+    const quint32 recordCount = 1 + refs.size() + profiles.size();
+
+    uchar header[HeaderSize];
+    qToBigEndian<quint32>(ProfilePack::Magic, header);
+    qToBigEndian<quint16>(ProfilePack::Version, header + 4);
+    qToBigEndian<quint16>(0, header + 6);
+    qToBigEndian<quint32>(recordCount, header + 8);
+    if (m_device->write(reinterpret_cast<const char *>(header), HeaderSize) != HeaderSize) {
+        m_errorString = m_device->errorString();
+        return false;
+    }
+
+    if (!writeRecord(ProfilePack::SettingsRecord, settings)) {
+        return false;
+    }
+
+    // Shared action lists are written right before their first user
+    QSet<QString> writtenLists;
+    for (const auto &profile : profiles) {
+        const ActionList *actions = profile.sharedActions().data();
+        const QString ref = refs.value(actions);
+
+        if (!ref.isEmpty() && !writtenLists.contains(ref)) {
+            QJsonObject list;
+            list["ref"] = ref;
+            list["actions"] = ClassProfile::actionsToJson(*actions);
+            if (!writeRecord(ProfilePack::ActionListRecord, list)) {
+                return false;
+            }
+            writtenLists.insert(ref);
+        }
+
+        if (!writeRecord(ProfilePack::ProfileRecord, profile.toJson(ref))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ProfilePackWriter::writeRecord(quint8 type, const QJsonObject &payload) {
+    const QByteArray compressed = qCompress(QJsonDocument(payload).toJson(QJsonDocument::Compact));
+
+    uchar recordHeader[RecordHeaderSize];
+    recordHeader[0] = type;
+    qToBigEndian<quint32>(static_cast<quint32>(compressed.size()), recordHeader + 1);
+    qToBigEndian<quint32>(ProfilePack::crc32(compressed), recordHeader + 5);
+
+    if (m_device->write(reinterpret_cast<const char *>(recordHeader), RecordHeaderSize) != RecordHeaderSize
+        || m_device->write(compressed) != compressed.size()) {
+        m_errorString = m_device->errorString();
+        return false;
+    }
+    return true;
+}
+
+// ProfilePackReader implementation
+ProfilePackReader::ProfilePackReader(QIODevice *device)
+    : m_device(device)
+    , m_bytesRead(0)
+    , m_headerRead(false)
+    , m_finished(false)
+    , m_recordCount(0)
+    , m_recordsRead(0) {
+}
+
+void ProfilePackReader::setError(const QString &message) {
+    if (m_errorString.isEmpty()) {
+        m_errorString = message;
+    }
+}
+
+bool ProfilePackReader::readExact(char *data, qint64 size) {
+    const qint64 read = m_device->read(data, size);
+    if (read != size) {
+        setError("Unexpected end of profile pack");
+        return false;
+    }
+    m_bytesRead += read;
+    return true;
+}
+
+bool ProfilePackReader::readHeader() {
+    uchar header[HeaderSize];
+    if (!readExact(reinterpret_cast<char *>(header), HeaderSize)) {
+        return false;
+    }
+
+    if (qFromBigEndian<quint32>(header) != ProfilePack::Magic) {
+        setError("Not a profile pack");
+        return false;
+    }
+
+    const quint16 version = qFromBigEndian<quint16>(header + 4);
+    if (version > ProfilePack::Version) {
+        setError(QString("Unsupported profile pack version %1").arg(version));
+        return false;
+    }
+
+    m_recordCount = qFromBigEndian<quint32>(header + 8);
+    m_headerRead = true;
+    return true;
+}
+
+bool ProfilePackReader::readRecord(quint8 *type, QJsonObject *payload) {
+    uchar recordHeader[RecordHeaderSize];
+    if (!readExact(reinterpret_cast<char *>(recordHeader), RecordHeaderSize)) {
+        return false;
+    }
+
+    *type = recordHeader[0];
+    const quint32 size = qFromBigEndian<quint32>(recordHeader + 1);
+    const quint32 checksum = qFromBigEndian<quint32>(recordHeader + 5);
+    if (size > MaxRecordSize) {
+        setError(QString("Record %1 is too large").arg(m_recordsRead + 1));
+        return false;
+    }
+
+    QByteArray compressed(static_cast<int>(size), Qt::Uninitialized);
+    if (!readExact(compressed.data(), size)) {
+        return false;
+    }
+
+    if (ProfilePack::crc32(compressed) != checksum) {
+        setError(QString("Checksum mismatch in record %1").arg(m_recordsRead + 1));
+        return false;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(qUncompress(compressed));
+    if (!doc.isObject()) {
+        setError(QString("Record %1 is corrupt").arg(m_recordsRead + 1));
+        return false;
+    }
+
+    *payload = doc.object();
+    ++m_recordsRead;
+    return true;
+}
+
+bool ProfilePackReader::readNextProfile(ClassProfile *profile) {
+    if (!m_headerRead && !readHeader()) {
+        return false;
+    }
+
+    while (!hasError() && m_recordsRead < m_recordCount) {
+        quint8 type = 0;
+        QJsonObject payload;
+        if (!readRecord(&type, &payload)) {
+            return false;
+        }
+
+        switch (type) {
+        case ProfilePack::SettingsRecord:
+            m_settings = payload;
+            break;
+        case ProfilePack::ActionListRecord:
+            m_actionLists.insert(payload["ref"].toString(),
+                ActionListPool::instance().intern(ClassProfile::actionsFromJson(payload["actions"].toArray())));
+            break;
+        case ProfilePack::ProfileRecord:
+            profile->fromJson(payload, m_actionLists);
+            return true;
+        default:
+            // Record types added by newer versions are skipped
+            break;
+        }
+    }
+
+    m_finished = !hasError();
+    return false;
+}
@@ -0,0 +1,87 @@
+#ifndef PROFILEPACK_H
+#define PROFILEPACK_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "classprofile.h"
+
+// Binary profile pack (*.akpack) for sharing profiles between machines.
+//
+// Layout (big-endian):
+//   header:  quint32 magic 'AKPK', quint16 version, quint16 reserved, quint32 recordCount
+//   record:  quint8 type, quint32 payloadSize, quint32 crc32, payload
+//
+// Each payload is compact JSON compressed with qCompress(). The CRC-32 covers
+// the compressed payload, so a damaged record is rejected before it is
+// decompressed. Action lists shared by several profiles are stored once in
+// an ActionList record that precedes the profiles referencing it.
+namespace ProfilePack {
+    const quint32 Magic = 0x414B504B; // "AKPK"
+    const quint16 Version = 1;
+
+    enum RecordType : quint8 {
+        SettingsRecord = 1,
+        ActionListRecord = 2,
+        ProfileRecord = 3
+    };
+
+    quint32 crc32(const QByteArray &data);
+
+    // True if the device starts with a pack header; does not consume data
+    bool isPack(QIODevice *device);
+}
+
+class ProfilePackWriter {
+public:
+    explicit ProfilePackWriter(QIODevice *device);
+
+    bool write(const QJsonObject &settings, const QList<ClassProfile> &profiles);
+    QString errorString() const { return m_errorString; }
+
+private:
+    bool writeRecord(quint8 type, const QJsonObject &payload);
+
+    QIODevice *m_device;
+    QString m_errorString;
+};
+
+// Reads a pack one record at a time, verifying and decompressing each record
+// as it is reached. Same interface as ProfileStreamReader.
+class ProfilePackReader {
+public:
+    explicit ProfilePackReader(QIODevice *device);
+
+    bool readNextProfile(ClassProfile *profile);
+
+    bool atEnd() const { return m_finished; }
+    bool hasError() const { return !m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+    qint64 bytesRead() const { return m_bytesRead; }
+    QJsonObject settings() const { return m_settings; }
+
+private:
+    bool readHeader();
+    bool readRecord(quint8 *type, QJsonObject *payload);
+    bool readExact(char *data, qint64 size);
+    void setError(const QString &message);
+
+    // Upper bound for a single record, protects against corrupt size fields
+    static const quint32 MaxRecordSize = 64 * 1024 * 1024;
+
+    QIODevice *m_device;
+    qint64 m_bytesRead;
+    bool m_headerRead;
+    bool m_finished;
+    quint32 m_recordCount;
+    quint32 m_recordsRead;
+
+    QJsonObject m_settings;
+    QHash<QString, SharedActionList> m_actionLists;
+    QString m_errorString;
+};
+
+#endif // PROFILEPACK_H
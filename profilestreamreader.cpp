@@ -0,0 +1,172 @@
+#include "profilestreamreader.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+ProfileStreamReader::ProfileStreamReader(QIODevice *device)
+    : m_device(device)
+    , m_position(0)
+    , m_bytesRead(0)
+    , m_depth(0)
+    , m_inString(false)
+    , m_escape(false)
+    , m_streamingProfiles(false)
+    , m_finished(false) {
+}
+
+bool ProfileStreamReader::fillBuffer() {
+    m_buffer = m_device->read(ChunkSize);
+    m_position = 0;
+    m_bytesRead += m_buffer.size();
+    return !m_buffer.isEmpty();
+}
+
+void ProfileStreamReader::setError(const QString &message) {
+    if (m_errorString.isEmpty()) {
+        m_errorString = message;
+    }
+}
+
+bool ProfileStreamReader::readNextProfile(ClassProfile *profile) {
+    while (!m_finished && !hasError()) {
+        if (m_position >= m_buffer.size() && !fillBuffer()) {
+            setError("Unexpected end of document");
+            return false;
+        }
+
+        const char c = m_buffer.at(m_position++);
+
+        if (m_inString) {
+            if (!m_streamingProfiles) {
+                m_member.append(c);
+            } else if (m_depth >= 3) {
+                m_profileText.append(c);
+            }
+
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '{':
+        case '[':
+            if (m_depth == 0) {
+                if (c != '{') {
+                    setError("Configuration root must be an object");
+                    return false;
+                }
+                m_depth = 1;
+                continue;
+            }
+
+            ++m_depth;
+            if (m_streamingProfiles && m_depth == 2) {
+                if (c != '[') {
+                    setError("\"profiles\" must be an array");
+                    return false;
+                }
+                continue;
+            }
+            break;
+
+        case '}':
+        case ']':
+            --m_depth;
+            if (m_depth == 0) {
+                finishMember();
+                m_finished = !hasError();
+                return false;
+            }
+
+            if (m_streamingProfiles) {
+                if (m_depth == 1) {
+                    // End of the profiles array
+                    continue;
+                }
+                if (m_depth == 2) {
+                    m_profileText.append(c);
+                    return finishProfile(profile);
+                }
+            }
+            break;
+
+        case ',':
+            if (m_depth == 1) {
+                finishMember();
+                continue;
+            }
+            break;
+
+        case ':':
+            if (m_depth == 1 && !m_streamingProfiles && m_member.trimmed() == "\"profiles\"") {
+                m_streamingProfiles = true;
+                m_member.clear();
+                continue;
+            }
+            break;
+
+        case '"':
+            m_inString = true;
+            break;
+
+        default:
+            break;
+        }
+
+        if (m_streamingProfiles) {
+            // Separators between profiles are dropped
+            if (m_depth >= 3) {
+                m_profileText.append(c);
+            }
+        } else if (m_depth >= 1) {
+            m_member.append(c);
+        }
+    }
+
+    return false;
+}
+
+void ProfileStreamReader::finishMember() {
+    m_streamingProfiles = false;
+
+    QByteArray member = m_member.trimmed();
+    m_member.clear();
+    if (member.isEmpty()) {
+        return;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson("{" + member + "}", &parseError);
+    if (!doc.isObject()) {
+        setError(QString("Invalid setting: %1").arg(parseError.errorString()));
+        return;
+    }
+
+    const QJsonObject obj = doc.object();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        if (it.key() == "actionLists") {
+            m_actionLists = ActionListPool::instance().decodeTable(it.value().toObject());
+        } else {
+            m_settings.insert(it.key(), it.value());
+        }
+    }
+}
+
+bool ProfileStreamReader::finishProfile(ClassProfile *profile) {
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(m_profileText, &parseError);
+    m_profileText.clear();
+
+    if (!doc.isObject()) {
+        setError(QString("Invalid profile: %1").arg(parseError.errorString()));
+        return false;
+    }
+
+    profile->fromJson(doc.object(), m_actionLists);
+    return true;
+}
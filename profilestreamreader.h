@@ -0,0 +1,61 @@
+#ifndef PROFILESTREAMREADER_H
+#define PROFILESTREAMREADER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QHash>
+#include "classprofile.h"
+
+// Incremental reader for configuration files and profile packs.
+// Scans the JSON text in fixed-size chunks and only materializes one
+// profile of the top-level "profiles" array at a time, so memory use is
+// bounded by the largest single profile instead of the file size.
+// Top-level members other than "profiles" are collected into settings(),
+// except the shared "actionLists" table, which is used to resolve the
+// "actionsRef" of profiles that follow it.
+class ProfileStreamReader {
+public:
+    explicit ProfileStreamReader(QIODevice *device);
+
+    // Reads up to the next complete profile. Returns false at the end of the
+    // document or on error; check hasError() to tell them apart.
+    bool readNextProfile(ClassProfile *profile);
+
+    bool atEnd() const { return m_finished; }
+    bool hasError() const { return !m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+    qint64 bytesRead() const { return m_bytesRead; }
+
+    // Top-level settings, complete once atEnd() is true
+    QJsonObject settings() const { return m_settings; }
+
+private:
+    bool fillBuffer();
+    void finishMember();
+    bool finishProfile(ClassProfile *profile);
+    void setError(const QString &message);
+
+    static const int ChunkSize = 64 * 1024;
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_position;
+    qint64 m_bytesRead;
+
+    // Scanner state
+    int m_depth;
+    bool m_inString;
+    bool m_escape;
+    bool m_streamingProfiles;
+    bool m_finished;
+
+    QByteArray m_member;        // Text of the current top-level member
+    QByteArray m_profileText;   // Text of the current profile object
+    QJsonObject m_settings;
+    QHash<QString, SharedActionList> m_actionLists;
+    QString m_errorString;
+};
+
+#endif // PROFILESTREAMREADER_H
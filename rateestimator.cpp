@@ -0,0 +1,262 @@
+#include "rateestimator.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+
+RateEstimator::RateEstimator(int tickInterval)
+    : m_tickInterval(tickInterval)
+    , m_iterations(0)
+    , m_solveTimeNs(0) {
+}
+
+void RateEstimator::setActions(const ActionList &actions) {
+    m_actions = actions;
+    m_groups.clear();
+    rebuildGroups();
+    solve();
+}
+
+void RateEstimator::updateAction(int index, const KeyAction &action) {
+    if (index < 0 || index >= m_actions.size()) {
+        return;
+    }
+
+    m_actions[index] = action;
+    rebuildGroups();
+    solve();
+}
+
+double RateEstimator::ratePerMinute(int index) const {
+    return index >= 0 && index < m_rates.size() ? m_rates[index] : 0.0;
+}
+
+void RateEstimator::rebuildGroups() {
+    // Keep the previous solution of every key as the starting point
+    QHash<int, Group> previous;
+    for (const Group &group : m_groups) {
+        previous.insert(group.key, group);
+    }
+    m_groups.clear();
+
+    QHash<int, int> groupForKey;
+    for (int i = 0; i < m_actions.size(); ++i) {
+        const KeyAction &action = m_actions[i];
+        if (!action.enabled || action.type != InputType::Keyboard || action.key <= 0) {
+            continue;
+        }
+
+        auto it = groupForKey.find(action.key);
+        if (it == groupForKey.end()) {
+            Group group;
+            group.key = action.key;
+            group.available = 1.0;
+            group.entries = 0.0;
+            group.rate = 0.0;
+            it = groupForKey.insert(action.key, m_groups.size());
+            m_groups.append(group);
+        }
+
+        // Same pool size as ExecutionPlan
+        Member member;
+        member.action = i;
+        member.entries = qMax(1, action.weight * action.weight / 100);
+        member.cooldown = qMax(0, action.minInterval);
+        m_groups[it.value()].members.append(member);
+    }
+
+    for (Group &group : m_groups) {
+        std::sort(group.members.begin(), group.members.end(),
+                  [](const Member &a, const Member &b) { return a.cooldown < b.cooldown; });
+
+        auto it = previous.constFind(group.key);
+        if (it != previous.constEnd()) {
+            group.available = it->available;
+            group.entries = it->entries;
+        } else {
+            for (const Member &member : group.members) {
+                group.entries += member.entries;
+            }
+        }
+    }
+}
+
+void RateEstimator::buildDistribution() {
+    int total = 0;
+    for (const Group &group : m_groups) {
+        total += qMax(1, qRound(group.entries));
+    }
+
+    m_distribution.assign(total + 1, 0.0);
+    m_distribution[0] = 1.0;
+    for (const Group &group : m_groups) {
+        const int entries = qMax(1, qRound(group.entries));
+        const double p = group.available;
+        for (int x = total; x >= entries; --x) {
+            m_distribution[x] = (1.0 - p) * m_distribution[x] + p * m_distribution[x - entries];
+        }
+        for (int x = qMin(entries, total + 1) - 1; x >= 0; --x) {
+            m_distribution[x] *= 1.0 - p;
+        }
+    }
+}
+
+void RateEstimator::removeFromDistribution(const Group &group) {
+    // Divides one group's Bernoulli term out of the distribution, solving
+    // from the side that stays numerically stable for its probability
+    const int size = static_cast<int>(m_distribution.size());
+    const int entries = qMax(1, qRound(group.entries));
+    const double p = group.available;
+    m_others.assign(size, 0.0);
+
+    if (p < 0.5) {
+        for (int x = 0; x < size; ++x) {
+            const double shifted = x >= entries ? p * m_others[x - entries] : 0.0;
+            m_others[x] = (m_distribution[x] - shifted) / (1.0 - p);
+        }
+    } else {
+        for (int x = size - 1; x >= 0; --x) {
+            const double above = x + entries < size ? m_distribution[x + entries] : 0.0;
+            const double kept = x + entries < size ? (1.0 - p) * m_others[x + entries] : 0.0;
+            m_others[x] = (above - kept) / p;
+        }
+    }
+}
+
+double RateEstimator::winProbability(int entries) const {
+    // Expected share of the pool the group holds at a tick
+    double q = 0.0;
+    for (int x = 0; x < static_cast<int>(m_others.size()); ++x) {
+        if (m_others[x] > 1e-12) {
+            q += m_others[x] * entries / (entries + x);
+        }
+    }
+    return qBound(0.0, q, 1.0);
+}
+
+void RateEstimator::solve() {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_rates.fill(0.0, m_actions.size());
+    m_shares.fill(0.0, m_actions.size());
+
+    QVector<double> availableTicks(m_groups.size());
+    QVector<double> availableEntries(m_groups.size());
+    const double tick = m_tickInterval;
+
+    m_iterations = 0;
+    while (!m_groups.isEmpty() && m_iterations < MaxIterations) {
+        ++m_iterations;
+        buildDistribution();
+
+        for (int g = 0; g < m_groups.size(); ++g) {
+            Group &group = m_groups[g];
+            removeFromDistribution(group);
+
+            // Ticks after a press of this group, starting once its first
+            // member is ready. Between two members becoming ready the chance
+            // of winning a tick is constant, so each stretch is a geometric
+            // series with a closed form.
+            const QVector<Member> &members = group.members;
+            const double firstTick = qMax<double>(tick, members[0].cooldown);
+            double survival = 1.0;
+            double cycle = 0.0;
+            availableTicks[g] = 0.0;
+            availableEntries[g] = 0.0;
+
+            int ready = 0;
+            int entries = 0;
+            qint64 startTick = 0;
+            while (ready < members.size() && survival > 0.0) {
+                // Members available from this stretch on
+                const qint64 readyTick = members[ready].cooldown <= firstTick ? 0
+                    : static_cast<qint64>(std::ceil((members[ready].cooldown - firstTick) / tick));
+                while (ready < members.size()) {
+                    const qint64 memberTick = members[ready].cooldown <= firstTick ? 0
+                        : static_cast<qint64>(std::ceil((members[ready].cooldown - firstTick) / tick));
+                    if (memberTick != readyTick) {
+                        break;
+                    }
+                    entries += members[ready].entries;
+                    ++ready;
+                }
+                startTick = readyTick;
+
+                const bool last = ready == members.size();
+                const qint64 length = last ? 0
+                    : static_cast<qint64>(std::ceil((members[ready].cooldown - firstTick) / tick)) - startTick;
+
+                const double q = winProbability(entries);
+                const double r = 1.0 - q;
+                double pressed;    // Probability of a press in this stretch
+                double ticks;      // Expected ticks spent available
+                double weighted;   // Sum of k * r^k over the stretch
+                double remaining;  // Survival past the stretch
+                if (last) {
+                    if (q <= 0.0) {
+                        // Never wins: the group is starved
+                        survival = 0.0;
+                        cycle = 0.0;
+                        break;
+                    }
+                    pressed = survival;
+                    ticks = survival / q;
+                    weighted = r / (q * q);
+                    remaining = 0.0;
+                } else {
+                    const double rL = std::pow(r, static_cast<double>(length));
+                    pressed = survival * (1.0 - rL);
+                    ticks = q > 0.0 ? pressed / q : survival * length;
+                    weighted = q > 0.0
+                        ? r * (1.0 - length * std::pow(r, length - 1.0) + (length - 1.0) * rL) / (q * q)
+                        : 0.0;
+                    remaining = survival * rL;
+                }
+
+                const double startTime = firstTick + startTick * tick;
+                cycle += startTime * pressed + tick * survival * q * weighted;
+                availableTicks[g] += ticks;
+                availableEntries[g] += ticks * entries;
+                for (int m = 0; m < ready; ++m) {
+                    m_shares[members[m].action] += pressed * members[m].entries / entries;
+                }
+                survival = remaining;
+            }
+
+            group.rate = cycle > 0.0 ? 1.0 / cycle : 0.0;
+        }
+
+        // Feed the availability of every group back into the others
+        double totalRate = 0.0;
+        for (const Group &group : m_groups) {
+            totalRate += group.rate;
+        }
+
+        double change = 0.0;
+        for (int g = 0; g < m_groups.size(); ++g) {
+            Group &group = m_groups[g];
+            const double available = totalRate > 0.0
+                ? qMin(1.0, availableTicks[g] * group.rate / totalRate) : 0.0;
+            const double entries = availableTicks[g] > 0.0
+                ? availableEntries[g] / availableTicks[g] : group.entries;
+            change = qMax(change, qAbs(available - group.available));
+            group.available = 0.5 * (group.available + available);
+            group.entries = 0.5 * (group.entries + entries);
+        }
+
+        if (change < 1e-5) {
+            break;
+        }
+        if (m_iterations < MaxIterations) {
+            m_shares.fill(0.0);
+        }
+    }
+
+    for (const Group &group : m_groups) {
+        for (const Member &member : group.members) {
+            m_rates[member.action] = group.rate * m_shares[member.action] * 60000.0;
+        }
+    }
+
+    m_solveTimeNs = timer.nsecsElapsed();
+}
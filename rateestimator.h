@@ -0,0 +1,74 @@
+#ifndef RATEESTIMATOR_H
+#define RATEESTIMATOR_H
+
+#include <QVector>
+#include <QHash>
+#include <vector>
+#include "classprofile.h"
+
+// Analytic estimate of how often the engine presses each action of a profile,
+// without running it. Actions sharing a key are treated as one group with a
+// shared cooldown. For each group, the model looks at the engine ticks after
+// one of its presses. The chance that the group wins a tick depends on the
+// distribution of entries the other groups have available at that tick; the
+// closed-form result is the group's mean cycle length. The availability of
+// every group then feeds back into the others, and the model is iterated to
+// a fixed point.
+//
+// The solver keeps its last solution and starts from it after an edit, so
+// small changes such as a slider tick usually converge quickly.
+class RateEstimator {
+public:
+    explicit RateEstimator(int tickInterval);
+
+    void setActions(const ActionList &actions);
+    void updateAction(int index, const KeyAction &action);
+
+    const ActionList &actions() const { return m_actions; }
+
+    // Presses per minute of each action, 0 for actions the engine ignores
+    const QVector<double> &ratesPerMinute() const { return m_rates; }
+    double ratePerMinute(int index) const;
+
+    // Cost of the last solve
+    int iterations() const { return m_iterations; }
+    qint64 solveTimeNs() const { return m_solveTimeNs; }
+
+private:
+    struct Member {
+        int action;
+        int entries;
+        int cooldown;
+    };
+
+    struct Group {
+        int key;
+        QVector<Member> members;  // Sorted by cooldown
+        double available;         // Probability of having an entry at a tick
+        double entries;           // Mean entries available when it does
+        double rate;              // Presses per millisecond
+    };
+
+    void rebuildGroups();
+    void solve();
+    void buildDistribution();
+    void removeFromDistribution(const Group &group);
+    double winProbability(int entries) const;
+
+    static const int MaxIterations = 100;
+
+    int m_tickInterval;
+    ActionList m_actions;
+    QVector<Group> m_groups;
+    QVector<double> m_rates;
+    QVector<double> m_shares;  // Per action share of its group's presses
+
+    // Distribution of available entries over all groups, and with one removed
+    std::vector<double> m_distribution;
+    std::vector<double> m_others;
+
+    int m_iterations;
+    qint64 m_solveTimeNs;
+};
+
+#endif // RATEESTIMATOR_H
@@ -46,8 +46,12 @@ if (Test-Path $DistDir) {
 New-Item -ItemType Directory -Path $DistDir | Out-Null
 
 # Copy main executable
-Write-Host "Copying executable..."
+Write-Host "Copying executables..."
 Copy-Item $ExePath $DistDir
+$CtlPath = Join-Path $BinDir "autokeyctl.exe"
+if (Test-Path $CtlPath) {
+    Copy-Item $CtlPath $DistDir
+}
 
 # Copy configuration file
 $ConfigPath = Join-Path $ProjectRoot "config.json"
@@ -0,0 +1,132 @@
+#include "sequencepreview.h"
+#include <QHash>
+#include <QRandomGenerator>
+#include "tokenbucket.h"
+
+SequencePreviewJob::SequencePreviewJob(const ExecutionPlanPtr &plan, qint64 length,
+                                       int tickInterval, QObject *parent)
+    : QObject(parent)
+    , m_plan(plan)
+    , m_length(length)
+    , m_tickInterval(tickInterval)
+    , m_chunkSlots(MaxChunksInFlight)
+    , m_cancelled(false)
+    , m_generated(0)
+    , m_virtualDuration(0) {
+}
+
+void SequencePreviewJob::chunkConsumed() {
+    m_chunkSlots.release();
+}
+
+void SequencePreviewJob::cancel() {
+    m_cancelled = true;
+    // Unblock a worker waiting for the GUI to render a chunk
+    m_chunkSlots.release(MaxChunksInFlight);
+}
+
+QChar SequencePreviewJob::keyChar(int key) {
+    if (key >= 0x30 && key <= 0x39) {  // 0-9 keys
+        return QChar(key);
+    }
+    if (key >= 0x41 && key <= 0x5A) {  // A-Z keys
+        return QChar(key);
+    }
+    return QChar('?');
+}
+
+void SequencePreviewJob::emitChunk(QString &chunk) {
+    if (chunk.isEmpty()) {
+        return;
+    }
+
+    m_chunkSlots.acquire();
+    if (!m_cancelled) {
+        emit chunkReady(chunk);
+    }
+    chunk.clear();
+}
+
+void SequencePreviewJob::run() {
+    const ExecutionPlan &plan = *m_plan;
+
+    // Slots sharing a key share one statistics entry
+    QVector<int> statForSlot(plan.size());
+    QHash<int, int> statForKey;
+    for (int i = 0; i < plan.size(); ++i) {
+        const int key = plan.slot(i).key;
+        auto it = statForKey.find(key);
+        if (it == statForKey.end()) {
+            it = statForKey.insert(key, m_stats.size());
+            m_stats.append(KeyStats{key, 0, -1, -1});
+        }
+        statForSlot[i] = it.value();
+    }
+
+    QVector<qint64> lastPressed(plan.size(), ExecutionPlan::NeverPressed);
+    QRandomGenerator rng(QRandomGenerator::global()->generate());
+    TokenBucket budget;
+    budget.configure(plan.rateLimit(), plan.rateBurst(), 0);
+
+    // Same choice as the engine: by urgency once the budget is down to its
+    // last token, at random otherwise
+    auto pickAt = [&](qint64 time) {
+        budget.refill(time);
+        return budget.isLimited() && budget.tokens() < 2.0
+            ? plan.pickUrgent(lastPressed.constData(), time)
+            : plan.pick(lastPressed.constData(), time, &rng);
+    };
+
+    const int chunkSize = LineLength * ChunkLines;
+    QString chunk;
+    chunk.reserve(chunkSize + ChunkLines);
+
+    qint64 now = 0;
+    int lastPercent = -1;
+    while (m_generated < m_length && !m_cancelled) {
+        // Same scheduling as the engine: one press per tick, or sleep until
+        // the first cooldown expires or the rate budget has a token again
+        budget.refill(now);
+        now = budget.nextTokenTime(now);
+        int selected = pickAt(now);
+        if (selected < 0) {
+            const qint64 readyTime = plan.nextReadyTime(lastPressed.constData());
+            if (readyTime == ExecutionPlan::NeverReady) {
+                break;
+            }
+            now = readyTime;
+            selected = pickAt(now);
+        }
+
+        budget.tryTake();
+        plan.markPressed(lastPressed.data(), selected, now);
+
+        KeyStats &stats = m_stats[statForSlot[selected]];
+        if (stats.lastPressed >= 0) {
+            stats.longestGap = qMax(stats.longestGap, now - stats.lastPressed);
+        }
+        stats.lastPressed = now;
+        ++stats.presses;
+
+        chunk.append(keyChar(plan.slot(selected).key));
+        ++m_generated;
+        m_virtualDuration = now;
+        now += m_tickInterval;
+
+        if (m_generated % LineLength == 0) {
+            chunk.append(QChar('\n'));
+            if (m_generated % chunkSize == 0) {
+                emitChunk(chunk);
+
+                const int percent = static_cast<int>(m_generated * 100 / m_length);
+                if (percent != lastPercent) {
+                    lastPercent = percent;
+                    emit progressChanged(percent);
+                }
+            }
+        }
+    }
+
+    emitChunk(chunk);
+    emit finished(!m_cancelled);
+}
@@ -0,0 +1,67 @@
+#ifndef SEQUENCEPREVIEW_H
+#define SEQUENCEPREVIEW_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QSemaphore>
+#include <atomic>
+#include "executionplan.h"
+
+// Generates a preview of the key sequence an ExecutionPlan would produce,
+// simulating the engine's timing in virtual time. Meant to run on a worker
+// thread: the text is handed out in chunks with at most MaxChunksInFlight
+// queued at once, and per-key statistics are collected in the same pass.
+class SequencePreviewJob : public QObject {
+    Q_OBJECT
+
+public:
+    struct KeyStats {
+        int key;
+        qint64 presses;
+        qint64 longestGap;   // Longest virtual time between two presses (ms), -1 if unknown
+        qint64 lastPressed;  // Virtual time of the last press, -1 if never pressed
+    };
+
+    SequencePreviewJob(const ExecutionPlanPtr &plan, qint64 length, int tickInterval,
+                       QObject *parent = nullptr);
+
+    // Must be called by the receiver once it has rendered a chunk
+    void chunkConsumed();
+    void cancel();
+
+    void run();
+
+    // Valid once finished() was emitted
+    const QVector<KeyStats> &stats() const { return m_stats; }
+    qint64 generated() const { return m_generated; }
+    qint64 virtualDuration() const { return m_virtualDuration; }
+
+    // Character shown for a virtual key in the preview
+    static QChar keyChar(int key);
+
+signals:
+    void chunkReady(const QString &text);
+    void progressChanged(int percent);
+    void finished(bool completed);
+
+private:
+    static const int LineLength = 100;
+    static const int ChunkLines = 50;
+    static const int MaxChunksInFlight = 4;
+
+    void emitChunk(QString &chunk);
+
+    ExecutionPlanPtr m_plan;
+    qint64 m_length;
+    int m_tickInterval;
+
+    QSemaphore m_chunkSlots;
+    std::atomic<bool> m_cancelled;
+
+    QVector<KeyStats> m_stats;
+    qint64 m_generated;
+    qint64 m_virtualDuration;
+};
+
+#endif // SEQUENCEPREVIEW_H
@@ -0,0 +1,188 @@
+#include "sequencepreviewdialog.h"
+#include "keysimulator.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QFontDatabase>
+#include <QTextCursor>
+#include <QtConcurrent>
+
+SequencePreviewDialog::SequencePreviewDialog(const QList<ClassProfile> &profiles, int currentIndex,
+                                             QWidget *parent)
+    : QDialog(parent)
+    , m_profiles(profiles)
+    , m_job(nullptr) {
+    setupUI();
+    m_profileComboBox->setCurrentIndex(qMax(0, currentIndex));
+}
+
+SequencePreviewDialog::~SequencePreviewDialog() {
+    stopJob();
+}
+
+void SequencePreviewDialog::setupUI() {
+    setWindowTitle("Sequence Preview");
+    setModal(true);
+    resize(720, 560);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QFormLayout *formLayout = new QFormLayout();
+    m_profileComboBox = new QComboBox();
+    for (const auto &profile : m_profiles) {
+        m_profileComboBox->addItem(profile.getName());
+    }
+    formLayout->addRow("Profile:", m_profileComboBox);
+
+    m_lengthSpinBox = new QSpinBox();
+    m_lengthSpinBox->setRange(1, MaxLength);
+    m_lengthSpinBox->setValue(1000);
+    m_lengthSpinBox->setGroupSeparatorShown(true);
+    m_lengthSpinBox->setSuffix(" presses");
+    formLayout->addRow("Length:", m_lengthSpinBox);
+    mainLayout->addLayout(formLayout);
+
+    m_sequenceView = new QPlainTextEdit();
+    m_sequenceView->setReadOnly(true);
+    m_sequenceView->setUndoRedoEnabled(false);
+    m_sequenceView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_sequenceView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    mainLayout->addWidget(m_sequenceView, 2);
+
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setVisible(false);
+    mainLayout->addWidget(m_progressBar);
+
+    m_summaryLabel = new QLabel();
+    mainLayout->addWidget(m_summaryLabel);
+
+    m_statsTable = new QTableWidget(0, 4);
+    m_statsTable->setHorizontalHeaderLabels({"Key", "Presses", "Share", "Longest Gap"});
+    m_statsTable->horizontalHeader()->setStretchLastSection(true);
+    m_statsTable->verticalHeader()->setVisible(false);
+    m_statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mainLayout->addWidget(m_statsTable, 1);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_generateButton = new QPushButton("Generate");
+    m_startButton = new QPushButton("Start Simulation");
+    QPushButton *closeButton = new QPushButton("Close");
+    buttonLayout->addWidget(m_generateButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_startButton);
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_generateButton, &QPushButton::clicked, this, &SequencePreviewDialog::onGenerate);
+    connect(m_startButton, &QPushButton::clicked, this, &QDialog::accept);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::reject);
+}
+
+int SequencePreviewDialog::selectedProfileIndex() const {
+    return m_profileComboBox->currentIndex();
+}
+
+void SequencePreviewDialog::onGenerate() {
+    if (m_job) {
+        // The button doubles as Cancel while a preview is running
+        stopJob();
+        m_progressBar->setVisible(false);
+        m_generateButton->setText("Generate");
+        m_summaryLabel->setText("Preview cancelled");
+        return;
+    }
+
+    const int index = m_profileComboBox->currentIndex();
+    if (index < 0 || index >= m_profiles.size()) {
+        return;
+    }
+
+    m_sequenceView->clear();
+    m_statsTable->setRowCount(0);
+
+    ExecutionPlanPtr plan = ExecutionPlan::compile(m_profiles[index]);
+    if (plan->isEmpty()) {
+        m_summaryLabel->setText("No enabled keyboard actions configured");
+        return;
+    }
+
+    m_job = new SequencePreviewJob(plan, m_lengthSpinBox->value(), KeySimulator::TickInterval);
+    connect(m_job, &SequencePreviewJob::chunkReady, this, &SequencePreviewDialog::onChunkReady);
+    connect(m_job, &SequencePreviewJob::progressChanged, m_progressBar, &QProgressBar::setValue);
+    connect(m_job, &SequencePreviewJob::finished, this, &SequencePreviewDialog::onFinished);
+
+    m_progressBar->setValue(0);
+    m_progressBar->setVisible(true);
+    m_generateButton->setText("Cancel");
+    m_summaryLabel->setText("Generating...");
+
+    SequencePreviewJob *job = m_job;
+    m_future = QtConcurrent::run([job]() { job->run(); });
+}
+
+void SequencePreviewDialog::onChunkReady(const QString &text) {
+    // Chunks of a cancelled job may still be queued
+    if (sender() != m_job) {
+        return;
+    }
+
+    QTextCursor cursor(m_sequenceView->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+    m_job->chunkConsumed();
+}
+
+void SequencePreviewDialog::onFinished(bool completed) {
+    if (sender() != m_job) {
+        return;
+    }
+
+    m_progressBar->setVisible(false);
+    m_generateButton->setText("Generate");
+    if (completed) {
+        showStats();
+    }
+    stopJob();
+}
+
+void SequencePreviewDialog::showStats() {
+    const auto &stats = m_job->stats();
+    const qint64 total = qMax<qint64>(1, m_job->generated());
+
+    m_statsTable->setRowCount(stats.size());
+    for (int row = 0; row < stats.size(); ++row) {
+        const auto &keyStats = stats[row];
+        const QString gap = keyStats.longestGap >= 0
+            ? QString("%1 ms").arg(keyStats.longestGap)
+            : QString("-");
+
+        m_statsTable->setItem(row, 0, new QTableWidgetItem(QString(SequencePreviewJob::keyChar(keyStats.key))));
+        m_statsTable->setItem(row, 1, new QTableWidgetItem(QString::number(keyStats.presses)));
+        m_statsTable->setItem(row, 2, new QTableWidgetItem(
+            QString("%1%").arg(keyStats.presses * 100.0 / total, 0, 'f', 1)));
+        m_statsTable->setItem(row, 3, new QTableWidgetItem(gap));
+    }
+
+    m_summaryLabel->setText(QString("%1 presses over %2 s of simulated time")
+        .arg(m_job->generated())
+        .arg(m_job->virtualDuration() / 1000.0, 0, 'f', 1));
+}
+
+void SequencePreviewDialog::stopJob() {
+    if (!m_job) {
+        return;
+    }
+
+    m_job->cancel();
+    m_future.waitForFinished();
+    m_job->disconnect(this);
+    m_job->deleteLater();
+    m_job = nullptr;
+}
+
+void SequencePreviewDialog::reject() {
+    stopJob();
+    QDialog::reject();
+}
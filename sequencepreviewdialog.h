@@ -0,0 +1,59 @@
+#ifndef SEQUENCEPREVIEWDIALOG_H
+#define SEQUENCEPREVIEWDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QPlainTextEdit>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QLabel>
+#include <QFuture>
+#include "classprofile.h"
+#include "sequencepreview.h"
+
+// Previews the key sequence of any profile for lengths up to millions of
+// presses. Generation runs through QtConcurrent and can be cancelled; the
+// text is rendered as it arrives and per-key statistics are shown at the end.
+class SequencePreviewDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    SequencePreviewDialog(const QList<ClassProfile> &profiles, int currentIndex,
+                          QWidget *parent = nullptr);
+    ~SequencePreviewDialog();
+
+    // Profile the user chose to start, valid when exec() returned Accepted
+    int selectedProfileIndex() const;
+
+private slots:
+    void onGenerate();
+    void onChunkReady(const QString &text);
+    void onFinished(bool completed);
+
+protected:
+    void reject() override;
+
+private:
+    void setupUI();
+    void stopJob();
+    void showStats();
+
+    static const int MaxLength = 10000000;
+
+    QList<ClassProfile> m_profiles;
+    SequencePreviewJob *m_job;
+    QFuture<void> m_future;
+
+    QComboBox *m_profileComboBox;
+    QSpinBox *m_lengthSpinBox;
+    QPushButton *m_generateButton;
+    QPushButton *m_startButton;
+    QProgressBar *m_progressBar;
+    QPlainTextEdit *m_sequenceView;
+    QTableWidget *m_statsTable;
+    QLabel *m_summaryLabel;
+};
+
+#endif // SEQUENCEPREVIEWDIALOG_H
@@ -0,0 +1,530 @@
+#include "sessionlog.h"
+#include "profilepack.h"
+#include <QDataStream>
+#include <QDir>
+#include <QDebug>
+#include <QtEndian>
+#include <chrono>
+#include <limits>
+
+const char SessionLog::Magic[4] = {'A', 'K', 'S', 'N'};
+
+namespace {
+
+const int HeaderSize = 8;
+const int ChunkHeaderSize = 8;
+// Larger chunks mean a damaged file
+const quint32 MaxChunkSize = 16 * 1024 * 1024;
+
+int bitWidth(quint64 value) {
+    int width = 0;
+    while (value) {
+        ++width;
+        value >>= 1;
+    }
+    return width;
+}
+
+} // namespace
+
+SessionLog::SessionLog()
+    : m_events(nullptr)
+    , m_stopping(false)
+    , m_writeFailed(false)
+    , m_bytesWritten(0)
+    , m_recording(false)
+    , m_eventCount(0)
+    , m_firstTimestamp(0)
+    , m_lastTimestamp(0) {
+}
+
+SessionLog::~SessionLog() {
+    stop();
+}
+
+bool SessionLog::start(SessionEventRing *events, const QString &filePath, QString *errorString) {
+    if (m_recording) {
+        stop();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_series.clear();
+        m_unwritten.clear();
+        m_eventCount = 0;
+        m_firstTimestamp = 0;
+        m_lastTimestamp = 0;
+    }
+    m_bytesWritten = 0;
+    m_writeFailed = false;
+
+    if (!filePath.isEmpty()) {
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            if (errorString) {
+                *errorString = m_file.errorString();
+            }
+            return false;
+        }
+        if (!writeHeader(&m_file)) {
+            if (errorString) {
+                *errorString = m_file.errorString();
+            }
+            m_file.close();
+            return false;
+        }
+        m_bytesWritten = HeaderSize;
+    }
+
+    // Presses of an earlier session
+    m_events = events;
+    m_events->drain([](const SessionEvent &) {});
+
+    m_stopping = false;
+    m_recording = true;
+    m_writer = std::thread([this]() { writerLoop(); });
+    return true;
+}
+
+void SessionLog::stop() {
+    if (!m_recording) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_writer.join();
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_recording = false;
+
+    qDebug() << "Session log stopped:" << eventCount() << "events," << memoryBytes()
+             << "bytes packed," << bytesWritten() << "bytes written," << droppedEvents() << "dropped";
+}
+
+void SessionLog::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (!m_wake.wait_for(lock, std::chrono::milliseconds(DrainInterval), [this]() { return m_stopping; })) {
+        lock.unlock();
+        drainRing();
+        writeChunks(false);
+        lock.lock();
+    }
+    lock.unlock();
+
+    // Presses sent before the engine stopped, and the chunks still open
+    drainRing();
+    writeChunks(true);
+}
+
+void SessionLog::drainRing() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events->drain([this](const SessionEvent &event) { appendLocked(event); });
+}
+
+void SessionLog::append(const SessionEvent &event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    appendLocked(event);
+}
+
+void SessionLog::appendLocked(const SessionEvent &event) {
+    Series &series = m_series[event.key];
+    if (series.time.capacity() < ChunkEvents) {
+        series.time.reserve(ChunkEvents);
+        series.lateness.reserve(ChunkEvents);
+        series.slot.reserve(ChunkEvents);
+        series.queueDepth.reserve(ChunkEvents);
+    }
+    series.time.append(event.timestamp);
+    series.lateness.append(event.lateness);
+    series.slot.append(event.slot);
+    series.queueDepth.append(event.queueDepth);
+    ++series.count;
+
+    if (m_eventCount == 0) {
+        m_firstTimestamp = event.timestamp;
+    }
+    m_lastTimestamp = qMax(m_lastTimestamp, event.timestamp);
+    ++m_eventCount;
+
+    if (series.time.size() == ChunkEvents) {
+        m_unwritten.append(qMakePair(int(event.key), seal(&series)));
+    }
+}
+
+SessionLog::PackedChunk SessionLog::seal(Series *series) {
+    PackedChunk chunk;
+    chunk.count = series->time.size();
+    chunk.firstTime = series->time.first();
+    chunk.lastTime = series->time.last();
+    chunk.time = pack(series->time.constData(), chunk.count, true);
+    chunk.lateness = pack(series->lateness.constData(), chunk.count, false);
+    chunk.slot = pack(series->slot.constData(), chunk.count, false);
+    chunk.queueDepth = pack(series->queueDepth.constData(), chunk.count, false);
+    series->chunks.append(chunk);
+
+    series->time.clear();
+    series->lateness.clear();
+    series->slot.clear();
+    series->queueDepth.clear();
+    return chunk;
+}
+
+void SessionLog::writeChunks(bool all) {
+    QVector<QPair<int, PackedChunk>> chunks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (all) {
+            for (auto it = m_series.begin(); it != m_series.end(); ++it) {
+                if (!it->time.isEmpty()) {
+                    m_unwritten.append(qMakePair(it.key(), seal(&it.value())));
+                }
+            }
+        }
+        chunks.swap(m_unwritten);
+    }
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    // Compressed outside the lock; chunks share their words with the log
+    for (const auto &chunk : chunks) {
+        const qint64 bytes = writeChunk(&m_file, chunk.first, chunk.second);
+        if (bytes < 0) {
+            m_writeFailed = true;
+            return;
+        }
+        m_bytesWritten += bytes;
+    }
+    if (!chunks.isEmpty()) {
+        m_file.flush();
+    }
+}
+
+bool SessionLog::writeHeader(QFile *file) {
+    const char header[HeaderSize] = {Magic[0], Magic[1], Magic[2], Magic[3], char(Version), 0, 0, 0};
+    return file->write(header, HeaderSize) == HeaderSize;
+}
+
+qint64 SessionLog::writeChunk(QFile *file, int key, const PackedChunk &chunk) {
+    const QByteArray compressed = qCompress(encodeChunk(key, chunk));
+    uchar header[ChunkHeaderSize];
+    qToBigEndian<quint32>(static_cast<quint32>(compressed.size()), header);
+    qToBigEndian<quint32>(ProfilePack::crc32(compressed), header + 4);
+    if (file->write(reinterpret_cast<const char *>(header), ChunkHeaderSize) != ChunkHeaderSize
+        || file->write(compressed) != compressed.size()) {
+        return -1;
+    }
+    return ChunkHeaderSize + compressed.size();
+}
+
+bool SessionLog::save(const QString &filePath, QString *errorString) const {
+    QFile file(filePath);
+    auto fail = [errorString, &file]() {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    };
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeHeader(&file)) {
+        return fail();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        for (const PackedChunk &chunk : it->chunks) {
+            if (writeChunk(&file, it.key(), chunk) < 0) {
+                return fail();
+            }
+        }
+        // The open chunk is packed for the file only; the log keeps it open
+        if (!it->time.isEmpty()) {
+            Series open;
+            open.time = it->time;
+            open.lateness = it->lateness;
+            open.slot = it->slot;
+            open.queueDepth = it->queueDepth;
+            if (writeChunk(&file, it.key(), seal(&open)) < 0) {
+                return fail();
+            }
+        }
+    }
+    return true;
+}
+
+SessionLog::PackedColumn SessionLog::pack(const qint64 *values, int count, bool delta) {
+    PackedColumn column;
+    if (count == 0) {
+        return column;
+    }
+    column.first = values[0];
+
+    // Frame of reference: the smallest value (or delta) becomes zero. A delta
+    // column has no delta for its first value, which is kept in 'first'.
+    auto valueAt = [values, delta](int i) { return delta ? values[i] - values[i - 1] : values[i]; };
+    const int begin = delta ? 1 : 0;
+    qint64 minimum = begin < count ? valueAt(begin) : 0;
+    qint64 maximum = minimum;
+    for (int i = begin + 1; i < count; ++i) {
+        minimum = qMin(minimum, valueAt(i));
+        maximum = qMax(maximum, valueAt(i));
+    }
+    column.offset = minimum;
+    column.width = static_cast<quint8>(bitWidth(quint64(maximum) - quint64(minimum)));
+    if (column.width == 0) {
+        return column;  // Every value equals the offset
+    }
+
+    column.words.fill(0, (qint64(count) * column.width + 63) / 64);
+    quint64 *words = column.words.data();
+    qint64 bit = 0;
+    for (int i = 0; i < count; ++i, bit += column.width) {
+        const quint64 value = i >= begin ? quint64(valueAt(i)) - quint64(minimum) : 0;
+        const int shift = static_cast<int>(bit % 64);
+        words[bit / 64] |= value << shift;
+        if (shift + column.width > 64) {
+            words[bit / 64 + 1] |= value >> (64 - shift);
+        }
+    }
+    return column;
+}
+
+void SessionLog::unpack(const PackedColumn &column, int count, bool delta, qint64 *values) {
+    const quint64 mask = column.width == 64 ? ~quint64(0) : (quint64(1) << column.width) - 1;
+    const quint64 *words = column.words.constData();
+    qint64 previous = column.first;
+    qint64 bit = 0;
+    for (int i = 0; i < count; ++i, bit += column.width) {
+        quint64 value = 0;
+        if (column.width > 0) {
+            const int shift = static_cast<int>(bit % 64);
+            value = words[bit / 64] >> shift;
+            if (shift + column.width > 64) {
+                value |= words[bit / 64 + 1] << (64 - shift);
+            }
+            value &= mask;
+        }
+        const qint64 decoded = qint64(value + quint64(column.offset));
+        if (delta) {
+            previous += i > 0 ? decoded : 0;
+            values[i] = previous;
+        } else {
+            values[i] = decoded;
+        }
+    }
+}
+
+QByteArray SessionLog::encodeChunk(int key, const PackedChunk &chunk) {
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << quint16(key) << qint32(chunk.count) << chunk.firstTime << chunk.lastTime;
+    for (const PackedColumn *column : {&chunk.time, &chunk.lateness, &chunk.slot, &chunk.queueDepth}) {
+        stream << column->first << column->offset << column->width;
+        for (quint64 word : column->words) {
+            stream << word;
+        }
+    }
+    return payload;
+}
+
+bool SessionLog::decodeChunk(const QByteArray &payload, int *key, PackedChunk *chunk) {
+    QDataStream stream(payload);
+    quint16 chunkKey = 0;
+    qint32 count = 0;
+    stream >> chunkKey >> count >> chunk->firstTime >> chunk->lastTime;
+    if (count <= 0 || count > ChunkEvents) {
+        return false;
+    }
+    for (PackedColumn *column : {&chunk->time, &chunk->lateness, &chunk->slot, &chunk->queueDepth}) {
+        stream >> column->first >> column->offset >> column->width;
+        if (column->width > 64) {
+            return false;
+        }
+        column->words.resize((qint64(count) * column->width + 63) / 64);
+        for (quint64 &word : column->words) {
+            stream >> word;
+        }
+    }
+    *key = chunkKey;
+    chunk->count = count;
+    return stream.status() == QDataStream::Ok;
+}
+
+int SessionLog::prune(const QString &directory, int keep) {
+    const QDir dir(directory);
+    const QFileInfoList files = dir.entryInfoList({"*.aksession"}, QDir::Files, QDir::Time);
+    int removed = 0;
+    for (int i = qMax(keep, 0); i < files.size(); ++i) {
+        if (QFile::remove(files.at(i).filePath())) {
+            ++removed;
+        } else {
+            qWarning() << "Could not delete old session file" << files.at(i).filePath();
+        }
+    }
+    return removed;
+}
+
+bool SessionLog::load(const QString &filePath, QString *errorString) {
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+
+    if (m_recording) {
+        return fail("A session is being recorded");
+    }
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    const QByteArray header = file.read(HeaderSize);
+    if (header.size() != HeaderSize || !header.startsWith(QByteArray(Magic, 4))) {
+        return fail("Not a session log");
+    }
+    if (quint8(header[4]) != Version) {
+        return fail(QString("Unsupported session log version %1").arg(quint8(header[4])));
+    }
+
+    QMap<int, Series> series;
+    qint64 eventCount = 0;
+    qint64 firstTimestamp = std::numeric_limits<qint64>::max();
+    qint64 lastTimestamp = 0;
+    for (int index = 1; !file.atEnd(); ++index) {
+        const QByteArray chunkHeader = file.read(ChunkHeaderSize);
+        if (chunkHeader.size() < ChunkHeaderSize) {
+            break;  // Cut off by a crash while recording
+        }
+        const uchar *bytes = reinterpret_cast<const uchar *>(chunkHeader.constData());
+        const quint32 size = qFromBigEndian<quint32>(bytes);
+        const quint32 checksum = qFromBigEndian<quint32>(bytes + 4);
+        if (size > MaxChunkSize) {
+            return fail(QString("Chunk %1 is too large").arg(index));
+        }
+        const QByteArray compressed = file.read(size);
+        if (compressed.size() < int(size)) {
+            break;
+        }
+        if (ProfilePack::crc32(compressed) != checksum) {
+            return fail(QString("Checksum mismatch in chunk %1").arg(index));
+        }
+
+        int key = 0;
+        PackedChunk chunk;
+        if (!decodeChunk(qUncompress(compressed), &key, &chunk)) {
+            return fail(QString("Chunk %1 is damaged").arg(index));
+        }
+        Series &keySeries = series[key];
+        keySeries.chunks.append(chunk);
+        keySeries.count += chunk.count;
+        eventCount += chunk.count;
+        firstTimestamp = qMin(firstTimestamp, chunk.firstTime);
+        lastTimestamp = qMax(lastTimestamp, chunk.lastTime);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.swap(series);
+    m_unwritten.clear();
+    m_eventCount = eventCount;
+    m_firstTimestamp = eventCount > 0 ? firstTimestamp : 0;
+    m_lastTimestamp = lastTimestamp;
+    return true;
+}
+
+qint64 SessionLog::eventCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_eventCount;
+}
+
+QVector<int> SessionLog::keys() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_series.keys().toVector();
+}
+
+qint64 SessionLog::eventCount(int key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_series.constFind(key);
+    return it != m_series.constEnd() ? it->count : 0;
+}
+
+qint64 SessionLog::firstTimestamp() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_firstTimestamp;
+}
+
+qint64 SessionLog::lastTimestamp() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastTimestamp;
+}
+
+template <typename Func>
+void SessionLog::scanTimes(int key, Func func) const {
+    auto it = m_series.constFind(key);
+    if (it == m_series.constEnd()) {
+        return;
+    }
+
+    qint64 times[ChunkEvents];
+    for (const PackedChunk &chunk : it->chunks) {
+        unpack(chunk.time, chunk.count, true, times);
+        for (int i = 0; i < chunk.count; ++i) {
+            func(times[i]);
+        }
+    }
+    for (qint64 time : it->time) {
+        func(time);
+    }
+}
+
+QVector<int> SessionLog::keyRate(int key, int bucketMs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_eventCount == 0 || bucketMs <= 0) {
+        return QVector<int>();
+    }
+
+    const qint64 first = m_firstTimestamp;
+    QVector<int> buckets(static_cast<int>((m_lastTimestamp - first) / bucketMs + 1), 0);
+    scanTimes(key, [&buckets, first, bucketMs](qint64 time) {
+        // The wall clock may have been set back during the session
+        ++buckets[static_cast<int>(qBound<qint64>(0, (time - first) / bucketMs, buckets.size() - 1))];
+    });
+    return buckets;
+}
+
+QVector<int> SessionLog::gapHistogram(int key, int bucketMs, int buckets) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QVector<int> histogram(qMax(0, buckets), 0);
+    if (bucketMs <= 0 || buckets <= 0) {
+        return histogram;
+    }
+
+    qint64 previous = -1;
+    scanTimes(key, [&histogram, &previous, bucketMs, buckets](qint64 time) {
+        if (previous >= 0) {
+            const qint64 bucket = (time - previous) / bucketMs;
+            ++histogram[static_cast<int>(qBound<qint64>(0, bucket, buckets - 1))];
+        }
+        previous = time;
+    });
+    return histogram;
+}
+
+qint64 SessionLog::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    qint64 bytes = 0;
+    for (const Series &series : m_series) {
+        for (const PackedChunk &chunk : series.chunks) {
+            bytes += sizeof(PackedChunk);
+            for (const PackedColumn *column : {&chunk.time, &chunk.lateness, &chunk.slot, &chunk.queueDepth}) {
+                bytes += column->words.size() * sizeof(quint64);
+            }
+        }
+        bytes += series.time.capacity() * sizeof(qint64) * 4;
+    }
+    return bytes;
+}
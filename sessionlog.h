@@ -0,0 +1,158 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "engineevent.h"
+
+// Every key the engine sent during a session, kept for analysis afterwards.
+//
+// Events are stored by column and grouped by key: each key has a series of
+// chunks, and a chunk holds up to ChunkEvents presses as separate
+// bit-packed columns, timestamps as deltas. A per-key query such as the
+// press rate or the gap distribution decodes the timestamp column of that
+// key's chunks and nothing else. An 8 hour session at the engine's top
+// rate (one press per 50 ms tick) packs into about 1.5 MB.
+//
+// While a session runs, a writer thread drains the engine's session ring
+// like the TraceRecorder does, packs the events and appends every sealed
+// chunk to the session file, compressed. Queries may run at the same time.
+//
+// Session files (*.aksession) start with an 8 byte header: "AKSN", a version
+// byte and three reserved bytes. Chunks follow as quint32 size, quint32
+// CRC-32 and a qCompress()ed payload: key, event count, first and last
+// timestamp, then each column as first value, offset, bit width and words.
+class SessionLog {
+public:
+    SessionLog();
+    ~SessionLog();
+
+    // Starts a new session fed from the engine's session ring. Events queued
+    // before are discarded. An empty path keeps the session in memory only.
+    bool start(SessionEventRing *events, const QString &filePath, QString *errorString);
+    // Drains the ring, writes the chunks still open and closes the file.
+    // The engine must have stopped sending first.
+    void stop();
+    bool isRecording() const { return m_recording; }
+
+    // Replaces the log with a session file written by start() and stop()
+    // or save()
+    bool load(const QString &filePath, QString *errorString);
+    // Writes every event of the log to a session file. Must not be used
+    // while recording.
+    bool save(const QString &filePath, QString *errorString) const;
+
+    // Adds one event directly, for sessions not fed from a ring. Must not
+    // be used while recording.
+    void append(const SessionEvent &event);
+
+    // Queries, also while recording; they see the events drained so far
+    qint64 eventCount() const;
+    QVector<int> keys() const;
+    qint64 eventCount(int key) const;
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    // Presses of the key per bucketMs, counted from the first event of the
+    // session up to the last
+    QVector<int> keyRate(int key, int bucketMs) const;
+    // Gaps between consecutive presses of the key in buckets of bucketMs;
+    // the last bucket also counts every longer gap
+    QVector<int> gapHistogram(int key, int bucketMs, int buckets) const;
+
+    // Packed size of the events held in memory
+    qint64 memoryBytes() const;
+    qint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 droppedEvents() const { return m_events ? m_events->dropped() : 0; }
+    bool hasWriteError() const { return m_writeFailed.load(std::memory_order_relaxed); }
+
+    // Deletes all but the newest 'keep' session files in the directory and
+    // returns how many were deleted
+    static int prune(const QString &directory, int keep);
+
+    static const char Magic[4];
+    static const quint8 Version = 1;
+    static const int ChunkEvents = 1024;
+    // Session files kept in the sessions folder, the one being written included
+    static const int KeptSessions = 20;
+
+private:
+    // Column values minus 'offset' in 'width' bits each; delta columns hold
+    // differences to the previous value, starting from 'first'
+    struct PackedColumn {
+        qint64 first = 0;
+        qint64 offset = 0;
+        quint8 width = 0;
+        QVector<quint64> words;
+    };
+
+    struct PackedChunk {
+        int count = 0;
+        qint64 firstTime = 0;
+        qint64 lastTime = 0;
+        PackedColumn time;  // Delta encoded
+        PackedColumn lateness;
+        PackedColumn slot;
+        PackedColumn queueDepth;
+    };
+
+    // The events of one key; the newest ones stay unpacked until a chunk fills
+    struct Series {
+        QVector<PackedChunk> chunks;
+        QVector<qint64> time;
+        QVector<qint64> lateness;
+        QVector<qint64> slot;
+        QVector<qint64> queueDepth;
+        qint64 count = 0;
+    };
+
+    static PackedColumn pack(const qint64 *values, int count, bool delta);
+    static void unpack(const PackedColumn &column, int count, bool delta, qint64 *values);
+    // Packs the unpacked events of the series into a new chunk
+    static PackedChunk seal(Series *series);
+    static QByteArray encodeChunk(int key, const PackedChunk &chunk);
+    static bool decodeChunk(const QByteArray &payload, int *key, PackedChunk *chunk);
+    static bool writeHeader(QFile *file);
+    // Returns the bytes written, or -1
+    static qint64 writeChunk(QFile *file, int key, const PackedChunk &chunk);
+
+    // Appends under m_mutex; full chunks are sealed and queued for the file
+    void appendLocked(const SessionEvent &event);
+    // Calls func with the key's timestamps in order, chunk by chunk
+    template <typename Func>
+    void scanTimes(int key, Func func) const;
+
+    void writerLoop();
+    void drainRing();
+    void writeChunks(bool all);
+
+    // The ring holds 4096 events, minutes of presses at engine rates
+    static const int DrainInterval = 250;
+
+    SessionEventRing *m_events;
+    QFile m_file;
+    // A thread of its own, like the LookAheadPlanner's: it runs for the
+    // whole session. stop() wakes it through m_wake.
+    std::thread m_writer;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stopping;  // Guarded by m_wakeMutex
+    std::atomic<bool> m_writeFailed;
+    std::atomic<qint64> m_bytesWritten;
+    bool m_recording;
+
+    // Guards everything below; the writer thread appends, queries read
+    mutable std::mutex m_mutex;
+    QMap<int, Series> m_series;
+    QVector<QPair<int, PackedChunk>> m_unwritten;  // Sealed, not in the file yet
+    qint64 m_eventCount;
+    qint64 m_firstTimestamp;
+    qint64 m_lastTimestamp;
+};
+
+#endif // SESSIONLOG_H
@@ -0,0 +1,85 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity, lock-free ring buffer for exactly one producer thread and
+// one consumer thread. Storage is allocated once with the ring; push() never
+// blocks or allocates and drops the event when the ring is full, so a slow
+// consumer can never stall the producer.
+template <typename T, int Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    SpscRing() : m_head(0), m_tail(0), m_dropped(0) {}
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side. Returns false if the ring was full and the event dropped.
+    bool push(const T &value) {
+        const quint32 head = m_head.load(std::memory_order_relaxed);
+        const quint32 tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == static_cast<quint32>(Capacity)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_items[head & Mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Calls func for every queued event in order and returns
+    // the number of events consumed.
+    template <typename Func>
+    int drain(Func func) {
+        const quint32 tail = m_tail.load(std::memory_order_relaxed);
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        for (quint32 i = tail; i != head; ++i) {
+            func(m_items[i & Mask]);
+        }
+        m_tail.store(head, std::memory_order_release);
+        return static_cast<int>(head - tail);
+    }
+
+    // Consumer side, one event at a time: the oldest queued event, nullptr
+    // if there is none. It stays queued until pop().
+    const T *front() const {
+        const quint32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_items[tail & Mask];
+    }
+
+    void pop() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Events queued; a snapshot that either side may be changing
+    int size() const {
+        return static_cast<int>(m_head.load(std::memory_order_acquire)
+                                - m_tail.load(std::memory_order_acquire));
+    }
+
+    // Events dropped because the consumer fell behind
+    quint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    static constexpr int capacity() { return Capacity; }
+
+private:
+    static constexpr quint32 Mask = Capacity - 1;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<quint32> m_head;
+    alignas(64) std::atomic<quint32> m_tail;
+    alignas(64) std::atomic<quint64> m_dropped;
+    T m_items[Capacity];
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,62 @@
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <QtGlobal>
+#include <cmath>
+
+// Rate budget of the engine. Tokens accrue continuously at the configured
+// rate up to the burst size, and every press takes one. Times are the
+// engine's milliseconds; a rate of 0 means unlimited.
+class TokenBucket {
+public:
+    TokenBucket() : m_rate(0.0), m_burst(0), m_tokens(0.0), m_lastRefill(0) {}
+
+    // Keeps the tokens collected so far, so a hot-reloaded profile cannot be
+    // used to reset the budget; a new bucket starts full
+    void configure(double pressesPerSecond, int burst, qint64 now) {
+        const bool fresh = !isLimited();
+        refill(now);  // Tokens earned so far, at the old rate
+        m_rate = qMax(0.0, pressesPerSecond) / 1000.0;
+        m_burst = qMax(1, burst);
+        m_tokens = fresh ? m_burst : qMin(m_tokens, double(m_burst));
+        m_lastRefill = now;
+    }
+
+    bool isLimited() const { return m_rate > 0.0; }
+    double tokens() const { return m_tokens; }
+    int burst() const { return m_burst; }
+
+    void refill(qint64 now) {
+        if (now > m_lastRefill) {
+            m_tokens = qMin(double(m_burst), m_tokens + (now - m_lastRefill) * m_rate);
+            m_lastRefill = now;
+        }
+    }
+
+    bool tryTake() {
+        if (!isLimited()) {
+            return true;
+        }
+        if (m_tokens < 1.0) {
+            return false;
+        }
+        m_tokens -= 1.0;
+        return true;
+    }
+
+    // Earliest time at which a whole token is available
+    qint64 nextTokenTime(qint64 now) const {
+        if (!isLimited() || m_tokens >= 1.0) {
+            return now;
+        }
+        return now + static_cast<qint64>(std::ceil((1.0 - m_tokens) / m_rate));
+    }
+
+private:
+    double m_rate;       // Tokens per millisecond
+    int m_burst;
+    double m_tokens;
+    qint64 m_lastRefill;
+};
+
+#endif // TOKENBUCKET_H
@@ -0,0 +1,192 @@
+#include "traceanalyzer.h"
+#include "rateestimator.h"
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TraceAnalyzer::TraceAnalyzer(int tickInterval)
+    : m_tickInterval(tickInterval)
+    , m_minPresses(5)
+    , m_eventCount(0)
+    , m_pressCount(0)
+    , m_lastEventUs(0)
+    , m_idleUs(0)
+    , m_segment(0) {
+    m_keyIndex.fill(-1);
+}
+
+void TraceAnalyzer::addEvent(const InputTraceEvent &event) {
+    const qint64 sinceLast = event.timestampUs - m_lastEventUs;
+    if (m_eventCount > 0 && sinceLast > IdleBreakMs * 1000LL) {
+        ++m_segment;
+        m_idleUs += sinceLast;
+    }
+    ++m_eventCount;
+    m_lastEventUs = qMax(m_lastEventUs, event.timestampUs);
+
+    if (!event.down) {
+        return;
+    }
+    ++m_pressCount;
+
+    const int code = static_cast<int>(event.type) * 256 + event.key;
+    if (m_keyIndex[code] < 0) {
+        m_keyIndex[code] = m_keys.size();
+        m_keys.append(KeyStats{event.type, event.key, 0, -1, 0, 0, 0, 0, m_segment});
+    }
+
+    KeyStats &stats = m_keys[m_keyIndex[code]];
+    if (stats.presses > 0 && stats.lastSegment == m_segment) {
+        const qint64 gap = event.timestampUs - stats.lastPressUs;
+        stats.minGapUs = stats.minGapUs < 0 ? gap : qMin(stats.minGapUs, gap);
+        stats.maxGapUs = qMax(stats.maxGapUs, gap);
+        stats.gapSumUs += gap;
+        ++stats.gapCount;
+    }
+    ++stats.presses;
+    stats.lastPressUs = event.timestampUs;
+    stats.lastSegment = m_segment;
+}
+
+bool TraceAnalyzer::analyzeFile(const QString &filePath, QString *errorString,
+                                const std::function<void(int)> &progress) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    InputTraceReader reader(&file);
+    if (!reader.readHeader()) {
+        if (errorString) {
+            *errorString = reader.errorString();
+        }
+        return false;
+    }
+
+    const qint64 size = qMax<qint64>(1, file.size());
+    int lastPercent = -1;
+    InputTraceEvent event;
+    while (reader.next(&event)) {
+        addEvent(event);
+
+        if (progress && (reader.eventCount() & 0xFFFF) == 0) {
+            const int percent = static_cast<int>(file.pos() * 100 / size);
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                progress(percent);
+            }
+        }
+    }
+
+    if (reader.hasError()) {
+        if (errorString) {
+            *errorString = reader.errorString();
+        }
+        return false;
+    }
+    if (progress) {
+        progress(100);
+    }
+    return true;
+}
+
+QVector<TraceAnalyzer::KeyStats> TraceAnalyzer::keyStats() const {
+    return m_keys;
+}
+
+qint64 TraceAnalyzer::activeUs() const {
+    return m_lastEventUs - m_idleUs;
+}
+
+ClassProfile TraceAnalyzer::profile(const QString &name) const {
+    QVector<KeyStats> keys;
+    for (const KeyStats &stats : m_keys) {
+        if (stats.presses >= m_minPresses) {
+            keys.append(stats);
+        }
+    }
+    std::sort(keys.begin(), keys.end(),
+              [](const KeyStats &a, const KeyStats &b) { return a.presses > b.presses; });
+
+    ActionList actions;
+    QVector<double> weights;
+    QVector<double> observedShares;
+    qint64 keyboardPresses = 0;
+    for (const KeyStats &stats : keys) {
+        if (stats.type == InputType::Keyboard) {
+            keyboardPresses += stats.presses;
+        }
+    }
+
+    for (const KeyStats &stats : keys) {
+        // Pool entries grow with the square of the weight
+        const double weight = 100.0 * std::sqrt(double(stats.presses) / keys.first().presses);
+
+        KeyAction action;
+        action.type = stats.type;
+        action.key = stats.type == InputType::Keyboard ? stats.key : 0;
+        action.weight = qBound(1, qRound(weight), 100);
+        if (stats.gapCount > 0) {
+            action.minInterval = static_cast<int>(stats.minGapUs / 1000);
+            action.maxInterval = static_cast<int>((stats.maxGapUs + 999) / 1000);
+            action.interval = static_cast<int>(stats.gapSumUs / stats.gapCount / 1000);
+        }
+        actions.append(action);
+        weights.append(weight);
+        observedShares.append(stats.type == InputType::Keyboard && keyboardPresses > 0
+                              ? double(stats.presses) / keyboardPresses : 0.0);
+    }
+
+    // Cooldowns change how often the engine gets to press a key, so the
+    // plain squared mapping is corrected until the shares match. A share
+    // reacts less than quadratically to the weight of a key on cooldown, so
+    // the step is a bit larger than a square root; the best round is kept.
+    RateEstimator estimator(m_tickInterval);
+    ActionList bestActions = actions;
+    double bestError = std::numeric_limits<double>::max();
+    for (int round = 0; round < CalibrationRounds && keyboardPresses > 0; ++round) {
+        estimator.setActions(actions);
+        double totalRate = 0.0;
+        for (int i = 0; i < actions.size(); ++i) {
+            totalRate += estimator.ratePerMinute(i);
+        }
+        if (totalRate <= 0.0) {
+            break;
+        }
+
+        double worstError = 0.0;
+        double maxWeight = 0.0;
+        for (int i = 0; i < actions.size(); ++i) {
+            const double estimated = estimator.ratePerMinute(i) / totalRate;
+            if (observedShares[i] <= 0.0 || estimated <= 0.0) {
+                continue;
+            }
+            worstError = qMax(worstError, qAbs(estimated / observedShares[i] - 1.0));
+            weights[i] *= std::pow(observedShares[i] / estimated, 0.75);
+            maxWeight = qMax(maxWeight, weights[i]);
+        }
+        if (worstError < bestError) {
+            bestError = worstError;
+            bestActions = actions;
+        }
+        if (worstError < 0.02 || maxWeight <= 0.0) {
+            break;
+        }
+
+        for (int i = 0; i < actions.size(); ++i) {
+            if (observedShares[i] > 0.0) {
+                weights[i] *= 100.0 / maxWeight;
+                actions[i].weight = qBound(1, qRound(weights[i]), 100);
+            }
+        }
+    }
+
+    ClassProfile profile(name);
+    profile.setActions(bestActions);
+    profile.validate();
+    return profile;
+}
@@ -0,0 +1,73 @@
+#ifndef TRACEANALYZER_H
+#define TRACEANALYZER_H
+
+#include <QString>
+#include <QVector>
+#include <array>
+#include <functional>
+#include "classprofile.h"
+#include "inputtrace.h"
+
+// Derives a ClassProfile from a recorded input trace in a single pass. Only
+// a fixed table indexed by input and per-key counters are kept, so memory
+// does not grow with the length of the trace.
+//
+// For every key the analyzer tracks presses, the shortest gap between two
+// presses (minInterval) and the longest (maxInterval). Gaps spanning an idle
+// break, where no input at all arrived for IdleBreakMs, are ignored so menus
+// and pauses do not stretch maxInterval. Weights follow the engine's squared
+// model: a key pressed a quarter as often as the busiest one starts at
+// weight 50. They are then calibrated with RateEstimator until the engine's
+// estimated share of each key is close to its recorded share.
+class TraceAnalyzer {
+public:
+    struct KeyStats {
+        InputType type;
+        int key;
+        qint64 presses;
+        qint64 minGapUs;    // -1 until two presses within one segment were seen
+        qint64 maxGapUs;
+        qint64 gapSumUs;
+        qint64 gapCount;
+        qint64 lastPressUs;
+        int lastSegment;    // Segment of the last press, see IdleBreakMs
+    };
+
+    explicit TraceAnalyzer(int tickInterval);
+
+    void addEvent(const InputTraceEvent &event);
+    // Streams a trace file through addEvent(). progress receives 0-100.
+    bool analyzeFile(const QString &filePath, QString *errorString,
+                     const std::function<void(int)> &progress = std::function<void(int)>());
+
+    // Keys pressed fewer times are left out of the profile
+    void setMinPresses(int presses) { m_minPresses = presses; }
+
+    ClassProfile profile(const QString &name) const;
+
+    // Keys in the order of their first press
+    QVector<KeyStats> keyStats() const;
+    qint64 eventCount() const { return m_eventCount; }
+    qint64 pressCount() const { return m_pressCount; }
+    qint64 durationUs() const { return m_lastEventUs; }
+    qint64 activeUs() const;   // Duration without idle breaks
+
+    static const int IdleBreakMs = 10000;
+
+private:
+    static const int CalibrationRounds = 16;
+
+    int m_tickInterval;
+    int m_minPresses;
+    // Index into m_keys per type * 256 + key, -1 for inputs not seen yet
+    std::array<int, 3 * 256> m_keyIndex;
+    QVector<KeyStats> m_keys;
+
+    qint64 m_eventCount;
+    qint64 m_pressCount;
+    qint64 m_lastEventUs;
+    qint64 m_idleUs;
+    int m_segment;
+};
+
+#endif // TRACEANALYZER_H
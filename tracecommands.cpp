@@ -0,0 +1,260 @@
+#include "tracecommands.h"
+#include "inputtrace.h"
+#include "evdevdecoder.h"
+#include "traceanalyzer.h"
+#include "tracereplayer.h"
+#include "keysimulator.h"
+#include "sessionlog.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QTextStream>
+
+namespace {
+
+QString describeInput(InputType type, int key) {
+    switch (type) {
+    case InputType::Keyboard:
+        return QString("key 0x%1").arg(key, 2, 16, QChar('0'));
+    case InputType::MouseLeft:
+        return "mouse left";
+    case InputType::MouseRight:
+        return "mouse right";
+    }
+    return QString();
+}
+
+QString describeEvent(const InputTraceEvent &event) {
+    return QString("%1 ms  %2 %3")
+        .arg(event.timestampUs / 1000.0, 12, 'f', 3)
+        .arg(describeInput(event.type, event.key))
+        .arg(event.down ? "down" : "up");
+}
+
+// Converts a raw /dev/input/eventN dump into a trace
+int importEvdev(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (args.size() < 2) {
+        err << "Usage: --trace-import-evdev <dump> <trace.aktrace>" << Qt::endl;
+        return 1;
+    }
+
+    QFile dump(args[0]);
+    if (!dump.open(QIODevice::ReadOnly)) {
+        err << args[0] << ": " << dump.errorString() << Qt::endl;
+        return 1;
+    }
+    QFile trace(args[1]);
+    if (!trace.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        err << args[1] << ": " << trace.errorString() << Qt::endl;
+        return 1;
+    }
+
+    EvdevDecoder decoder;
+    InputTraceWriter writer(&trace);
+    QVector<InputTraceEvent> events;
+    bool started = false;
+    bool ok = true;
+    while (ok && !dump.atEnd()) {
+        const QByteArray block = dump.read(4096 * EvdevDecoder::RecordSize);
+        events.clear();
+        decoder.feed(block.constData(), block.size(), &events);
+        for (const InputTraceEvent &event : events) {
+            if (!started) {
+                // Evdev timestamps are wall-clock unless the device was switched
+                ok = writer.begin(event.timestampUs, event.timestampUs);
+                started = true;
+            }
+            ok = ok && writer.append(event);
+        }
+    }
+    if (!started) {
+        ok = writer.begin(0, 0);
+    }
+    ok = ok && writer.flush();
+
+    if (!ok) {
+        err << args[1] << ": " << trace.errorString() << Qt::endl;
+        return 1;
+    }
+    out << decoder.recordCount() << " records, " << writer.eventCount() << " events, "
+        << writer.bytesWritten() << " bytes" << Qt::endl;
+    return 0;
+}
+
+// Prints the events of a trace, optionally only the first N
+int dumpTrace(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (args.isEmpty()) {
+        err << "Usage: --trace-dump <trace.aktrace> [max events]" << Qt::endl;
+        return 1;
+    }
+
+    QFile file(args[0]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << args[0] << ": " << file.errorString() << Qt::endl;
+        return 1;
+    }
+
+    InputTraceReader reader(&file);
+    if (!reader.readHeader()) {
+        err << args[0] << ": " << reader.errorString() << Qt::endl;
+        return 1;
+    }
+
+    const qint64 limit = args.value(1, "-1").toLongLong();
+    InputTraceEvent event;
+    while ((limit < 0 || reader.eventCount() < limit) && reader.next(&event)) {
+        out << describeEvent(event) << '\n';
+    }
+    out << reader.eventCount() << " events" << Qt::endl;
+
+    if (reader.hasError()) {
+        err << args[0] << ": " << reader.errorString() << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Derives a profile from a trace and prints it as JSON, ready to be added
+// to the "profiles" array of config.json
+int analyzeTrace(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (args.isEmpty()) {
+        err << "Usage: --trace-analyze <trace.aktrace> [profile name] [min presses]" << Qt::endl;
+        return 1;
+    }
+
+    TraceAnalyzer analyzer(KeySimulator::TickInterval);
+    if (args.size() > 2) {
+        analyzer.setMinPresses(args[2].toInt());
+    }
+
+    QString error;
+    if (!analyzer.analyzeFile(args[0], &error)) {
+        err << args[0] << ": " << error << Qt::endl;
+        return 1;
+    }
+
+    // Statistics go to stderr so stdout is only the profile
+    const double activeMinutes = qMax<qint64>(1, analyzer.activeUs()) / 60e6;
+    err << analyzer.eventCount() << " events, " << analyzer.pressCount() << " presses, "
+        << QString::number(activeMinutes, 'f', 1) << " active minutes" << Qt::endl;
+    for (const TraceAnalyzer::KeyStats &stats : analyzer.keyStats()) {
+        err << describeInput(stats.type, stats.key) << ": "
+            << stats.presses << " presses, "
+            << QString::number(stats.presses / activeMinutes, 'f', 1) << "/min";
+        if (stats.gapCount > 0) {
+            err << ", gaps " << stats.minGapUs / 1000 << "-" << stats.maxGapUs / 1000 << " ms";
+        }
+        err << Qt::endl;
+    }
+
+    const QString name = args.value(1, QFileInfo(args[0]).completeBaseName());
+    out << QJsonDocument(analyzer.profile(name).toJson()).toJson(QJsonDocument::Indented);
+    return 0;
+}
+
+// Replays a trace with its original timing and reports the timing error.
+// With --dry-run nothing is sent, which measures the scheduler alone.
+int replayTrace(QStringList args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    TraceReplayer::Options options;
+    options.inject = !args.removeAll("--dry-run");
+    if (args.isEmpty()) {
+        err << "Usage: --trace-replay <trace.aktrace> [speed] [loops] [--dry-run]" << Qt::endl;
+        return 1;
+    }
+    options.speed = args.value(1, "1").toDouble();
+    options.loops = qMax(1, args.value(2, "1").toInt());
+
+    TraceReplayer replayer;
+    QString error;
+    if (!replayer.start(args[0], options, &error)) {
+        err << args[0] << ": " << error << Qt::endl;
+        return 1;
+    }
+    replayer.waitForFinished();
+
+    out << replayer.stats().summary() << Qt::endl;
+    if (!replayer.errorString().isEmpty()) {
+        err << args[0] << ": " << replayer.errorString() << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Summarizes a session log written while the simulation ran: presses per
+// key, their rate over the session and the distribution of the gaps between them
+int sessionSummary(const QStringList &args) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (args.isEmpty()) {
+        err << "Usage: --trace-session <session.aksession> [bucket ms]" << Qt::endl;
+        return 1;
+    }
+
+    SessionLog log;
+    QString error;
+    if (!log.load(args[0], &error)) {
+        err << args[0] << ": " << error << Qt::endl;
+        return 1;
+    }
+
+    const int bucketMs = qMax(1, args.value(1, "60000").toInt());
+    const qint64 duration = log.lastTimestamp() - log.firstTimestamp();
+    out << log.eventCount() << " presses in " << duration / 1000 << " s, "
+        << log.memoryBytes() << " bytes packed" << Qt::endl;
+
+    const int gapBuckets = 8;
+    const int gapBucketMs = 250;
+    for (int key : log.keys()) {
+        const QVector<int> rate = log.keyRate(key, bucketMs);
+        int peak = 0;
+        for (int count : rate) {
+            peak = qMax(peak, count);
+        }
+        out << '\n' << describeInput(InputType::Keyboard, key) << ": " << log.eventCount(key)
+            << " presses, " << QString::number(log.eventCount(key) * 1000.0 / qMax<qint64>(1, duration), 'f', 2)
+            << "/s, peak " << peak << " per " << bucketMs << " ms" << Qt::endl;
+
+        const QVector<int> gaps = log.gapHistogram(key, gapBucketMs, gapBuckets);
+        for (int i = 0; i < gaps.size(); ++i) {
+            const QString range = i + 1 < gaps.size()
+                ? QString("%1-%2 ms").arg(i * gapBucketMs).arg((i + 1) * gapBucketMs)
+                : QString(">= %1 ms").arg(i * gapBucketMs);
+            out << "  gap " << range.rightJustified(13) << "  " << gaps[i] << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int runTraceCommand(const QStringList &arguments) {
+    const QString name = arguments.value(1);
+    const QStringList args = arguments.mid(2);
+
+    if (name == "--trace-import-evdev") {
+        return importEvdev(args);
+    }
+    if (name == "--trace-dump") {
+        return dumpTrace(args);
+    }
+    if (name == "--trace-analyze") {
+        return analyzeTrace(args);
+    }
+    if (name == "--trace-replay") {
+        return replayTrace(args);
+    }
+    if (name == "--trace-session") {
+        return sessionSummary(args);
+    }
+
+    QTextStream(stderr) << "Unknown trace command: " << name << Qt::endl;
+    return 1;
+}
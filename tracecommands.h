@@ -0,0 +1,10 @@
+#ifndef TRACECOMMANDS_H
+#define TRACECOMMANDS_H
+
+#include <QStringList>
+
+// Headless input trace tools, run as "AutoKey --trace-<name> [args]".
+// Returns the process exit code.
+int runTraceCommand(const QStringList &arguments);
+
+#endif // TRACECOMMANDS_H
@@ -0,0 +1,114 @@
+#include "tracerecorder.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <chrono>
+
+TraceRecorder::TraceRecorder()
+    : m_stopping(false)
+    , m_writeFailed(false)
+    , m_eventCount(0)
+    , m_bytesWritten(0)
+    , m_recording(false) {
+}
+
+TraceRecorder::~TraceRecorder() {
+    stop();
+}
+
+qint64 TraceRecorder::clockUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool TraceRecorder::start(const QString &filePath, QString *errorString) {
+    if (m_recording) {
+        stop();
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) {
+            *errorString = m_file.errorString();
+        }
+        return false;
+    }
+
+    // A fresh ring, so nothing pushed after the last stop() leaks in
+    m_ring.reset(new EventRing());
+    m_writer.reset(new InputTraceWriter(&m_file));
+    if (!m_writer->begin(QDateTime::currentMSecsSinceEpoch() * 1000, clockUs())) {
+        if (errorString) {
+            *errorString = m_file.errorString();
+        }
+        m_writer.reset();
+        m_file.close();
+        return false;
+    }
+
+    m_stopping = false;
+    m_writeFailed = false;
+    m_eventCount = 0;
+    m_bytesWritten = m_writer->bytesWritten();
+    m_recording = true;
+    m_writerThread = std::thread([this]() { writerLoop(); });
+
+    qDebug() << "Recording input to" << filePath;
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!m_recording) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_writerThread.join();
+    m_file.close();
+    m_writer.reset();
+    m_recording = false;
+
+    qDebug() << "Recording stopped:" << eventCount() << "events," << bytesWritten() << "bytes,"
+             << droppedEvents() << "dropped";
+}
+
+void TraceRecorder::writerLoop() {
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (!m_wake.wait_for(lock, std::chrono::milliseconds(DrainInterval), [this]() { return m_stopping; })) {
+        lock.unlock();
+        drainRing();
+        if (sinceFlush.elapsed() >= FileFlushInterval) {
+            if (!m_writer->flush()) {
+                m_writeFailed = true;
+            }
+            m_file.flush();
+            sinceFlush.restart();
+        }
+        m_bytesWritten = m_writer->bytesWritten();
+        lock.lock();
+    }
+    lock.unlock();
+
+    // Events pushed before the capture source was stopped
+    drainRing();
+    if (!m_writer->flush()) {
+        m_writeFailed = true;
+    }
+    m_bytesWritten = m_writer->bytesWritten();
+}
+
+void TraceRecorder::drainRing() {
+    m_ring->drain([this](const InputTraceEvent &event) {
+        if (!m_writer->append(event)) {
+            m_writeFailed = true;
+        }
+    });
+    m_eventCount = m_writer->eventCount();
+}
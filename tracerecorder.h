@@ -0,0 +1,68 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "inputtrace.h"
+#include "spscring.h"
+
+// Records input events to a trace file. Capture sources push events into a
+// lock-free ring and return immediately; a background writer drains the
+// ring, encodes the events and writes them in large blocks, so capturing
+// costs the input thread next to nothing.
+class TraceRecorder {
+public:
+    TraceRecorder();
+    ~TraceRecorder();
+
+    bool start(const QString &filePath, QString *errorString);
+    // Writes the remaining events and closes the file. Capture sources must
+    // be stopped first.
+    void stop();
+    bool isRecording() const { return m_recording; }
+
+    // Producer side, for exactly one capture thread. Never blocks; events
+    // are dropped if the writer falls behind by a whole ring.
+    void record(const InputTraceEvent &event) { m_ring->push(event); }
+
+    qint64 eventCount() const { return m_eventCount.load(std::memory_order_relaxed); }
+    qint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 droppedEvents() const { return m_ring ? m_ring->dropped() : 0; }
+    bool hasWriteError() const { return m_writeFailed.load(std::memory_order_relaxed); }
+
+    // Clock for event timestamps: monotonic microseconds, the same clock
+    // evdev timestamps use once switched to CLOCK_MONOTONIC
+    static qint64 clockUs();
+
+private:
+    using EventRing = SpscRing<InputTraceEvent, 16384>;
+
+    void writerLoop();
+    void drainRing();
+
+    // The ring holds 16384 events, enough for minutes of input between drains
+    static const int DrainInterval = 100;
+    // Bytes reach the file at least this often, limiting the loss on a crash
+    static const int FileFlushInterval = 2000;
+
+    std::unique_ptr<EventRing> m_ring;
+    QFile m_file;
+    std::unique_ptr<InputTraceWriter> m_writer;
+    // Runs for the whole recording, so not on the global thread pool;
+    // stop() wakes it through m_wake
+    std::thread m_writerThread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stopping;  // Guarded by m_wakeMutex
+    std::atomic<bool> m_writeFailed;
+    std::atomic<qint64> m_eventCount;
+    std::atomic<qint64> m_bytesWritten;
+    bool m_recording;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,235 @@
+#include "tracereplayer.h"
+#include "tracerecorder.h"
+#include "keysimulator.h"
+#include <QDebug>
+#include <chrono>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#include <mmsystem.h>
+#endif
+
+QString TraceReplayer::Stats::summary() const {
+    return QString("%1 events in %2 loop(s), timing error mean %3 us, p99 %4 us, max %5 us, %6 late")
+        .arg(events)
+        .arg(loops)
+        .arg(meanErrorUs)
+        .arg(p99ErrorUs)
+        .arg(maxErrorUs)
+        .arg(lateEvents);
+}
+
+TraceReplayer::TraceReplayer(QObject *parent)
+    : QObject(parent)
+    , m_data(nullptr)
+    , m_stopping(false)
+    , m_running(false)
+    , m_heldMouse{false, false}
+    , m_errorSumUs(0) {
+}
+
+TraceReplayer::~TraceReplayer() {
+    stop();
+}
+
+bool TraceReplayer::start(const QString &filePath, const Options &options, QString *errorString) {
+    stop();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = m_file.errorString();
+        }
+        return false;
+    }
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data) {
+        if (errorString) {
+            *errorString = m_file.errorString();
+        }
+        m_file.close();
+        return false;
+    }
+
+    // Reject a bad file here rather than from the replay thread
+    InputTraceCursor cursor(m_data, m_file.size());
+    if (!cursor.readHeader()) {
+        if (errorString) {
+            *errorString = cursor.errorString();
+        }
+        unmap();
+        return false;
+    }
+
+    m_options = options;
+    m_options.speed = qBound(0.01, options.speed, 100.0);
+    m_stopping = false;
+    m_running = true;
+    m_thread.reset(QThread::create([this]() { replayLoop(); }));
+    m_thread->start(QThread::TimeCriticalPriority);
+
+    qDebug() << "Replaying" << filePath << "at speed" << m_options.speed;
+    return true;
+}
+
+void TraceReplayer::stop() {
+    m_stopping = true;
+    waitForFinished();
+    m_thread.reset();
+    unmap();
+}
+
+void TraceReplayer::waitForFinished() {
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+void TraceReplayer::unmap() {
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+}
+
+void TraceReplayer::replayLoop() {
+#ifdef Q_OS_WIN
+    // Sleeps are otherwise rounded up to the 15.6 ms system tick
+    timeBeginPeriod(1);
+#endif
+    m_heldKeys.reset();
+    m_heldMouse[0] = m_heldMouse[1] = false;
+    m_histogram.fill(0);
+    m_errorSumUs = 0;
+    m_stats = Stats();
+    m_errorString.clear();
+
+    InputTraceCursor cursor(m_data, m_file.size());
+    cursor.readHeader();
+
+    // Deadlines are absolute; each one is derived from the trace and the
+    // base time, never from when the previous event was actually sent
+    qint64 base = TraceRecorder::clockUs();
+    qint64 deadline = base;
+    InputTraceEvent event;
+    while (!m_stopping) {
+        qint64 firstTimestamp = -1;
+        while (!m_stopping && cursor.next(&event)) {
+            if (firstTimestamp < 0) {
+                firstTimestamp = event.timestampUs;
+            }
+            deadline = base + static_cast<qint64>((event.timestampUs - firstTimestamp) / m_options.speed);
+            if (!waitUntil(deadline)) {
+                break;
+            }
+
+            send(event);
+            recordError(TraceRecorder::clockUs() - deadline);
+        }
+        if (m_stopping) {
+            break;
+        }
+        if (cursor.hasError()) {
+            m_errorString = cursor.errorString();
+            break;
+        }
+
+        // A trace cut off by a crash may end with keys down
+        releaseHeld();
+        ++m_stats.loops;
+        if (firstTimestamp < 0 || (m_options.loops > 0 && m_stats.loops >= m_options.loops)) {
+            break;
+        }
+        cursor.rewind();
+        base = deadline + LoopGapUs;
+    }
+    releaseHeld();
+
+    // Percentile from the histogram, at bucket resolution
+    qint64 counted = 0;
+    const qint64 rank = m_stats.events - m_stats.events / 100;
+    for (int bucket = 0; bucket < HistogramBuckets; ++bucket) {
+        counted += m_histogram[bucket];
+        if (counted >= rank && m_stats.events > 0) {
+            m_stats.p99ErrorUs = qMin<qint64>((bucket + 1) * HistogramResolutionUs, m_stats.maxErrorUs);
+            break;
+        }
+    }
+    m_stats.meanErrorUs = m_stats.events > 0 ? m_errorSumUs / m_stats.events : 0;
+
+#ifdef Q_OS_WIN
+    timeEndPeriod(1);
+#endif
+
+    qDebug() << "Replay finished:" << m_stats.summary();
+    m_running.store(false, std::memory_order_release);
+    emit finished();
+}
+
+bool TraceReplayer::waitUntil(qint64 deadlineUs) {
+    for (;;) {
+        if (m_stopping.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const qint64 remaining = deadlineUs - TraceRecorder::clockUs();
+        if (remaining <= 0) {
+            return true;
+        }
+        if (remaining > SpinThresholdUs) {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(qMin(remaining - SpinThresholdUs, MaxSleepUs)));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TraceReplayer::send(const InputTraceEvent &event) {
+    if (event.type == InputType::Keyboard) {
+        // A repeated transition, e.g. a release that was never pressed, is
+        // dropped so the replay never leaves the keyboard inconsistent
+        if (m_heldKeys.test(event.key) == event.down) {
+            return;
+        }
+        m_heldKeys.set(event.key, event.down);
+        if (m_options.inject) {
+            KeySimulator::simulateKeyEvent(event.key, !event.down);
+        }
+    } else {
+        const bool left = event.type == InputType::MouseLeft;
+        bool &held = m_heldMouse[left ? 0 : 1];
+        if (held == event.down) {
+            return;
+        }
+        held = event.down;
+        if (m_options.inject) {
+            KeySimulator::simulateMouseEvent(left, !event.down);
+        }
+    }
+}
+
+void TraceReplayer::releaseHeld() {
+    for (int key = 0; key < 256; ++key) {
+        if (m_heldKeys.test(key)) {
+            send(InputTraceEvent{0, InputType::Keyboard, static_cast<quint8>(key), false});
+        }
+    }
+    if (m_heldMouse[0]) {
+        send(InputTraceEvent{0, InputType::MouseLeft, 0, false});
+    }
+    if (m_heldMouse[1]) {
+        send(InputTraceEvent{0, InputType::MouseRight, 0, false});
+    }
+}
+
+void TraceReplayer::recordError(qint64 errorUs) {
+    errorUs = qMax<qint64>(0, errorUs);
+    ++m_stats.events;
+    m_errorSumUs += errorUs;
+    m_stats.maxErrorUs = qMax(m_stats.maxErrorUs, errorUs);
+    if (errorUs > LateThresholdUs) {
+        ++m_stats.lateEvents;
+    }
+    m_histogram[qMin<qint64>(errorUs / HistogramResolutionUs, HistogramBuckets - 1)]++;
+}
@@ -0,0 +1,98 @@
+#ifndef TRACEREPLAYER_H
+#define TRACEREPLAYER_H
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include "inputtrace.h"
+
+// Plays a recorded input trace back with its original timing. The trace is
+// memory-mapped and decoded in place, and every event is sent at an
+// absolute deadline on the monotonic clock: the replay thread sleeps until
+// shortly before the deadline and spins for the rest, so sleep overshoot
+// never accumulates over a long trace.
+class TraceReplayer : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        double speed = 1.0;   // 2.0 plays twice as fast
+        int loops = 1;        // 0 repeats until stopped
+        bool inject = true;   // false only measures timing
+    };
+
+    // Timing error is how late an event was sent relative to its deadline
+    struct Stats {
+        qint64 events = 0;
+        int loops = 0;
+        qint64 meanErrorUs = 0;
+        qint64 p99ErrorUs = 0;
+        qint64 maxErrorUs = 0;
+        qint64 lateEvents = 0;  // Sent more than LateThresholdUs after the deadline
+
+        QString summary() const;
+    };
+
+    explicit TraceReplayer(QObject *parent = nullptr);
+    ~TraceReplayer();
+
+    bool start(const QString &filePath, const Options &options, QString *errorString);
+    // Stops at the next event and releases keys that are still held down
+    void stop();
+    void waitForFinished();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Valid once finished() was emitted
+    Stats stats() const { return m_stats; }
+    QString errorString() const { return m_errorString; }
+
+    static constexpr qint64 LateThresholdUs = 1000;
+
+signals:
+    // Emitted from the replay thread when the trace ends or was stopped
+    void finished();
+
+private:
+    void replayLoop();
+    // Returns false if stopped while waiting
+    bool waitUntil(qint64 deadlineUs);
+    void send(const InputTraceEvent &event);
+    void releaseHeld();
+    void recordError(qint64 errorUs);
+    void unmap();
+
+    // Waits longer than this sleep, the rest is spun; covers the scheduler
+    // granularity once the system timer runs at 1 ms
+    static constexpr qint64 SpinThresholdUs = 2000;
+    // Long pauses in a trace are slept in slices so stop() stays responsive
+    static constexpr qint64 MaxSleepUs = 50000;
+    // Pause between the end of the trace and the start of the next loop
+    static constexpr qint64 LoopGapUs = 100000;
+    // Error histogram in 10 us buckets; the last bucket collects the rest
+    static const int HistogramBuckets = 1001;
+    static const int HistogramResolutionUs = 10;
+
+    QFile m_file;
+    uchar *m_data;
+    Options m_options;
+    // A thread of its own: it runs at time-critical priority, with loops = 0
+    // until stopped, and must not take a thread from the global pool
+    std::unique_ptr<QThread> m_thread;
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_running;
+
+    // Replay thread state
+    std::bitset<256> m_heldKeys;
+    bool m_heldMouse[2];
+    std::array<qint64, HistogramBuckets> m_histogram;
+    qint64 m_errorSumUs;
+    Stats m_stats;
+    QString m_errorString;
+};
+
+#endif // TRACEREPLAYER_H
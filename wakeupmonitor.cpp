@@ -0,0 +1,34 @@
+#include "wakeupmonitor.h"
+#include <QAbstractEventDispatcher>
+
+WakeupMonitor::WakeupMonitor(QObject *parent)
+    : QObject(parent)
+    , m_count(0)
+    , m_lastRate(-1) {
+    m_window.start();
+    if (QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance()) {
+        connect(dispatcher, &QAbstractEventDispatcher::awake, this, &WakeupMonitor::onAwake);
+    }
+}
+
+int WakeupMonitor::wakeupsPerMinute() const {
+    if (m_lastRate >= 0) {
+        return m_lastRate;
+    }
+
+    const qint64 elapsed = qMax<qint64>(1, m_window.elapsed());
+    return static_cast<int>(m_count * WindowMs / elapsed);
+}
+
+void WakeupMonitor::onAwake() {
+    ++m_count;
+
+    // A window that spanned a long sleep is averaged over its whole length
+    const qint64 elapsed = m_window.elapsed();
+    if (elapsed >= WindowMs) {
+        m_lastRate = static_cast<int>(m_count * WindowMs / elapsed);
+        m_count = 0;
+        m_window.restart();
+        emit rateUpdated(m_lastRate);
+    }
+}
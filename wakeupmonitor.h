@@ -0,0 +1,35 @@
+#ifndef WAKEUPMONITOR_H
+#define WAKEUPMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+// Counts how often the GUI thread's event loop wakes up, as a measure of the
+// application's idle cost. The count is only looked at when the loop wakes
+// anyway, so watching it never adds a wakeup of its own.
+class WakeupMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WakeupMonitor(QObject *parent = nullptr);
+
+    // Wakeups per minute over the last completed one-minute window, or an
+    // estimate from the current window before the first one completes
+    int wakeupsPerMinute() const;
+
+signals:
+    // Emitted when a measurement window completes
+    void rateUpdated(int wakeupsPerMinute);
+
+private slots:
+    void onAwake();
+
+private:
+    static const int WindowMs = 60000;
+
+    QElapsedTimer m_window;
+    qint64 m_count;
+    int m_lastRate;
+};
+
+#endif // WAKEUPMONITOR_H
@@ -0,0 +1,87 @@
+#include "win32foregroundwatcher.h"
+
+#ifdef Q_OS_WIN
+
+#include "focusgate.h"
+#include <QFileInfo>
+
+Win32ForegroundWatcher *Win32ForegroundWatcher::s_active = nullptr;
+
+Win32ForegroundWatcher::Win32ForegroundWatcher()
+    : m_hook(nullptr)
+    , m_gate(nullptr) {
+}
+
+Win32ForegroundWatcher::~Win32ForegroundWatcher() {
+    stop();
+}
+
+bool Win32ForegroundWatcher::start(FocusGate *gate, QString *errorString) {
+    if (s_active) {
+        if (errorString) {
+            *errorString = "The foreground window is already being watched";
+        }
+        return false;
+    }
+
+    // AutoKey's own windows are reported too: focusing it must close the gate
+    m_hook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr,
+                             eventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (!m_hook) {
+        if (errorString) {
+            *errorString = QString("Could not install the focus hook (error %1)").arg(GetLastError());
+        }
+        return false;
+    }
+
+    m_gate = gate;
+    s_active = this;
+    m_gate->foregroundChanged(describe(GetForegroundWindow()));
+    return true;
+}
+
+void Win32ForegroundWatcher::stop() {
+    if (m_hook) {
+        UnhookWinEvent(m_hook);
+        m_hook = nullptr;
+    }
+    if (s_active == this) {
+        s_active = nullptr;
+    }
+    m_gate = nullptr;
+}
+
+void CALLBACK Win32ForegroundWatcher::eventProc(HWINEVENTHOOK, DWORD event, HWND window,
+                                                LONG objectId, LONG, DWORD, DWORD) {
+    if (!s_active || event != EVENT_SYSTEM_FOREGROUND || objectId != OBJID_WINDOW) {
+        return;
+    }
+    s_active->m_gate->foregroundChanged(describe(window));
+}
+
+ForegroundWindow Win32ForegroundWatcher::describe(HWND window) {
+    ForegroundWindow result;
+    if (!window) {
+        return result;
+    }
+    result.id = reinterpret_cast<quintptr>(window);
+
+    wchar_t title[256];
+    const int length = GetWindowTextW(window, title, 256);
+    result.title = QString::fromWCharArray(title, length);
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (process) {
+        wchar_t path[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameW(process, 0, path, &size)) {
+            result.processName = QFileInfo(QString::fromWCharArray(path, size)).fileName();
+        }
+        CloseHandle(process);
+    }
+    return result;
+}
+
+#endif // Q_OS_WIN
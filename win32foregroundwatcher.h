@@ -0,0 +1,38 @@
+#ifndef WIN32FOREGROUNDWATCHER_H
+#define WIN32FOREGROUNDWATCHER_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_WIN
+
+#include <windows.h>
+#include "foregroundwatcher.h"
+
+// Observes EVENT_SYSTEM_FOREGROUND through an out-of-context WinEvent hook.
+// Windows delivers the event through the GUI thread's message queue, so the
+// gate is updated on the thread that owns the engine, and only when the
+// foreground window actually changes.
+class Win32ForegroundWatcher : public ForegroundWatcher {
+public:
+    Win32ForegroundWatcher();
+    ~Win32ForegroundWatcher();
+
+    QString name() const override { return "WinEvent hook"; }
+    bool start(FocusGate *gate, QString *errorString) override;
+    void stop() override;
+
+private:
+    static void CALLBACK eventProc(HWINEVENTHOOK hook, DWORD event, HWND window,
+                                   LONG objectId, LONG childId, DWORD thread, DWORD time);
+    static ForegroundWindow describe(HWND window);
+
+    // The hook callback carries no context; only one watcher runs at a time
+    static Win32ForegroundWatcher *s_active;
+
+    HWINEVENTHOOK m_hook;
+    FocusGate *m_gate;
+};
+
+#endif // Q_OS_WIN
+
+#endif // WIN32FOREGROUNDWATCHER_H
@@ -0,0 +1,62 @@
+#include "win32hotkeybackend.h"
+
+#ifdef Q_OS_WIN
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <windows.h>
+
+#ifndef MOD_NOREPEAT
+#define MOD_NOREPEAT 0x4000
+#endif
+
+Win32HotkeyBackend::Win32HotkeyBackend(HotkeyRegistry *registry)
+    : m_registry(registry)
+    , m_nextId(1) {
+    QCoreApplication::instance()->installNativeEventFilter(this);
+}
+
+Win32HotkeyBackend::~Win32HotkeyBackend() {
+    releaseAll();
+    if (QCoreApplication::instance()) {
+        QCoreApplication::instance()->removeNativeEventFilter(this);
+    }
+}
+
+bool Win32HotkeyBackend::grab(const HotkeyChord &chord) {
+    // MOD_NOREPEAT: holding the chord down triggers it once
+    const int id = m_nextId++;
+    if (!RegisterHotKey(nullptr, id, chord.modifiers | MOD_NOREPEAT, chord.key)) {
+        qDebug() << "RegisterHotKey failed for" << chord.toString() << "error" << GetLastError();
+        return false;
+    }
+    m_ids.append(id);
+    return true;
+}
+
+void Win32HotkeyBackend::releaseAll() {
+    for (int id : m_ids) {
+        UnregisterHotKey(nullptr, id);
+    }
+    m_ids.clear();
+    m_nextId = 1;
+}
+
+bool Win32HotkeyBackend::nativeEventFilter(const QByteArray &eventType, void *message, long *result) {
+    Q_UNUSED(result);
+    if (eventType != "windows_generic_MSG") {
+        return false;
+    }
+
+    MSG *msg = static_cast<MSG *>(message);
+    if (msg->message != WM_HOTKEY || msg->hwnd != nullptr) {
+        return false;
+    }
+
+    // The message time has the resolution of the system tick (10-16 ms), so
+    // the queueing delay is coarse; the handler time is measured exactly
+    const qint64 ageUs = static_cast<qint64>(static_cast<DWORD>(GetTickCount() - msg->time)) * 1000;
+    return m_registry->dispatch(LOWORD(msg->lParam), HIWORD(msg->lParam), ageUs);
+}
+
+#endif // Q_OS_WIN
@@ -0,0 +1,35 @@
+#ifndef WIN32HOTKEYBACKEND_H
+#define WIN32HOTKEYBACKEND_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_WIN
+
+#include <QAbstractNativeEventFilter>
+#include <QVector>
+#include "hotkeyregistry.h"
+
+// Registers chords with RegisterHotKey() on the GUI thread instead of a
+// window, so hotkeys work before (and without) the main window being shown.
+// WM_HOTKEY arrives as a thread message and is picked up by a native event
+// filter.
+class Win32HotkeyBackend : public HotkeyBackend, public QAbstractNativeEventFilter {
+public:
+    explicit Win32HotkeyBackend(HotkeyRegistry *registry);
+    ~Win32HotkeyBackend();
+
+    QString name() const override { return "Win32"; }
+    bool grab(const HotkeyChord &chord) override;
+    void releaseAll() override;
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
+
+private:
+    HotkeyRegistry *m_registry;
+    QVector<int> m_ids;
+    int m_nextId;
+};
+
+#endif // Q_OS_WIN
+
+#endif // WIN32HOTKEYBACKEND_H
@@ -0,0 +1,94 @@
+#include "win32inputcapture.h"
+
+#ifdef Q_OS_WIN
+
+#include "tracerecorder.h"
+
+Win32InputCapture *Win32InputCapture::s_active = nullptr;
+
+Win32InputCapture::Win32InputCapture()
+    : m_keyboardHook(nullptr)
+    , m_mouseHook(nullptr)
+    , m_recorder(nullptr) {
+}
+
+Win32InputCapture::~Win32InputCapture() {
+    stop();
+}
+
+bool Win32InputCapture::start(TraceRecorder *recorder, QString *errorString) {
+    if (s_active) {
+        if (errorString) {
+            *errorString = "Input is already being captured";
+        }
+        return false;
+    }
+
+    m_recorder = recorder;
+    m_held.reset();
+    s_active = this;
+
+    HINSTANCE module = GetModuleHandle(nullptr);
+    m_keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, keyboardProc, module, 0);
+    m_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, mouseProc, module, 0);
+    if (!m_keyboardHook || !m_mouseHook) {
+        if (errorString) {
+            *errorString = QString("Could not install input hooks (error %1)").arg(GetLastError());
+        }
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void Win32InputCapture::stop() {
+    if (m_keyboardHook) {
+        UnhookWindowsHookEx(m_keyboardHook);
+        m_keyboardHook = nullptr;
+    }
+    if (m_mouseHook) {
+        UnhookWindowsHookEx(m_mouseHook);
+        m_mouseHook = nullptr;
+    }
+    if (s_active == this) {
+        s_active = nullptr;
+    }
+    m_recorder = nullptr;
+}
+
+void Win32InputCapture::capture(InputType type, int key, bool down) {
+    InputTraceEvent event;
+    event.timestampUs = TraceRecorder::clockUs();
+    event.type = type;
+    event.key = static_cast<quint8>(key);
+    event.down = down;
+    m_recorder->record(event);
+}
+
+LRESULT CALLBACK Win32InputCapture::keyboardProc(int code, WPARAM wParam, LPARAM lParam) {
+    const KBDLLHOOKSTRUCT *info = reinterpret_cast<const KBDLLHOOKSTRUCT *>(lParam);
+    if (code == HC_ACTION && s_active && !(info->flags & LLKHF_INJECTED) && info->vkCode < 256) {
+        const bool down = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+        if (s_active->m_held[info->vkCode] != down) {
+            s_active->m_held[info->vkCode] = down;
+            s_active->capture(InputType::Keyboard, static_cast<int>(info->vkCode), down);
+        }
+    }
+    return CallNextHookEx(nullptr, code, wParam, lParam);
+}
+
+LRESULT CALLBACK Win32InputCapture::mouseProc(int code, WPARAM wParam, LPARAM lParam) {
+    const MSLLHOOKSTRUCT *info = reinterpret_cast<const MSLLHOOKSTRUCT *>(lParam);
+    if (code == HC_ACTION && s_active && !(info->flags & LLMHF_INJECTED)) {
+        switch (wParam) {
+        case WM_LBUTTONDOWN: s_active->capture(InputType::MouseLeft, 0, true); break;
+        case WM_LBUTTONUP: s_active->capture(InputType::MouseLeft, 0, false); break;
+        case WM_RBUTTONDOWN: s_active->capture(InputType::MouseRight, 0, true); break;
+        case WM_RBUTTONUP: s_active->capture(InputType::MouseRight, 0, false); break;
+        default: break;
+        }
+    }
+    return CallNextHookEx(nullptr, code, wParam, lParam);
+}
+
+#endif // Q_OS_WIN
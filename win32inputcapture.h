@@ -0,0 +1,42 @@
+#ifndef WIN32INPUTCAPTURE_H
+#define WIN32INPUTCAPTURE_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_WIN
+
+#include <bitset>
+#include <windows.h>
+#include "inputcapture.h"
+#include "classprofile.h"
+
+// Captures input with low-level keyboard and mouse hooks on the GUI thread.
+// Events injected with SendInput, including AutoKey's own presses, are
+// skipped. The hook callbacks only push into the recorder's ring, well
+// within the time Windows allows a low-level hook.
+class Win32InputCapture : public InputCaptureSource {
+public:
+    Win32InputCapture();
+    ~Win32InputCapture();
+
+    QString name() const override { return "Win32 hooks"; }
+    bool start(TraceRecorder *recorder, QString *errorString) override;
+    void stop() override;
+
+private:
+    static LRESULT CALLBACK keyboardProc(int code, WPARAM wParam, LPARAM lParam);
+    static LRESULT CALLBACK mouseProc(int code, WPARAM wParam, LPARAM lParam);
+    void capture(InputType type, int key, bool down);
+
+    // Hook callbacks carry no context; only one capture runs at a time
+    static Win32InputCapture *s_active;
+
+    HHOOK m_keyboardHook;
+    HHOOK m_mouseHook;
+    TraceRecorder *m_recorder;
+    std::bitset<256> m_held;  // Keys currently down, to drop auto-repeat
+};
+
+#endif // Q_OS_WIN
+
+#endif // WIN32INPUTCAPTURE_H
@@ -0,0 +1,171 @@
+#include "x11foregroundwatcher.h"
+
+#ifdef AUTOKEY_HAVE_X11
+
+#include "focusgate.h"
+#include <QSocketNotifier>
+
+// After all Qt headers, Xlib defines macros such as None and Bool
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+
+namespace {
+
+// The active window may be destroyed before its properties are read; the
+// default handler would terminate the process on BadWindow
+int ignoreXErrors(Display *, XErrorEvent *) {
+    return 0;
+}
+
+} // namespace
+
+X11ForegroundWatcher::X11ForegroundWatcher()
+    : m_display(nullptr)
+    , m_notifier(nullptr)
+    , m_gate(nullptr)
+    , m_root(0)
+    , m_activeWindowAtom(0)
+    , m_nameAtom(0)
+    , m_utf8Atom(0)
+    , m_lastWindow(0) {
+}
+
+X11ForegroundWatcher::~X11ForegroundWatcher() {
+    stop();
+}
+
+bool X11ForegroundWatcher::start(FocusGate *gate, QString *errorString) {
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display) {
+        if (errorString) {
+            *errorString = "Cannot open the X display";
+        }
+        return false;
+    }
+    XSetErrorHandler(ignoreXErrors);
+
+    m_root = DefaultRootWindow(m_display);
+    m_activeWindowAtom = XInternAtom(m_display, "_NET_ACTIVE_WINDOW", False);
+    m_nameAtom = XInternAtom(m_display, "_NET_WM_NAME", False);
+    m_utf8Atom = XInternAtom(m_display, "UTF8_STRING", False);
+
+    // Window managers without EWMH support never set the property
+    Atom type = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    XGetWindowProperty(m_display, m_root, m_activeWindowAtom, 0, 1, False, XA_WINDOW,
+                       &type, &format, &count, &remaining, &data);
+    if (data) {
+        XFree(data);
+    }
+    if (type != XA_WINDOW) {
+        if (errorString) {
+            *errorString = "The window manager does not publish _NET_ACTIVE_WINDOW";
+        }
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    XSelectInput(m_display, m_root, PropertyChangeMask);
+    XFlush(m_display);
+
+    m_gate = gate;
+    m_notifier = new QSocketNotifier(ConnectionNumber(m_display), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, [this]() { processEvents(); });
+
+    const ForegroundWindow window = activeWindow();
+    m_lastWindow = window.id;
+    m_gate->foregroundChanged(window);
+    return true;
+}
+
+void X11ForegroundWatcher::stop() {
+    delete m_notifier;
+    m_notifier = nullptr;
+    if (m_display) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+    }
+    m_gate = nullptr;
+}
+
+void X11ForegroundWatcher::processEvents() {
+    // Other root properties change too; only the active window is of interest
+    bool changed = false;
+    while (XPending(m_display) > 0) {
+        XEvent event;
+        XNextEvent(m_display, &event);
+        if (event.type == PropertyNotify && event.xproperty.atom == m_activeWindowAtom) {
+            changed = true;
+        }
+    }
+    if (!changed) {
+        return;
+    }
+
+    const ForegroundWindow window = activeWindow();
+    if (window.id != m_lastWindow) {
+        m_lastWindow = window.id;
+        m_gate->foregroundChanged(window);
+    }
+}
+
+ForegroundWindow X11ForegroundWatcher::activeWindow() const {
+    ForegroundWindow result;
+
+    Atom type = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    if (XGetWindowProperty(m_display, m_root, m_activeWindowAtom, 0, 1, False, XA_WINDOW,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        // Format 32 properties are returned as longs
+        if (count == 1 && format == 32) {
+            result.id = *reinterpret_cast<unsigned long *>(data);
+        }
+        XFree(data);
+    }
+    if (result.id == 0) {
+        return result;
+    }
+
+    result.title = windowTitle(result.id);
+    XClassHint hint;
+    if (XGetClassHint(m_display, result.id, &hint)) {
+        // The instance name; Wine sets it to the executable, e.g. "diablo iii64.exe"
+        result.processName = QString::fromLocal8Bit(hint.res_name);
+        XFree(hint.res_name);
+        XFree(hint.res_class);
+    }
+    return result;
+}
+
+QString X11ForegroundWatcher::windowTitle(unsigned long window) const {
+    Atom type = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    if (XGetWindowProperty(m_display, window, m_nameAtom, 0, 1024, False, m_utf8Atom,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        const QString title = QString::fromUtf8(reinterpret_cast<const char *>(data), count);
+        XFree(data);
+        return title;
+    }
+
+    // Pre-EWMH clients only set WM_NAME
+    char *name = nullptr;
+    if (XFetchName(m_display, window, &name) && name) {
+        const QString title = QString::fromLocal8Bit(name);
+        XFree(name);
+        return title;
+    }
+    return QString();
+}
+
+#endif // AUTOKEY_HAVE_X11
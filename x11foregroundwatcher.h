@@ -0,0 +1,45 @@
+#ifndef X11FOREGROUNDWATCHER_H
+#define X11FOREGROUNDWATCHER_H
+
+#include <QtGlobal>
+
+#ifdef AUTOKEY_HAVE_X11
+
+#include <QObject>
+#include "foregroundwatcher.h"
+
+class QSocketNotifier;
+struct _XDisplay;
+
+// Observes the root window's _NET_ACTIVE_WINDOW property, which EWMH window
+// managers update on every focus change. The watcher has its own display
+// connection; its socket wakes the event loop only when a root window
+// property changes. Xlib types stay out of this header because its macros
+// clash with Qt.
+class X11ForegroundWatcher : public QObject, public ForegroundWatcher {
+public:
+    X11ForegroundWatcher();
+    ~X11ForegroundWatcher();
+
+    QString name() const override { return "X11 _NET_ACTIVE_WINDOW"; }
+    bool start(FocusGate *gate, QString *errorString) override;
+    void stop() override;
+
+private:
+    void processEvents();
+    ForegroundWindow activeWindow() const;
+    QString windowTitle(unsigned long window) const;
+
+    _XDisplay *m_display;
+    QSocketNotifier *m_notifier;
+    FocusGate *m_gate;
+    unsigned long m_root;
+    unsigned long m_activeWindowAtom;
+    unsigned long m_nameAtom;
+    unsigned long m_utf8Atom;
+    unsigned long m_lastWindow;
+};
+
+#endif // AUTOKEY_HAVE_X11
+
+#endif // X11FOREGROUNDWATCHER_H